@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include <esp_err.h>
@@ -13,6 +14,9 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "board/touch_types.h"
 
 namespace dial {
 
@@ -28,13 +32,6 @@ struct DisplayRegion {
     int32_t height = 0;
 };
 
-struct TouchPoint {
-    bool touched = false;
-    uint16_t x = 0;
-    uint16_t y = 0;
-    uint8_t touch_count = 0;
-};
-
 class Backlight {
 public:
     Backlight() = default;
@@ -79,15 +76,38 @@ public:
     TouchController() = default;
 
     esp_err_t init();
-    esp_err_t read(TouchPoint* point);
+    esp_err_t read(TouchPoint* point);        // 5 bytes from 0x02: count and first point
+    esp_err_t read_report(TouchReport* report);  // 12 bytes from 0x01
     bool initialized() const { return initialized_; }
 
+    // Arms the INT falling edge (first contact). Each edge is timestamped and,
+    // if `task` is set, wakes it with a task notification. Returns
+    // ESP_ERR_NOT_SUPPORTED on boards without an INT line.
+    esp_err_t enable_interrupt(TaskHandle_t task);
+    bool has_interrupt_line() const;
+    // Low 32 bits of esp_timer time at the last INT edge, 0 if none since the
+    // previous call.
+    uint32_t take_contact_edge_us() { return contact_edge_us_.exchange(0, std::memory_order_relaxed); }
+    uint32_t interrupt_count() const { return interrupt_count_.load(std::memory_order_relaxed); }
+    uint32_t read_count() const { return read_count_; }
+    // Bytes on the wire for all reads: address, register and address again
+    // plus the payload (start/stop and ACK bits not counted).
+    uint32_t bus_bytes() const { return bus_bytes_; }
+
 private:
+    static void isr_handler(void* arg);
+
     esp_err_t write_reg(uint8_t reg, uint8_t value);
     esp_err_t read_regs(uint8_t reg, uint8_t* data, size_t length);
 
     bool initialized_ = false;
     i2c_port_t port_ = I2C_NUM_0;
+    bool isr_installed_ = false;
+    TaskHandle_t notify_task_ = nullptr;
+    std::atomic<uint32_t> contact_edge_us_{0};
+    std::atomic<uint32_t> interrupt_count_{0};
+    uint32_t read_count_ = 0;
+    uint32_t bus_bytes_ = 0;
 };
 
 class DialBoard {
@@ -9,6 +9,9 @@ struct PinMap {
     static constexpr int ENCODER_SS0 = 42;
     static constexpr int ENCODER_I2C_ADDRESS = 0x06;
     static constexpr int ENCODER_BUTTON = 5;
+    // MT6701 ABZ outputs; not routed on this board, so the encoder stays on I2C.
+    static constexpr int ENCODER_A = -1;
+    static constexpr int ENCODER_B = -1;
 
     // Power management
     static constexpr int POWER_HOLD = 18;      // IO_ON_OFF
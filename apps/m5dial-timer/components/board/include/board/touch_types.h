@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// FT3267 report types, kept free of driver headers so the gesture recognizer
+// and the host tools can use them.
+
+namespace dial {
+
+struct TouchPoint {
+    bool touched = false;
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint8_t touch_count = 0;
+};
+
+// FT3267 gesture-engine codes (register 0x01).
+enum class TouchGesture : uint8_t {
+    None = 0x00,
+    MoveUp = 0x10,
+    MoveRight = 0x14,
+    MoveDown = 0x18,
+    MoveLeft = 0x1C,
+    ZoomIn = 0x48,
+    ZoomOut = 0x49,
+};
+
+// Registers 0x01-0x0C in one burst: gesture ID, touch count and both points.
+struct TouchReport {
+    TouchGesture gesture = TouchGesture::None;
+    uint8_t touch_count = 0;
+    uint16_t x[2] = {};
+    uint16_t y[2] = {};
+};
+
+}  // namespace dial
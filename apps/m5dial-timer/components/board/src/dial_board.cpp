@@ -3,8 +3,10 @@
 #include <algorithm>
 #include <new>
 
+#include <esp_attr.h>
 #include <esp_check.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -24,6 +26,8 @@ constexpr const char* TAG_TOUCH = "DialTouch";
 constexpr uint8_t kCmdDelayFlag = 0x80;
 constexpr uint8_t kCmdEndMarker = 0xFF;
 constexpr uint8_t kFt3267Address = 0x38;
+constexpr uint8_t kFt3267RegGMode = 0xA4;
+constexpr uint8_t kFt3267GModeLevel = 0x00;  // INT held low while touched
 
 constexpr uint8_t kGc9a01InitSequence[] = {
     0xEF, 0,
@@ -297,6 +301,7 @@ esp_err_t TouchController::read_regs(uint8_t reg, uint8_t* data, size_t length)
     if (length == 0) {
         return ESP_OK;
     }
+    bus_bytes_ += static_cast<uint32_t>(length) + 3;
     return i2c_master_write_read_device(port_, kFt3267Address, &reg, 1, data, length, ms_to_ticks(20));
 }
 
@@ -351,6 +356,7 @@ esp_err_t TouchController::init() {
     ESP_RETURN_ON_ERROR(write_reg(0x86, 0), TAG_TOUCH, "cfg CTRL failed");
     ESP_RETURN_ON_ERROR(write_reg(0x87, 12), TAG_TOUCH, "cfg PERIODACTIVE failed");
     ESP_RETURN_ON_ERROR(write_reg(0x88, 40), TAG_TOUCH, "cfg PERIODMONITOR failed");
+    ESP_RETURN_ON_ERROR(write_reg(kFt3267RegGMode, kFt3267GModeLevel), TAG_TOUCH, "cfg G_MODE failed");
 
     initialized_ = true;
     ESP_LOGI(TAG_TOUCH, "FT3267 initialised");
@@ -364,13 +370,14 @@ esp_err_t TouchController::read(TouchPoint* point) {
     point->touched = false;
     point->x = 0;
     point->y = 0;
-    point->touch_count = touches;
+    point->touch_count = 0;
 
     if (!initialized_) {
         return ESP_ERR_INVALID_STATE;
     }
 
     uint8_t data[5] = {0};
+    ++read_count_;
     esp_err_t rc = read_regs(0x02, data, sizeof(data));
     if (rc != ESP_OK) {
         return rc;
@@ -391,6 +398,76 @@ esp_err_t TouchController::read(TouchPoint* point) {
     return ESP_OK;
 }
 
+esp_err_t TouchController::read_report(TouchReport* report) {
+    if (!report) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *report = TouchReport{};
+
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 0x01 gesture, 0x02 count, 0x03-0x06 P1, 0x07-0x08 P1 weight/area,
+    // 0x09-0x0C P2.
+    uint8_t data[12] = {0};
+    ++read_count_;
+    esp_err_t rc = read_regs(0x01, data, sizeof(data));
+    if (rc != ESP_OK) {
+        return rc;
+    }
+
+    report->gesture = static_cast<TouchGesture>(data[0]);
+    report->touch_count = std::min<uint8_t>(data[1] & 0x0F, 2);
+    for (uint8_t i = 0; i < report->touch_count; ++i) {
+        const uint8_t* p = &data[2 + i * 6];
+        report->x[i] = static_cast<uint16_t>(((p[0] & 0x0F) << 8) | p[1]);
+        report->y[i] = static_cast<uint16_t>(((p[2] & 0x0F) << 8) | p[3]);
+    }
+    return ESP_OK;
+}
+
+bool TouchController::has_interrupt_line() const {
+    return PinMap::TOUCH_INT >= 0;
+}
+
+esp_err_t TouchController::enable_interrupt(TaskHandle_t task) {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!has_interrupt_line()) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    notify_task_ = task;
+    if (isr_installed_) {
+        return ESP_OK;
+    }
+
+    const auto pin = static_cast<gpio_num_t>(PinMap::TOUCH_INT);
+    ESP_RETURN_ON_ERROR(gpio_set_intr_type(pin, GPIO_INTR_NEGEDGE), TAG_TOUCH, "touch int type failed");
+    esp_err_t rc = gpio_install_isr_service(0);
+    if (rc == ESP_ERR_INVALID_STATE) {
+        rc = ESP_OK;  // already installed by another driver
+    }
+    ESP_RETURN_ON_ERROR(rc, TAG_TOUCH, "gpio isr service failed");
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(pin, &TouchController::isr_handler, this), TAG_TOUCH, "touch isr add failed");
+    isr_installed_ = true;
+    return ESP_OK;
+}
+
+void IRAM_ATTR TouchController::isr_handler(void* arg) {
+    auto* self = static_cast<TouchController*>(arg);
+    const uint32_t now_us = static_cast<uint32_t>(esp_timer_get_time());
+    self->contact_edge_us_.store(now_us == 0 ? 1 : now_us, std::memory_order_relaxed);
+    self->interrupt_count_.fetch_add(1, std::memory_order_relaxed);
+    if (self->notify_task_ != nullptr) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->notify_task_, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
 // ------------------------------- DialBoard ---------------------------------
 
 DialBoard g_board;
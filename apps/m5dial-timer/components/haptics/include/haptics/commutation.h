@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+// Angles are in MT6701 raw units: 14 bits per turn, mechanical or electrical.
+constexpr uint32_t kAngleBits = 14;
+constexpr uint32_t kAngleTurn = 1u << kAngleBits;
+constexpr uint32_t kAngleMask = kAngleTurn - 1;
+
+// Quarter-wave table resolution; the two angle bits below it are linearly
+// interpolated.
+constexpr uint32_t kSineTableBits = 10;
+constexpr int32_t kQ15One = 32767;
+
+// sin(2 pi angle / 2^14) in Q15, for any angle (only the low 14 bits count).
+int32_t sin_q15(uint32_t angle);
+
+enum class Modulation : uint8_t {
+    Sinusoidal,
+    // Min-max zero-sequence injection: same line-to-line voltages, 2/sqrt(3)
+    // more headroom before the phases clip.
+    SpaceVector,
+};
+
+// Largest phase amplitude, as a fraction of the bus, that stays unclipped.
+constexpr float kSinusoidalMaxRatio = 0.5f;
+constexpr float kSpaceVectorMaxRatio = 0.57735f;
+
+struct CommutationConfig {
+    uint8_t pole_pairs = 7;
+    int8_t direction = 1;          // sensor_direction
+    uint32_t offset = 0;           // electrical angle at raw 0, 14-bit units
+    uint32_t max_duty = 4095;      // (1 << resolution_bits) - 1
+    Modulation modulation = Modulation::Sinusoidal;
+};
+
+struct PhaseDuty {
+    uint32_t u;
+    uint32_t v;
+    uint32_t w;
+};
+
+// Voltage-mode commutation in integer arithmetic: electrical angle straight
+// from the raw encoder angle, two table lookups per update (w = -u - v) and
+// duties in LEDC/MCPWM counts. Platform-free so the host bench can check it
+// against the float reference.
+class CommutationKernel {
+public:
+    explicit CommutationKernel(const CommutationConfig& config = {}) { configure(config); }
+
+    void configure(const CommutationConfig& config);
+
+    uint32_t electrical_angle(uint16_t raw_angle) const {
+        const uint32_t angle = static_cast<uint32_t>(raw_angle) * config_.pole_pairs;
+        return ((config_.direction < 0 ? 0u - angle : angle) + config_.offset) & kAngleMask;
+    }
+
+    // `amplitude_q15` is the signed phase amplitude as a fraction of the bus
+    // (Q15, so kQ15One / 2 reaches the rails with sinusoidal modulation);
+    // the sign picks the torque direction.
+    PhaseDuty update(uint16_t raw_angle, int32_t amplitude_q15) const;
+
+    PhaseDuty centered() const { return PhaseDuty{mid_duty_, mid_duty_, mid_duty_}; }
+
+private:
+    CommutationConfig config_{};
+    uint32_t mid_duty_ = 0;
+};
+
+// Converts radians of electrical angle to 14-bit units.
+uint32_t electrical_offset_from_radians(float radians);
+
+}  // namespace dial
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "ringbuf/mpsc_ring.h"
+
+namespace dial {
+
+// One-shot effects, each a precomputed Q15 waveform played as a pulse train.
+enum class HapticEffect : uint8_t {
+    Click,        // short damped 250 Hz ring, for taps
+    Buzz,         // five 80 ms bursts at 160 Hz, for an expired countdown
+    FinalMinute,  // three soft thumps, for the last minute of a countdown
+    Count,
+};
+
+enum class HapticCommandType : uint8_t {
+    Play,         // effect
+    EngageWall,   // end stop at the current angle, blocking `direction` (0: the direction of travel)
+    ReleaseWall,
+    SetDetents,   // detent_positions, strength_q15
+};
+
+struct HapticCommand {
+    HapticCommandType type = HapticCommandType::Play;
+    HapticEffect effect = HapticEffect::Click;
+    int8_t direction = 0;
+    uint16_t detent_positions = 0;
+    int16_t strength_q15 = 0;
+};
+
+struct HapticEffectConfig {
+    uint16_t detent_positions = 96;
+    int16_t detent_strength_q15 = 4915;   // 0.15
+    int32_t damping_q16 = 131072;         // opposing torque per rev/s, 2.0
+    uint32_t wall_full_scale_raw = 256;   // wall torque saturates this far past the stop
+};
+
+struct HapticEffectStats {
+    uint32_t commands = 0;
+    uint32_t dropped = 0;    // ring full at post()
+    uint32_t discarded = 0;  // drained while the motor was idle
+    uint32_t played = 0;
+    uint32_t voices_stolen = 0;
+    uint32_t wall_engagements = 0;
+};
+
+// Sample period of the effect waveforms.
+constexpr uint32_t kEffectSampleShift = 8;  // 256 us
+constexpr size_t kMaxEffectVoices = 4;
+constexpr size_t kHapticCommandRingSize = 16;
+
+// Mixes the detent field, an end-stop wall and up to kMaxEffectVoices one-shot
+// effects into one torque command per control-loop step. Commands arrive
+// through a lock-free ring from any task or ISR and are drained a few per
+// step, so posting never blocks and rendering never waits. Waveforms are
+// built once in configure(); render() is integer-only. Platform-free.
+class HapticEffectEngine {
+public:
+    explicit HapticEffectEngine(const HapticEffectConfig& config = {}) { configure(config); }
+
+    void configure(const HapticEffectConfig& config);
+
+    // Any task or ISR. False if the ring is full.
+    bool post(const HapticCommand& command);
+    bool play(HapticEffect effect) { return post(HapticCommand{.type = HapticCommandType::Play, .effect = effect}); }
+
+    // Control loop only. Signed torque in Q15 (kQ15One is full scale) for
+    // the rotor at `raw_angle` moving at `velocity` raw units/s.
+    int32_t render(uint16_t raw_angle, int32_t velocity, uint32_t now_us);
+    // Control loop only, when it is not rendering: empties the ring so
+    // commands do not pile up behind a disabled motor.
+    void discard_pending();
+
+    bool wall_engaged() const { return wall_direction_ != 0; }
+    size_t active_voices() const;
+    // Length of one effect, start of first pulse to end of last.
+    uint32_t duration_us(HapticEffect effect) const;
+    HapticEffectStats stats() const;
+
+private:
+    static constexpr size_t kMaxCommandsPerRender = 4;
+    static constexpr size_t kWaveformSamples = 448;
+
+    // One pulse is `length` samples of waveforms_ from `offset`; the pulse
+    // repeats every `period_us`.
+    struct Pattern {
+        uint16_t offset;
+        uint16_t length;
+        int16_t gain_q15;
+        uint8_t repeats;
+        uint32_t period_us;
+    };
+
+    struct Voice {
+        uint8_t effect;
+        bool active;
+        uint32_t start_us;
+    };
+
+    void build_waveforms();
+    void apply(const HapticCommand& command, uint16_t raw_angle, uint32_t now_us);
+    void start_voice(HapticEffect effect, uint32_t now_us);
+    int32_t voice_sample(Voice& voice, uint32_t now_us);
+
+    HapticEffectConfig config_{};
+    int16_t waveforms_[kWaveformSamples]{};
+    Pattern patterns_[static_cast<size_t>(HapticEffect::Count)]{};
+    Voice voices_[kMaxEffectVoices]{};
+    MpscRing<HapticCommand, kHapticCommandRingSize> commands_{};
+    uint16_t detent_positions_ = 0;
+    int32_t detent_gain_q15_ = 0;
+    int8_t wall_direction_ = 0;
+    int8_t travel_direction_ = 1;
+    uint16_t wall_angle_ = 0;
+    HapticEffectStats stats_{};
+    std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace dial
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "haptics/commutation.h"
+#include "haptics/haptic_effects.h"
+#include "input/angle_predictor.h"
+
+namespace dial {
+
+// The feel of the knob: what MotorController's loop computes, independent of
+// how the PWM and encoder are wired.
+struct HapticsTuning {
+    uint8_t pole_pairs = 7;
+    uint16_t detent_positions = 96;
+    float detent_strength = 0.15f;
+    float detent_damping = 2.0f;  // opposing torque per rev/s of the predictor's knob speed
+    uint32_t wall_full_scale_raw = 256;  // end-stop torque saturates this far past the stop
+    float max_voltage_ratio = 0.4f;  // phase amplitude / bus, capped just under the modulation's limit
+    Modulation modulation = Modulation::Sinusoidal;
+    float zero_electrical_offset = 0.0f;  // rad, electrical angle at raw angle 0
+    int8_t sensor_direction = 1;          // -1 when the MT6701 counts against the motor
+    // Extrapolate the last encoder angle to each loop's wake time, so the
+    // loop can run faster than the encoder samples.
+    bool extrapolate_angle = true;
+    AnglePredictorConfig prediction{.difference_velocity = true};
+};
+
+// One haptic loop iteration, platform-free: encoder observation in, three
+// PWM duties out. MotorController wraps it with the GPTimer, the encoder
+// reader and the PWM backend; tools/host-bench runs it against a simulated
+// motor. Owned by a single loop, except effects().post(), which any task may
+// call.
+class HapticsCore {
+public:
+    HapticsCore() = default;
+
+    // `max_duty` is the PWM backend's full-scale count.
+    void configure(const HapticsTuning& tuning, uint32_t max_duty);
+
+    // `observation` is the encoder's latest, published under `generation`;
+    // nullptr while there is none or the motor is disabled, which centres
+    // the phases. `strength_q15` scales the whole torque command.
+    PhaseDuty step(const AngleObservation* observation, uint32_t generation, uint32_t now_us, int32_t strength_q15);
+
+    HapticEffectEngine& effects() { return effects_; }
+    const HapticEffectEngine& effects() const { return effects_; }
+    const AnglePredictionStats& prediction_stats() const { return predictor_.stats(); }
+    // Last commanded torque in Q15, in raw-angle terms (positive turns the
+    // raw angle up).
+    int32_t torque_q15() const { return torque_q15_; }
+
+private:
+    HapticsTuning tuning_{};
+    CommutationKernel kernel_{};
+    HapticEffectEngine effects_{};
+    AnglePredictor predictor_{};
+    uint32_t observation_generation_ = 0;
+    int32_t max_amplitude_q15_ = 0;  // max_voltage_ratio after the modulation cap
+    int32_t torque_q15_ = 0;
+};
+
+}  // namespace dial
@@ -1,25 +1,66 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <atomic>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "driver/gptimer.h"
+#include "driver/mcpwm_prelude.h"
 #include "esp_err.h"
 
+#include "haptics/commutation.h"
+#include "haptics/haptic_effects.h"
+#include "haptics/haptics_core.h"
+#include "input/angle_predictor.h"
+
 namespace dial {
 
+constexpr uint32_t kMinHapticsLoopRateHz = 1000;
+constexpr uint32_t kMaxHapticsLoopRateHz = 10000;
+
+enum class HapticsPwmBackend : uint8_t {
+    Mcpwm,  // one center-aligned MCPWM timer, a comparator per phase, all latched at the timer peak
+    Ledc,   // three LEDC channels, each latched at its own next period
+};
+
 struct HapticsConfig {
     int gpio_u = 15;
     int gpio_v = 16;
     int gpio_w = 17;
     uint32_t pwm_frequency_hz = 50000;
-    uint32_t resolution_bits = 12;
-    uint8_t pole_pairs = 7;
-    uint16_t detent_positions = 96;
-    float detent_strength = 0.6f;
-    float max_voltage_ratio = 0.4f;
-    TickType_t update_interval_ticks = pdMS_TO_TICKS(1);
+    uint32_t resolution_bits = 12;  // LEDC only, lowered to what the 80 MHz APB clock allows
+    HapticsPwmBackend pwm_backend = HapticsPwmBackend::Mcpwm;  // falls back to LEDC
+    HapticsTuning tuning{};
+    // The loop is paced by a GPTimer alarm, clamped to
+    // [kMinHapticsLoopRateHz, kMaxHapticsLoopRateHz]. Core 0 by default so
+    // core 1 stays with LVGL.
+    uint32_t loop_rate_hz = 2000;
+    UBaseType_t task_priority = 12;
+    BaseType_t task_core_id = 0;
+};
+
+// Period error buckets (|wake-to-wake - period|), upper bounds in
+// microseconds; the last bucket is open-ended.
+constexpr uint32_t kHapticsJitterBucketUs[] = {5, 10, 25, 50, 100};
+constexpr size_t kHapticsJitterBuckets = sizeof(kHapticsJitterBucketUs) / sizeof(kHapticsJitterBucketUs[0]) + 1;
+
+struct HapticsLoopStats {
+    uint32_t loop_rate_hz = 0;
+    uint32_t loops = 0;
+    uint32_t overruns = 0;  // alarms that fired while the previous iteration was still running
+    uint64_t exec_total_us = 0;
+    uint32_t exec_max_us = 0;
+    uint64_t jitter_total_us = 0;
+    uint32_t jitter_max_us = 0;
+    uint32_t jitter_buckets[kHapticsJitterBuckets] = {};
+    uint32_t wake_latency_max_us = 0;  // alarm ISR to loop start
+    HapticsPwmBackend pwm_backend = HapticsPwmBackend::Ledc;
+    uint64_t pwm_cycles_total = 0;  // CPU cycles spent handing the three duties to the backend
+    uint32_t pwm_cycles_max = 0;
+    AnglePredictionStats prediction{};
+    HapticEffectStats effects{};
 };
 
 class MotorController {
@@ -30,18 +71,48 @@ public:
     void start();
     void enable(bool enabled);
     void set_strength(float strength);
+    // Any task or ISR; never blocks. False if the command ring is full.
+    bool post(const HapticCommand& command) { return core_.effects().post(command); }
+    bool play(HapticEffect effect) { return core_.effects().play(effect); }
+    HapticsPwmBackend active_pwm_backend() const { return active_pwm_backend_; }
+    // Totals since start(), refreshed by the loop ten times a second.
+    HapticsLoopStats stats() const;
+    // Logs loops/s and overruns since the previous call, mean/max execution
+    // time and period error, and the period error histogram.
+    void log_stats();
 
 private:
     static void task_entry(void* arg);
+    static bool on_loop_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx);
+    esp_err_t init_mcpwm();
+    esp_err_t init_ledc();
+    esp_err_t init_loop_timer();
     void run();
-    void apply_pwm(float a, float b, float c);
+    PhaseDuty step(uint32_t now_us);
+    void apply_pwm(const PhaseDuty& duty);
 
     HapticsConfig config_{};
     bool initialised_ = false;
     TaskHandle_t task_handle_ = nullptr;
     std::atomic<bool> enabled_{true};
-    std::atomic<float> strength_scale_{1.0f};
-    float electrical_offset_ = 0.0f;
+    std::atomic<int32_t> strength_q15_{kQ15One};
+
+    HapticsPwmBackend active_pwm_backend_ = HapticsPwmBackend::Ledc;
+    uint32_t pwm_max_duty_ = 0;
+    mcpwm_timer_handle_t mcpwm_timer_ = nullptr;
+    mcpwm_cmpr_handle_t mcpwm_comparators_[3] = {};
+
+    HapticsCore core_{};
+
+    gptimer_handle_t loop_timer_ = nullptr;
+    uint32_t loop_rate_hz_ = 0;
+    uint32_t period_us_ = 0;
+    std::atomic<int64_t> alarm_us_{0};
+    mutable portMUX_TYPE stats_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    HapticsLoopStats stats_{};
+    uint32_t last_logged_loops_ = 0;
+    uint32_t last_logged_overruns_ = 0;
+    int64_t last_logged_us_ = 0;
 };
 
 extern MotorController g_motor_controller;
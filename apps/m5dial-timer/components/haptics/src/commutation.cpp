@@ -0,0 +1,103 @@
+#include "haptics/commutation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace dial {
+
+namespace {
+constexpr uint32_t kQuarterTurn = kAngleTurn / 4;
+constexpr uint32_t kQuarterBits = kAngleBits - 2;
+constexpr uint32_t kInterpBits = kQuarterBits - kSineTableBits;
+constexpr uint32_t kSineTableSize = (1u << kSineTableBits) + 1;
+constexpr uint32_t kThirdTurn = (kAngleTurn + 1) / 3;  // 120 deg, 0.007 deg short
+constexpr int32_t kHalfQ15 = 1 << 14;
+constexpr int32_t kFullQ15 = 1 << 15;
+
+// Taylor series on [0, pi/2]; 12 terms are exact to double precision there.
+constexpr double constexpr_sin(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+// One padding entry past pi/2 so the interpolation read at exactly a quarter
+// turn stays in bounds.
+constexpr std::array<int16_t, kSineTableSize + 1> build_quarter_sine() {
+    std::array<int16_t, kSineTableSize + 1> table{};
+    constexpr double kHalfPi = 1.57079632679489661923;
+    for (uint32_t i = 0; i < kSineTableSize; ++i) {
+        const double value = constexpr_sin(kHalfPi * i / (kSineTableSize - 1)) * kQ15One;
+        table[i] = static_cast<int16_t>(value + 0.5);
+    }
+    table[kSineTableSize] = table[kSineTableSize - 1];
+    return table;
+}
+
+constexpr std::array<int16_t, kSineTableSize + 1> kQuarterSine = build_quarter_sine();
+static_assert(kQuarterSine[0] == 0 && kQuarterSine[kSineTableSize - 1] == kQ15One, "quarter wave endpoints");
+
+int32_t to_duty(int32_t value_q15, uint32_t max_duty) {
+    // value_q15 is the phase voltage relative to mid-bus; 0.5 is added here.
+    const uint32_t level = static_cast<uint32_t>(std::clamp(kHalfQ15 + value_q15, 0, kFullQ15));
+    return static_cast<int32_t>((max_duty * level + kHalfQ15) >> 15);
+}
+}  // namespace
+
+int32_t sin_q15(uint32_t angle) {
+    const uint32_t quadrant = (angle >> kQuarterBits) & 3u;
+    uint32_t pos = angle & (kQuarterTurn - 1);
+    if (quadrant & 1u) {
+        pos = kQuarterTurn - pos;
+    }
+    const uint32_t index = pos >> kInterpBits;
+    const int32_t frac = static_cast<int32_t>(pos & ((1u << kInterpBits) - 1));
+    const int32_t base = kQuarterSine[index];
+    const int32_t value = base + (((kQuarterSine[index + 1] - base) * frac) >> kInterpBits);
+    return quadrant & 2u ? -value : value;
+}
+
+void CommutationKernel::configure(const CommutationConfig& config) {
+    config_ = config;
+    config_.offset &= kAngleMask;
+    mid_duty_ = static_cast<uint32_t>(to_duty(0, config_.max_duty));
+}
+
+PhaseDuty CommutationKernel::update(uint16_t raw_angle, int32_t amplitude_q15) const {
+    const uint32_t angle = electrical_angle(raw_angle);
+    const int32_t amplitude = std::clamp(amplitude_q15, -kQ15One, kQ15One);
+    const int32_t su = sin_q15(angle);
+    const int32_t sv = sin_q15(angle - kThirdTurn);
+    int32_t u = (amplitude * su + kHalfQ15) >> 15;
+    int32_t v = (amplitude * sv + kHalfQ15) >> 15;
+    int32_t w = -u - v;
+
+    if (config_.modulation == Modulation::SpaceVector) {
+        const int32_t hi = std::max({u, v, w});
+        const int32_t lo = std::min({u, v, w});
+        const int32_t common = (hi + lo) / 2;
+        u -= common;
+        v -= common;
+        w -= common;
+    }
+
+    return PhaseDuty{
+        .u = static_cast<uint32_t>(to_duty(u, config_.max_duty)),
+        .v = static_cast<uint32_t>(to_duty(v, config_.max_duty)),
+        .w = static_cast<uint32_t>(to_duty(w, config_.max_duty)),
+    };
+}
+
+uint32_t electrical_offset_from_radians(float radians) {
+    constexpr float kTwoPi = 6.28318530717958647692f;
+    const float turns = radians / kTwoPi;
+    const float frac = turns - std::floor(turns);
+    return static_cast<uint32_t>(std::lround(frac * static_cast<float>(kAngleTurn))) & kAngleMask;
+}
+
+}  // namespace dial
@@ -0,0 +1,220 @@
+#include "haptics/haptic_effects.h"
+
+#include <algorithm>
+
+#include "haptics/commutation.h"
+#include "input/encoder_ticks.h"
+
+namespace dial {
+
+namespace {
+constexpr uint32_t kSampleUs = 1u << kEffectSampleShift;
+
+// Waveform layout inside waveforms_: click, one buzz burst, one thump.
+constexpr uint16_t kClickSamples = 32;     // 8.2 ms
+constexpr uint16_t kBuzzSamples = 313;     // 80 ms
+constexpr uint16_t kThumpSamples = 98;     // 25 ms
+constexpr uint32_t kClickHz = 250;
+constexpr uint32_t kBuzzHz = 160;
+constexpr int32_t kClickDecayQ15 = 28180;  // x0.86 per sample, ~1.7 ms time constant
+
+// Angle step per waveform sample for a tone, in sin_q15 units.
+constexpr uint32_t tone_angle(uint32_t hz, uint32_t sample) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(sample) * hz * kAngleTurn * kSampleUs) / 1000000u);
+}
+
+int32_t clamp_q15(int32_t value) {
+    return std::clamp(value, -kQ15One, kQ15One);
+}
+}  // namespace
+
+void HapticEffectEngine::configure(const HapticEffectConfig& config) {
+    config_ = config;
+    config_.wall_full_scale_raw = std::max<uint32_t>(1, config_.wall_full_scale_raw);
+    detent_positions_ = config_.detent_positions;
+    detent_gain_q15_ = std::clamp<int32_t>(config_.detent_strength_q15, 0, kQ15One);
+    build_waveforms();
+    for (Voice& voice : voices_) {
+        voice.active = false;
+    }
+    wall_direction_ = 0;
+}
+
+void HapticEffectEngine::build_waveforms() {
+    static_assert(kClickSamples + kBuzzSamples + kThumpSamples <= kWaveformSamples, "waveform storage");
+    uint16_t offset = 0;
+
+    // Click: a 250 Hz sine under an exponential decay.
+    int32_t envelope = kQ15One;
+    for (uint16_t i = 0; i < kClickSamples; ++i) {
+        waveforms_[offset + i] = static_cast<int16_t>((sin_q15(tone_angle(kClickHz, i)) * envelope) >> 15);
+        envelope = (envelope * kClickDecayQ15) >> 15;
+    }
+    patterns_[static_cast<size_t>(HapticEffect::Click)] = Pattern{offset, kClickSamples, 22938, 1, 0};  // 0.7
+    offset += kClickSamples;
+
+    // Buzz: a flat 160 Hz burst with 4 ms raised-cosine edges.
+    constexpr uint16_t kEdgeSamples = 16;
+    for (uint16_t i = 0; i < kBuzzSamples; ++i) {
+        const uint16_t edge = std::min<uint16_t>(i, kBuzzSamples - 1 - i);
+        int32_t gain = kQ15One;
+        if (edge < kEdgeSamples) {
+            gain = (kQ15One - sin_q15(kAngleTurn / 4 + edge * (kAngleTurn / 2) / kEdgeSamples)) / 2;
+        }
+        waveforms_[offset + i] = static_cast<int16_t>((sin_q15(tone_angle(kBuzzHz, i)) * gain) >> 15);
+    }
+    patterns_[static_cast<size_t>(HapticEffect::Buzz)] = Pattern{offset, kBuzzSamples, 16384, 5, 200000};  // 0.5
+    offset += kBuzzSamples;
+
+    // Thump: one full sine period under a raised-cosine window, so the knob
+    // is nudged and returned rather than pushed.
+    for (uint16_t i = 0; i < kThumpSamples; ++i) {
+        const uint32_t phase = (static_cast<uint32_t>(i) * kAngleTurn) / kThumpSamples;
+        const int32_t window = (kQ15One - sin_q15(phase + kAngleTurn / 4)) / 2;
+        waveforms_[offset + i] = static_cast<int16_t>((sin_q15(phase) * window) >> 15);
+    }
+    patterns_[static_cast<size_t>(HapticEffect::FinalMinute)] =
+        Pattern{offset, kThumpSamples, 26214, 3, 180000};  // 0.8
+}
+
+bool HapticEffectEngine::post(const HapticCommand& command) {
+    if (!commands_.push(command)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+HapticEffectStats HapticEffectEngine::stats() const {
+    HapticEffectStats out = stats_;
+    out.dropped = dropped_.load(std::memory_order_relaxed);
+    return out;
+}
+
+size_t HapticEffectEngine::active_voices() const {
+    size_t count = 0;
+    for (const Voice& voice : voices_) {
+        count += voice.active ? 1 : 0;
+    }
+    return count;
+}
+
+uint32_t HapticEffectEngine::duration_us(HapticEffect effect) const {
+    const Pattern& pattern = patterns_[static_cast<size_t>(effect)];
+    return (pattern.repeats - 1u) * pattern.period_us + pattern.length * kSampleUs;
+}
+
+void HapticEffectEngine::discard_pending() {
+    HapticCommand command{};
+    while (commands_.pop(&command)) {
+        ++stats_.discarded;
+    }
+    for (Voice& voice : voices_) {
+        voice.active = false;
+    }
+}
+
+void HapticEffectEngine::start_voice(HapticEffect effect, uint32_t now_us) {
+    if (effect >= HapticEffect::Count) {
+        return;
+    }
+    // A free voice, or else the one that started earliest.
+    Voice* target = &voices_[0];
+    for (Voice& voice : voices_) {
+        if (!voice.active) {
+            target = &voice;
+            break;
+        }
+        if (now_us - voice.start_us > now_us - target->start_us) {
+            target = &voice;
+        }
+    }
+    if (target->active) {
+        ++stats_.voices_stolen;
+    }
+    *target = Voice{static_cast<uint8_t>(effect), true, now_us};
+    ++stats_.played;
+}
+
+void HapticEffectEngine::apply(const HapticCommand& command, uint16_t raw_angle, uint32_t now_us) {
+    ++stats_.commands;
+    switch (command.type) {
+        case HapticCommandType::Play:
+            start_voice(command.effect, now_us);
+            break;
+        case HapticCommandType::EngageWall:
+            wall_direction_ = command.direction != 0 ? (command.direction > 0 ? 1 : -1) : travel_direction_;
+            wall_angle_ = raw_angle;
+            ++stats_.wall_engagements;
+            break;
+        case HapticCommandType::ReleaseWall:
+            wall_direction_ = 0;
+            break;
+        case HapticCommandType::SetDetents:
+            detent_positions_ = command.detent_positions;
+            detent_gain_q15_ = std::clamp<int32_t>(command.strength_q15, 0, kQ15One);
+            break;
+    }
+}
+
+int32_t HapticEffectEngine::voice_sample(Voice& voice, uint32_t now_us) {
+    const Pattern& pattern = patterns_[voice.effect];
+    const uint32_t elapsed_us = now_us - voice.start_us;
+    uint32_t pulse_us = elapsed_us;
+    if (pattern.repeats > 1) {
+        const uint32_t pulse = elapsed_us / pattern.period_us;
+        if (pulse >= pattern.repeats) {
+            voice.active = false;
+            return 0;
+        }
+        pulse_us = elapsed_us - pulse * pattern.period_us;
+    }
+    const uint32_t index = pulse_us >> kEffectSampleShift;
+    if (index >= pattern.length) {
+        if (pattern.repeats <= 1 || elapsed_us >= duration_us(static_cast<HapticEffect>(voice.effect))) {
+            voice.active = false;
+        }
+        return 0;
+    }
+    return (waveforms_[pattern.offset + index] * pattern.gain_q15) >> 15;
+}
+
+int32_t HapticEffectEngine::render(uint16_t raw_angle, int32_t velocity, uint32_t now_us) {
+    HapticCommand command{};
+    for (size_t i = 0; i < kMaxCommandsPerRender && commands_.pop(&command); ++i) {
+        apply(command, raw_angle, now_us);
+    }
+    if (velocity != 0) {
+        travel_direction_ = velocity > 0 ? 1 : -1;
+    }
+
+    int32_t torque = 0;
+    bool in_wall = false;
+    if (wall_direction_ != 0) {
+        const int32_t penetration = mt6701_angle_delta(wall_angle_, raw_angle) * wall_direction_;
+        if (penetration > 0) {
+            in_wall = true;
+            const int64_t push = (static_cast<int64_t>(penetration) * kQ15One) / config_.wall_full_scale_raw;
+            torque -= wall_direction_ * static_cast<int32_t>(std::min<int64_t>(push, kQ15One));
+        }
+    }
+
+    // Detents are muted inside the wall so it feels solid.
+    if (!in_wall && detent_gain_q15_ > 0 && detent_positions_ > 0) {
+        // Capped at the detent amplitude, so a fast spin coasts rather than
+        // braking at full torque.
+        const int64_t raw_damping = (static_cast<int64_t>(velocity) * config_.damping_q16) >> 15;
+        const int32_t damping = static_cast<int32_t>(std::clamp<int64_t>(raw_damping, -kQ15One, kQ15One));
+        const int32_t field = -sin_q15(static_cast<uint32_t>(raw_angle) * detent_positions_) - damping;
+        torque += static_cast<int32_t>((static_cast<int64_t>(detent_gain_q15_) * field) >> 15);
+    }
+
+    for (Voice& voice : voices_) {
+        if (voice.active) {
+            torque += voice_sample(voice, now_us);
+        }
+    }
+    return clamp_q15(torque);
+}
+
+}  // namespace dial
@@ -0,0 +1,62 @@
+#include "haptics/haptics_core.h"
+
+#include <algorithm>
+
+namespace dial {
+
+namespace {
+// Keeps every phase off the rails for part of each PWM period, as the
+// bootstrap supplies of the EG2133 high sides need.
+constexpr float kModulationHeadroom = 0.98f;
+
+int32_t to_q15(float value) {
+    return static_cast<int32_t>(value * 32768.0f + (value < 0.0f ? -0.5f : 0.5f));
+}
+}  // namespace
+
+void HapticsCore::configure(const HapticsTuning& tuning, uint32_t max_duty) {
+    tuning_ = tuning;
+    kernel_.configure(CommutationConfig{
+        .pole_pairs = tuning_.pole_pairs,
+        .direction = tuning_.sensor_direction,
+        .offset = electrical_offset_from_radians(tuning_.zero_electrical_offset),
+        .max_duty = max_duty,
+        .modulation = tuning_.modulation,
+    });
+    const float max_ratio = tuning_.modulation == Modulation::SpaceVector ? kSpaceVectorMaxRatio : kSinusoidalMaxRatio;
+    max_amplitude_q15_ = to_q15(std::clamp(tuning_.max_voltage_ratio, 0.0f, max_ratio * kModulationHeadroom));
+    effects_.configure(HapticEffectConfig{
+        .detent_positions = tuning_.detent_positions,
+        .detent_strength_q15 =
+            static_cast<int16_t>(std::min(to_q15(std::clamp(tuning_.detent_strength, 0.0f, 1.0f)), kQ15One)),
+        .damping_q16 = static_cast<int32_t>(tuning_.detent_damping * 65536.0f),
+        .wall_full_scale_raw = tuning_.wall_full_scale_raw,
+    });
+    predictor_ = AnglePredictor(tuning_.prediction);
+    observation_generation_ = 0;
+    torque_q15_ = 0;
+}
+
+PhaseDuty HapticsCore::step(const AngleObservation* observation, uint32_t generation, uint32_t now_us,
+                            int32_t strength_q15) {
+    if (observation == nullptr) {
+        predictor_.reset();
+        effects_.discard_pending();
+        torque_q15_ = 0;
+        return kernel_.centered();
+    }
+    if (generation != observation_generation_ || !predictor_.valid()) {
+        observation_generation_ = generation;
+        predictor_.observe(*observation);
+    }
+    const uint16_t raw_angle = tuning_.extrapolate_angle ? predictor_.predict(now_us) : observation->raw_angle;
+
+    const int32_t torque = effects_.render(raw_angle, predictor_.velocity(), now_us);
+    torque_q15_ = (torque * strength_q15) >> 15;
+    // The kernel's electrical angle follows the motor, so with a reversed
+    // sensor a positive amplitude turns the raw angle down.
+    const int32_t amplitude = (max_amplitude_q15_ * torque_q15_) >> 15;
+    return kernel_.update(raw_angle, tuning_.sensor_direction < 0 ? -amplitude : amplitude);
+}
+
+}  // namespace dial
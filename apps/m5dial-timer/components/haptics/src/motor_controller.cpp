@@ -1,12 +1,16 @@
 #include "haptics/motor_controller.h"
 
 #include <algorithm>
-#include <cmath>
 #include <atomic>
 
+#include <esp_attr.h>
+#include <esp_check.h>
+#include <esp_cpu.h>
 #include <esp_log.h>
 #include <esp_timer.h>
+#include <driver/gptimer.h>
 #include <driver/ledc.h>
+#include <driver/mcpwm_prelude.h>
 
 #include "input/encoder_reader.h"
 
@@ -14,11 +18,26 @@ namespace dial {
 
 namespace {
 constexpr const char* TAG = "MotorController";
-constexpr float kPi = 3.14159265358979323846f;
-constexpr float kTwoPi = 2.0f * kPi;
-constexpr float kPhaseShift = 2.0f * kPi / 3.0f;  // 120 deg
+
+constexpr uint32_t kLoopTimerResolutionHz = 1000 * 1000;
+constexpr int kMcpwmGroup = 0;
+constexpr uint32_t kMcpwmResolutionHz = 80 * 1000 * 1000;
+constexpr uint32_t kLedcSourceClockHz = 80 * 1000 * 1000;  // APB
+constexpr uint32_t kStatsPublishesPerSecond = 10;
 
 const ledc_channel_t kChannels[3] = {LEDC_CHANNEL_4, LEDC_CHANNEL_5, LEDC_CHANNEL_6};
+
+int32_t to_q15(float value) {
+    return static_cast<int32_t>(value * 32768.0f + (value < 0.0f ? -0.5f : 0.5f));
+}
+
+size_t jitter_bucket(uint32_t jitter_us) {
+    size_t bucket = 0;
+    while (bucket < kHapticsJitterBuckets - 1 && jitter_us >= kHapticsJitterBucketUs[bucket]) {
+        ++bucket;
+    }
+    return bucket;
+}
 }
 
 MotorController g_motor_controller;
@@ -30,12 +49,108 @@ esp_err_t MotorController::init(const HapticsConfig& config) {
 
     config_ = config;
 
+    active_pwm_backend_ = HapticsPwmBackend::Ledc;
+    if (config_.pwm_backend == HapticsPwmBackend::Mcpwm) {
+        const esp_err_t mcpwm_rc = init_mcpwm();
+        if (mcpwm_rc == ESP_OK) {
+            active_pwm_backend_ = HapticsPwmBackend::Mcpwm;
+        } else {
+            ESP_LOGW(TAG, "MCPWM unavailable (%s), using LEDC", esp_err_to_name(mcpwm_rc));
+        }
+    }
+    if (active_pwm_backend_ == HapticsPwmBackend::Ledc) {
+        ESP_RETURN_ON_ERROR(init_ledc(), TAG, "LEDC init failed");
+    }
+
+    core_.configure(config_.tuning, pwm_max_duty_);
+    ESP_RETURN_ON_ERROR(init_loop_timer(), TAG, "loop timer init failed");
+    initialised_ = true;
+    return ESP_OK;
+}
+
+// Three operators share one up-down timer. The generators drive high below
+// the compare value, which centres every phase's pulse on the zero point.
+// Each comparator's shadow value is loaded at the timer peak, the middle of
+// the low time, so a write to all three lands in the same period and never
+// cuts a pulse in half.
+esp_err_t MotorController::init_mcpwm() {
+    if (mcpwm_timer_ != nullptr) {
+        return ESP_OK;
+    }
+
+    mcpwm_timer_config_t timer_cfg = {};
+    timer_cfg.group_id = kMcpwmGroup;
+    timer_cfg.clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT;
+    timer_cfg.resolution_hz = kMcpwmResolutionHz;
+    timer_cfg.count_mode = MCPWM_TIMER_COUNT_MODE_UP_DOWN;
+    timer_cfg.period_ticks = kMcpwmResolutionHz / config_.pwm_frequency_hz;
+    ESP_RETURN_ON_ERROR(mcpwm_new_timer(&timer_cfg, &mcpwm_timer_), TAG, "mcpwm timer failed");
+
+    pwm_max_duty_ = timer_cfg.period_ticks / 2;  // peak of the up-down count
+    const uint32_t mid_duty = pwm_max_duty_ / 2;
+    const int gpios[3] = {config_.gpio_u, config_.gpio_v, config_.gpio_w};
+    for (int i = 0; i < 3; ++i) {
+        mcpwm_operator_config_t oper_cfg = {};
+        oper_cfg.group_id = kMcpwmGroup;
+        mcpwm_oper_handle_t oper = nullptr;
+        ESP_RETURN_ON_ERROR(mcpwm_new_operator(&oper_cfg, &oper), TAG, "mcpwm operator failed");
+        ESP_RETURN_ON_ERROR(mcpwm_operator_connect_timer(oper, mcpwm_timer_), TAG, "mcpwm connect failed");
+
+        mcpwm_comparator_config_t cmpr_cfg = {};
+        cmpr_cfg.flags.update_cmp_on_tep = true;
+        ESP_RETURN_ON_ERROR(mcpwm_new_comparator(oper, &cmpr_cfg, &mcpwm_comparators_[i]), TAG,
+                            "mcpwm comparator failed");
+        ESP_RETURN_ON_ERROR(mcpwm_comparator_set_compare_value(mcpwm_comparators_[i], mid_duty), TAG,
+                            "mcpwm compare failed");
+
+        mcpwm_generator_config_t gen_cfg = {};
+        gen_cfg.gen_gpio_num = gpios[i];
+        mcpwm_gen_handle_t gen = nullptr;
+        ESP_RETURN_ON_ERROR(mcpwm_new_generator(oper, &gen_cfg, &gen), TAG, "mcpwm generator failed");
+
+        const mcpwm_gen_timer_event_action_t on_zero = {
+            .direction = MCPWM_TIMER_DIRECTION_UP,
+            .event = MCPWM_TIMER_EVENT_EMPTY,
+            .action = MCPWM_GEN_ACTION_HIGH,
+        };
+        const mcpwm_gen_compare_event_action_t on_compare_up = {
+            .direction = MCPWM_TIMER_DIRECTION_UP,
+            .comparator = mcpwm_comparators_[i],
+            .action = MCPWM_GEN_ACTION_LOW,
+        };
+        const mcpwm_gen_compare_event_action_t on_compare_down = {
+            .direction = MCPWM_TIMER_DIRECTION_DOWN,
+            .comparator = mcpwm_comparators_[i],
+            .action = MCPWM_GEN_ACTION_HIGH,
+        };
+        ESP_RETURN_ON_ERROR(mcpwm_generator_set_action_on_timer_event(gen, on_zero), TAG, "mcpwm action failed");
+        ESP_RETURN_ON_ERROR(mcpwm_generator_set_action_on_compare_event(gen, on_compare_up), TAG,
+                            "mcpwm action failed");
+        ESP_RETURN_ON_ERROR(mcpwm_generator_set_action_on_compare_event(gen, on_compare_down), TAG,
+                            "mcpwm action failed");
+    }
+
+    ESP_RETURN_ON_ERROR(mcpwm_timer_enable(mcpwm_timer_), TAG, "mcpwm enable failed");
+    ESP_RETURN_ON_ERROR(mcpwm_timer_start_stop(mcpwm_timer_, MCPWM_TIMER_START_NO_STOP), TAG, "mcpwm start failed");
+    ESP_LOGI(TAG, "MCPWM phases at %lu Hz center-aligned, %lu duty steps",
+             static_cast<unsigned long>(config_.pwm_frequency_hz), static_cast<unsigned long>(pwm_max_duty_));
+    return ESP_OK;
+}
+
+esp_err_t MotorController::init_ledc() {
+    // The APB clock caps resolution at a given frequency (10 bits at 50 kHz).
+    uint32_t bits = config_.resolution_bits;
+    while (bits > 1 && (kLedcSourceClockHz >> bits) < config_.pwm_frequency_hz) {
+        --bits;
+    }
+    pwm_max_duty_ = (1u << bits) - 1u;
+
     ledc_timer_config_t timer_cfg = {
-        .speed_mode = LEDC_HIGH_SPEED_MODE,
-        .duty_resolution = static_cast<ledc_timer_bit_t>(config_.resolution_bits),
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .duty_resolution = static_cast<ledc_timer_bit_t>(bits),
         .timer_num = LEDC_TIMER_1,
         .freq_hz = config_.pwm_frequency_hz,
-        .clk_cfg = LEDC_AUTO_CLK,
+        .clk_cfg = LEDC_USE_APB_CLK,
     };
     ESP_RETURN_ON_ERROR(ledc_timer_config(&timer_cfg), TAG, "timer config failed");
 
@@ -44,17 +159,40 @@ esp_err_t MotorController::init(const HapticsConfig& config) {
     for (int i = 0; i < 3; ++i) {
         ledc_channel_config_t channel_cfg = {};
         channel_cfg.gpio_num = gpios[i];
-        channel_cfg.speed_mode = LEDC_HIGH_SPEED_MODE;
+        channel_cfg.speed_mode = LEDC_LOW_SPEED_MODE;
         channel_cfg.channel = kChannels[i];
         channel_cfg.intr_type = LEDC_INTR_DISABLE;
         channel_cfg.timer_sel = LEDC_TIMER_1;
-        channel_cfg.duty = (1u << config_.resolution_bits) / 2;
+        channel_cfg.duty = (1u << bits) / 2;
         channel_cfg.hpoint = 0;
         ESP_RETURN_ON_ERROR(ledc_channel_config(&channel_cfg), TAG, "channel config failed");
     }
+    ESP_LOGI(TAG, "LEDC phases at %lu Hz, %lu-bit duty", static_cast<unsigned long>(config_.pwm_frequency_hz),
+             static_cast<unsigned long>(bits));
+    return ESP_OK;
+}
 
-    electrical_offset_ = config_.zero_electrical_offset;
-    initialised_ = true;
+esp_err_t MotorController::init_loop_timer() {
+    loop_rate_hz_ = std::clamp(config_.loop_rate_hz, kMinHapticsLoopRateHz, kMaxHapticsLoopRateHz);
+    period_us_ = kLoopTimerResolutionHz / loop_rate_hz_;
+
+    gptimer_config_t timer_cfg = {};
+    timer_cfg.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+    timer_cfg.direction = GPTIMER_COUNT_UP;
+    timer_cfg.resolution_hz = kLoopTimerResolutionHz;
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_cfg, &loop_timer_), TAG, "gptimer create failed");
+
+    gptimer_event_callbacks_t callbacks = {};
+    callbacks.on_alarm = &MotorController::on_loop_alarm;
+    ESP_RETURN_ON_ERROR(gptimer_register_event_callbacks(loop_timer_, &callbacks, this), TAG,
+                        "gptimer callback failed");
+
+    gptimer_alarm_config_t alarm_cfg = {};
+    alarm_cfg.alarm_count = period_us_;
+    alarm_cfg.reload_count = 0;
+    alarm_cfg.flags.auto_reload_on_alarm = true;
+    ESP_RETURN_ON_ERROR(gptimer_set_alarm_action(loop_timer_, &alarm_cfg), TAG, "gptimer alarm failed");
+    ESP_RETURN_ON_ERROR(gptimer_enable(loop_timer_), TAG, "gptimer enable failed");
     return ESP_OK;
 }
 
@@ -68,13 +206,22 @@ void MotorController::start() {
         "motor_ctrl",
         4096,
         this,
-        6,
+        config_.task_priority,
         &task_handle_,
-        1);
+        config_.task_core_id);
     if (res != pdPASS) {
         ESP_LOGE(TAG, "Failed to create motor control task");
         task_handle_ = nullptr;
+        return;
+    }
+
+    // The alarm only notifies, so it is started after the task exists.
+    if (gptimer_start(loop_timer_) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start haptics loop timer");
+        return;
     }
+    ESP_LOGI(TAG, "Haptics loop at %lu Hz on core %d", static_cast<unsigned long>(loop_rate_hz_),
+             static_cast<int>(config_.task_core_id));
 }
 
 void MotorController::enable(bool enabled) {
@@ -82,7 +229,69 @@ void MotorController::enable(bool enabled) {
 }
 
 void MotorController::set_strength(float strength) {
-    strength_scale_.store(std::clamp(strength, 0.0f, 1.0f), std::memory_order_relaxed);
+    strength_q15_.store(std::min(to_q15(std::clamp(strength, 0.0f, 1.0f)), kQ15One), std::memory_order_relaxed);
+}
+
+HapticsLoopStats MotorController::stats() const {
+    portENTER_CRITICAL(&stats_lock_);
+    const HapticsLoopStats out = stats_;
+    portEXIT_CRITICAL(&stats_lock_);
+    return out;
+}
+
+void MotorController::log_stats() {
+    if (!initialised_) {
+        return;
+    }
+    const HapticsLoopStats s = stats();
+    const int64_t now_us = esp_timer_get_time();
+    const double elapsed_s = last_logged_us_ > 0 ? static_cast<double>(now_us - last_logged_us_) / 1e6 : 0.0;
+    const double loops_per_s = elapsed_s > 0.0 ? static_cast<double>(s.loops - last_logged_loops_) / elapsed_s : 0.0;
+    const uint32_t new_overruns = s.overruns - last_logged_overruns_;
+    last_logged_loops_ = s.loops;
+    last_logged_overruns_ = s.overruns;
+    last_logged_us_ = now_us;
+
+    const double loops = s.loops > 0 ? static_cast<double>(s.loops) : 1.0;
+
+    ESP_LOGI(TAG, "%lu Hz target: %.1f loops/s, %lu overruns (%lu total), exec mean %.1f max %lu us, "
+                  "period error mean %.1f max %lu us, <5/<10/<25/<50/<100/>=100 us: %lu/%lu/%lu/%lu/%lu/%lu, "
+                  "wake latency max %lu us",
+             static_cast<unsigned long>(s.loop_rate_hz), loops_per_s, static_cast<unsigned long>(new_overruns),
+             static_cast<unsigned long>(s.overruns), static_cast<double>(s.exec_total_us) / loops,
+             static_cast<unsigned long>(s.exec_max_us), static_cast<double>(s.jitter_total_us) / loops,
+             static_cast<unsigned long>(s.jitter_max_us), static_cast<unsigned long>(s.jitter_buckets[0]),
+             static_cast<unsigned long>(s.jitter_buckets[1]), static_cast<unsigned long>(s.jitter_buckets[2]),
+             static_cast<unsigned long>(s.jitter_buckets[3]), static_cast<unsigned long>(s.jitter_buckets[4]),
+             static_cast<unsigned long>(s.jitter_buckets[5]), static_cast<unsigned long>(s.wake_latency_max_us));
+    ESP_LOGI(TAG, "%s update: mean %.0f max %lu cycles", s.pwm_backend == HapticsPwmBackend::Mcpwm ? "MCPWM" : "LEDC",
+             static_cast<double>(s.pwm_cycles_total) / loops, static_cast<unsigned long>(s.pwm_cycles_max));
+
+    const AnglePredictionStats& p = s.prediction;
+    const double predictions = p.predictions > 0 ? static_cast<double>(p.predictions) : 1.0;
+    const double scored = p.scored > 0 ? static_cast<double>(p.scored) : 1.0;
+    ESP_LOGI(TAG, "Angle %s: sample age mean %.0f max %lu us (%lu past horizon), error vs next sample "
+                  "mean %.1f max %lu raw, holding the angle mean %.1f max %lu raw (%lu samples)",
+             config_.tuning.extrapolate_angle ? "extrapolated" : "held", static_cast<double>(p.age_total_us) / predictions,
+             static_cast<unsigned long>(p.age_max_us), static_cast<unsigned long>(p.horizon_clamps),
+             static_cast<double>(p.error_total_raw) / scored, static_cast<unsigned long>(p.error_max_raw),
+             static_cast<double>(p.hold_error_total_raw) / scored, static_cast<unsigned long>(p.hold_error_max_raw),
+             static_cast<unsigned long>(p.scored));
+
+    const HapticEffectStats& e = s.effects;
+    ESP_LOGI(TAG, "Effects: %lu commands (%lu dropped, %lu discarded while idle), %lu played, %lu voices stolen, "
+                  "%lu wall engagements",
+             static_cast<unsigned long>(e.commands), static_cast<unsigned long>(e.dropped),
+             static_cast<unsigned long>(e.discarded), static_cast<unsigned long>(e.played),
+             static_cast<unsigned long>(e.voices_stolen), static_cast<unsigned long>(e.wall_engagements));
+}
+
+bool IRAM_ATTR MotorController::on_loop_alarm(gptimer_handle_t, const gptimer_alarm_event_data_t*, void* user_ctx) {
+    auto* self = static_cast<MotorController*>(user_ctx);
+    self->alarm_us_.store(esp_timer_get_time(), std::memory_order_relaxed);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->task_handle_, &woken);
+    return woken == pdTRUE;
 }
 
 void MotorController::task_entry(void* arg) {
@@ -91,53 +300,80 @@ void MotorController::task_entry(void* arg) {
 }
 
 void MotorController::run() {
-    const TickType_t delay_ticks = config_.update_interval_ticks;
-    const float max_ratio = std::clamp(config_.max_voltage_ratio, 0.0f, 0.49f);
+    const uint32_t publish_every = std::max<uint32_t>(1, loop_rate_hz_ / kStatsPublishesPerSecond);
 
-    while (true) {
-        uint16_t raw_angle = 0;
-        if (!g_encoder_reader.latest_raw_angle(&raw_angle)) {
-            apply_pwm(0.5f, 0.5f, 0.5f);
-            vTaskDelay(delay_ticks);
-            continue;
-        }
+    // Accumulated locally and copied out under the lock a few times a
+    // second, so the hot path never takes it.
+    HapticsLoopStats local{};
+    local.loop_rate_hz = loop_rate_hz_;
+    local.pwm_backend = active_pwm_backend_;
+    int64_t last_wake_us = 0;
 
-        if (!enabled_.load(std::memory_order_relaxed)) {
-            apply_pwm(0.5f, 0.5f, 0.5f);
-            vTaskDelay(delay_ticks);
+    while (true) {
+        const uint32_t alarms = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const int64_t wake_us = esp_timer_get_time();
+        if (alarms == 0) {
             continue;
         }
 
-        const float mech_angle = (static_cast<float>(raw_angle) / 16384.0f) * kTwoPi;
-        const float detent_angle = mech_angle * static_cast<float>(config_.detent_positions);
-        const float torque = -std::sin(detent_angle);
-        const float gain = std::clamp(config_.detent_strength * strength_scale_.load(std::memory_order_relaxed), 0.0f, 1.0f);
-        const float torque_cmd = std::clamp(gain * torque, -1.0f, 1.0f);
-
-        float electrical_angle = mech_angle * static_cast<float>(config_.pole_pairs);
-        electrical_angle *= static_cast<float>(config_.sensor_direction);
-        electrical_angle += electrical_offset_;
-        const float amplitude = max_ratio * torque_cmd;
+        const PhaseDuty duty = step(static_cast<uint32_t>(wake_us));
+        const uint32_t pwm_start = esp_cpu_get_cycle_count();
+        apply_pwm(duty);
+        const uint32_t pwm_cycles = esp_cpu_get_cycle_count() - pwm_start;
+        const int64_t done_us = esp_timer_get_time();
 
-        auto phase_value = [&](float phase_shift) {
-            float value = 0.5f + amplitude * std::sin(electrical_angle + phase_shift);
-            return std::clamp(value, 0.0f, 1.0f);
-        };
+        ++local.loops;
+        local.overruns += alarms - 1;
+        const uint32_t exec_us = static_cast<uint32_t>(done_us - wake_us);
+        local.exec_total_us += exec_us;
+        local.exec_max_us = std::max(local.exec_max_us, exec_us);
+        const uint32_t latency_us = static_cast<uint32_t>(std::max<int64_t>(
+            0, wake_us - alarm_us_.load(std::memory_order_relaxed)));
+        local.wake_latency_max_us = std::max(local.wake_latency_max_us, latency_us);
+        local.pwm_cycles_total += pwm_cycles;
+        local.pwm_cycles_max = std::max(local.pwm_cycles_max, pwm_cycles);
+        if (last_wake_us > 0) {
+            // Missed alarms are counted as overruns, not as period error.
+            const int64_t expected_us = static_cast<int64_t>(alarms) * period_us_;
+            const int64_t error_us = (wake_us - last_wake_us) - expected_us;
+            const uint32_t jitter_us = static_cast<uint32_t>(error_us < 0 ? -error_us : error_us);
+            local.jitter_total_us += jitter_us;
+            local.jitter_max_us = std::max(local.jitter_max_us, jitter_us);
+            ++local.jitter_buckets[jitter_bucket(jitter_us)];
+        }
+        last_wake_us = wake_us;
 
-        apply_pwm(phase_value(0.0f), phase_value(-kPhaseShift), phase_value(+kPhaseShift));
-        vTaskDelay(delay_ticks);
+        if (local.loops % publish_every == 0) {
+            local.prediction = core_.prediction_stats();
+            local.effects = core_.effects().stats();
+            portENTER_CRITICAL(&stats_lock_);
+            stats_ = local;
+            portEXIT_CRITICAL(&stats_lock_);
+        }
     }
 }
 
-void MotorController::apply_pwm(float a, float b, float c) {
-    const uint32_t max_duty = (1u << config_.resolution_bits) - 1u;
-    const float phases[3] = {a, b, c};
+PhaseDuty MotorController::step(uint32_t now_us) {
+    AngleObservation observation{};
+    uint32_t generation = 0;
+    const bool live =
+        g_encoder_reader.latest_observation(&observation, &generation) && enabled_.load(std::memory_order_relaxed);
+    return core_.step(live ? &observation : nullptr, generation, now_us, strength_q15_.load(std::memory_order_relaxed));
+}
+
+void MotorController::apply_pwm(const PhaseDuty& duty) {
+    const uint32_t duties[3] = {duty.u, duty.v, duty.w};
+    if (active_pwm_backend_ == HapticsPwmBackend::Mcpwm) {
+        // Shadow registers only; nothing reaches the pins before the timer peak.
+        for (int i = 0; i < 3; ++i) {
+            mcpwm_comparator_set_compare_value(mcpwm_comparators_[i], duties[i]);
+        }
+        return;
+    }
 
     for (int i = 0; i < 3; ++i) {
-        float clamped = std::clamp(phases[i], 0.0f, 1.0f);
-        uint32_t duty = static_cast<uint32_t>(clamped * static_cast<float>(max_duty));
-        ledc_set_duty(LEDC_HIGH_SPEED_MODE, kChannels[i], duty);
-        ledc_update_duty(LEDC_HIGH_SPEED_MODE, kChannels[i]);
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, kChannels[i], duties[i]);
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, kChannels[i]);
     }
 }
 
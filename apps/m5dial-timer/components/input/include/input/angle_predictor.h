@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+// One encoder measurement as EncoderReader publishes it: the raw angle, when
+// it was sampled, and the tracker's velocity at that moment.
+struct AngleObservation {
+    uint32_t timestamp_us;
+    int32_t velocity;  // raw units per second
+    uint16_t raw_angle;
+    bool valid;        // false after a failed read
+};
+
+struct AnglePredictorConfig {
+    uint32_t max_horizon_us = 20000;  // older observations extrapolate no further than this
+    uint32_t max_advance_raw = 2048;  // cap on the extrapolated step (1/8 turn)
+    // Take the velocity from the last two observations instead of the
+    // tracker's, when they are at most max_horizon_us apart. The difference
+    // lags half a sample interval; the tracker's filter lags several, which
+    // at the 5 ms Active rate is a quarter of a detent's ring period.
+    bool difference_velocity = false;
+};
+
+// Prediction error is scored each time a new observation arrives: the
+// previous observation extrapolated to the new timestamp against the
+// measured angle, alongside the error of simply holding the old angle.
+struct AnglePredictionStats {
+    uint32_t predictions = 0;
+    uint64_t age_total_us = 0;  // observation age at prediction time
+    uint32_t age_max_us = 0;
+    uint32_t horizon_clamps = 0;
+    uint32_t scored = 0;
+    uint64_t error_total_raw = 0;
+    uint32_t error_max_raw = 0;
+    uint64_t hold_error_total_raw = 0;
+    uint32_t hold_error_max_raw = 0;
+};
+
+// Constant-velocity extrapolation of the rotor angle between encoder samples,
+// bounded in time and distance so a stale or noisy velocity cannot run away.
+// Platform-free; owned by a single loop.
+class AnglePredictor {
+public:
+    explicit AnglePredictor(const AnglePredictorConfig& config = {}) : config_(config) {}
+
+    void reset() { has_observation_ = false; }
+
+    // Feeds a new observation; scores the previous one against it.
+    void observe(const AngleObservation& observation);
+
+    bool valid() const { return has_observation_; }
+    const AngleObservation& observation() const { return observation_; }
+    // Raw units per second, as used for the extrapolation; requires valid().
+    int32_t velocity() const { return velocity_; }
+
+    // Raw angle extrapolated to `now_us`; requires valid().
+    uint16_t predict(uint32_t now_us);
+
+    const AnglePredictionStats& stats() const { return stats_; }
+
+private:
+    int32_t advance(uint32_t dt_us) const;
+
+    AnglePredictorConfig config_;
+    AngleObservation observation_{};
+    int32_t velocity_ = 0;
+    bool has_observation_ = false;
+    AnglePredictionStats stats_{};
+};
+
+}  // namespace dial
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dial {
+
+// One knot of a ballistic transfer function: at `ticks_per_second` of
+// filtered dial speed, each detent moves the setpoint `seconds_per_tick`.
+struct BallisticKnot {
+    uint16_t ticks_per_second;
+    uint16_t seconds_per_tick;
+};
+
+constexpr size_t kMaxBallisticKnots = 8;
+
+// Knots in increasing speed. Between knots the step is interpolated (or held
+// from the slower knot when `interpolate` is false) and then snapped to the
+// nearest entry of kBallisticSteps. With `align`, each step lands the total
+// on a multiple of the step, so a fast spin from 17:00 goes 30:00, 45:00
+// rather than 32:00, 47:00.
+struct BallisticCurve {
+    std::array<BallisticKnot, kMaxBallisticKnots> knots;
+    uint8_t knot_count;
+    bool interpolate;
+    bool align;
+};
+
+// Step sizes a curve may produce, in seconds.
+constexpr std::array<uint16_t, 7> kBallisticSteps = {60, 120, 300, 600, 900, 1800, 3600};
+
+namespace ballistic {
+
+// The original three speed tiers: 15 min, x2 from 20 ticks/s, x4 from 40.
+constexpr BallisticCurve kLegacyTiers{{{{0, 900}, {20, 1800}, {40, 3600}}}, 3, false, false};
+// Minutes while turning slowly, quarter hours at a brisk turn, hours when spun.
+constexpr BallisticCurve kSmooth{{{{0, 60}, {6, 60}, {15, 300}, {30, 900}, {60, 1800}, {100, 3600}}}, 6, true, true};
+// Like kSmooth with a shorter ramp; for operators who mostly set long timers.
+constexpr BallisticCurve kQuick{{{{0, 60}, {4, 120}, {10, 600}, {20, 1800}, {45, 3600}}}, 5, true, true};
+
+}  // namespace ballistic
+
+// The curve expanded into a lookup table by whole ticks per second, so the
+// per-tick cost is a multiply, a shift and a load. Platform-free.
+class BallisticTable {
+public:
+    static constexpr uint32_t kMaxTicksPerSecond = 255;
+
+    void build(const BallisticCurve& curve, uint32_t ticks_per_revolution);
+
+    // `velocity_raw` is the tracker's velocity in MT6701 raw units per second.
+    uint32_t seconds_per_tick(int32_t velocity_raw) const {
+        const uint64_t speed = static_cast<uint64_t>(velocity_raw < 0 ? -static_cast<int64_t>(velocity_raw) : velocity_raw);
+        const uint64_t tps = (speed * ticks_per_revolution_) >> 14;
+        return lut_[tps > kMaxTicksPerSecond ? kMaxTicksPerSecond : tps];
+    }
+
+    // Moves `total` by `delta_ticks` steps of `step_seconds`, landing on the
+    // step grid when the curve aligns. Not clamped.
+    int32_t advance(int32_t total, int32_t delta_ticks, uint32_t step_seconds) const;
+
+    uint32_t finest_step() const { return lut_[0]; }
+
+private:
+    std::array<uint16_t, kMaxTicksPerSecond + 1> lut_{};
+    uint32_t ticks_per_revolution_ = 96;
+    bool align_ = false;
+};
+
+}  // namespace dial
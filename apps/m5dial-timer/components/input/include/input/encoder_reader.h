@@ -5,16 +5,29 @@
 #include <atomic>
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "freertos/task.h"
 #include "esp_err.h"
 #include "driver/i2c.h"
+#include "driver/pulse_cnt.h"
+#include "esp_timer.h"
+
+#include "input/angle_predictor.h"
+#include "input/encoder_ticks.h"
+#include "input/motion_tracker.h"
+#include "input/sample_rate.h"
+#include "ringbuf/seqlock.h"
 
 namespace dial {
 
 struct EncoderSample {
     int32_t delta_ticks;
     uint32_t timestamp_us;
+    EncoderMotion motion;  // tracker state when the sample was taken
+};
+
+enum class EncoderBackend : uint8_t {
+    I2cPoll,  // poll the absolute angle over I2C
+    PcntAbz,  // count the MT6701 A/B outputs in the PCNT peripheral; I2C only resyncs
 };
 
 struct EncoderConfig {
@@ -22,7 +35,6 @@ struct EncoderConfig {
     int scl_gpio;
     i2c_port_t i2c_port = I2C_NUM_1;
     uint8_t i2c_address = 0x06;          // 7-bit address
-    uint32_t sample_queue_depth = 64;
     uint32_t poll_interval_ms = 5;
     uint32_t ticks_per_revolution = 96;
     uint32_t i2c_clock_hz = 400000;
@@ -30,27 +42,90 @@ struct EncoderConfig {
     uint32_t task_stack_size = 3072;
     UBaseType_t task_priority = 5;
     BaseType_t task_core_id = 0;
+    EncoderBackend backend = EncoderBackend::I2cPoll;
+    int abz_a_gpio = -1;
+    int abz_b_gpio = -1;
+    uint32_t abz_pulses_per_revolution = 960;  // must match the MT6701 ABZ_RES setting
+    uint32_t abz_glitch_ns = 1000;
+    uint32_t resync_interval_ms = 500;
+    bool adaptive_sampling = true;  // off: fixed poll_interval_ms
+    SampleRateConfig sampling{};
+    MotionTrackerConfig motion{};
+};
+
+struct EncoderStats {
+    uint32_t samples;
+    uint32_t pcnt_events;
+    uint32_t i2c_reads;
+    uint32_t i2c_transactions;
+    uint32_t i2c_errors;
+    uint32_t resync_corrections;
+    SampleRate sample_rate;
+    uint32_t sample_interval_us;
+    uint32_t rate_changes;
 };
 
 class EncoderReader {
 public:
     EncoderReader() = default;
+    // Starts the reader task, which feeds g_time_selector inline; initialise
+    // the selector first.
     esp_err_t init(const EncoderConfig& config);
-    QueueHandle_t queue() const { return sample_queue_; }
     bool latest_raw_angle(uint16_t* out) const;
+    // Latest filtered motion; false until the tracker has a measurement.
+    bool latest_motion(EncoderMotion* out) const;
+    // Latest absolute angle with its sample time and velocity, lock-free for
+    // the haptic loop. `generation` changes with every new sample. False if
+    // nothing was read yet or the last read failed.
+    bool latest_observation(AngleObservation* out, uint32_t* generation = nullptr) const;
+    EncoderBackend active_backend() const { return active_backend_; }
+    EncoderStats stats() const;
+    void log_stats();
 
 private:
     static void task_entry(void* arg);
+    static void on_sample_timer(void* arg);
+    static bool on_pcnt_reach(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t* edata, void* user_ctx);
     void run();
+    void run_abz();
+    void resync_abz();
+    esp_err_t init_pcnt();
     esp_err_t read_raw_angle(uint16_t* out_raw);
+    void publish(int32_t delta_ticks, const EncoderMotion& motion, uint32_t timestamp_us);
+    void publish_angle(uint16_t raw, uint32_t timestamp_us, int32_t velocity);
+    void invalidate_angle();
+    EncoderMotion track(int32_t position, uint32_t timestamp_us);
+    void wait_until(int64_t wake_us);
 
     EncoderConfig config_{};
-    QueueHandle_t sample_queue_ = nullptr;
     TaskHandle_t task_handle_ = nullptr;
     std::atomic<bool> has_last_angle_{false};
     std::atomic<uint16_t> last_angle_raw_{0};
-    float residual_ticks_ = 0.0f;
+    SeqlockCell<AngleObservation> observation_{};
+    AngleTickAccumulator angle_ticks_{};
+    mutable portMUX_TYPE motion_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    MotionTracker tracker_{};
+    EncoderMotion latest_motion_{};
+    int32_t unwrapped_angle_ = 0;   // I2C path measurement, raw units
+    int32_t raw_per_tick_q8_ = 0;   // ABZ path measurement scale
     bool i2c_ready_ = false;
+    EncoderBackend active_backend_ = EncoderBackend::I2cPoll;
+    pcnt_unit_handle_t pcnt_unit_ = nullptr;
+    std::atomic<int32_t> pcnt_position_{0};
+    std::atomic<uint32_t> pcnt_edge_us_{0};
+    AbzResync abz_resync_{};
+    std::atomic<uint32_t> samples_{0};
+    std::atomic<uint32_t> pcnt_events_{0};
+    esp_timer_handle_t sample_timer_ = nullptr;
+    SampleRate sample_rate_ = SampleRate::Active;
+    uint32_t sample_interval_us_ = 0;
+    uint32_t rate_changes_ = 0;
+    uint32_t i2c_reads_ = 0;
+    uint32_t i2c_transactions_ = 0;
+    uint32_t i2c_errors_ = 0;
+    uint32_t resync_corrections_ = 0;
+    int64_t last_logged_us_ = 0;
+    uint32_t last_logged_reads_ = 0;
 };
 
 extern EncoderReader g_encoder_reader;
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+constexpr uint16_t kMt6701AngleResolution = 16384;  // 14-bit full scale
+
+// Shortest signed change between two raw angles.
+constexpr int32_t mt6701_angle_delta(uint16_t from, uint16_t to) {
+    int32_t delta = static_cast<int32_t>(to) - static_cast<int32_t>(from);
+    if (delta > kMt6701AngleResolution / 2) {
+        delta -= kMt6701AngleResolution;
+    } else if (delta < -static_cast<int32_t>(kMt6701AngleResolution / 2)) {
+        delta += kMt6701AngleResolution;
+    }
+    return delta;
+}
+
+// Absolute-angle path: turns successive 14-bit MT6701 readings into whole
+// detent ticks, carrying the fractional remainder between readings.
+class AngleTickAccumulator {
+public:
+    explicit AngleTickAccumulator(uint32_t ticks_per_revolution = 96) { set_ticks_per_revolution(ticks_per_revolution); }
+
+    void set_ticks_per_revolution(uint32_t ticks_per_revolution) {
+        ticks_per_unit_ = static_cast<float>(ticks_per_revolution) / static_cast<float>(kMt6701AngleResolution);
+        reset();
+    }
+
+    void reset() {
+        has_last_ = false;
+        residual_ticks_ = 0.0f;
+    }
+
+    // Whole ticks since the previous reading; 0 for the first one after reset().
+    int32_t update(uint16_t raw) {
+        if (!has_last_) {
+            has_last_ = true;
+            last_raw_ = raw;
+            return 0;
+        }
+        const int32_t delta = mt6701_angle_delta(last_raw_, raw);
+        last_raw_ = raw;
+
+        residual_ticks_ += static_cast<float>(delta) * ticks_per_unit_;
+        const int32_t ticks = static_cast<int32_t>(residual_ticks_);
+        residual_ticks_ -= static_cast<float>(ticks);
+        return ticks;
+    }
+
+private:
+    float ticks_per_unit_ = 0.0f;
+    float residual_ticks_ = 0.0f;
+    uint16_t last_raw_ = 0;
+    bool has_last_ = false;
+};
+
+// Incremental (ABZ) path: the pulse counter decodes A/B in 4x mode and its
+// limits are set to +/- counts_per_tick, so every limit hit is exactly one
+// detent tick and the counter clears itself. Reversing right after a tick
+// needs a full tick of travel, which doubles as hysteresis.
+
+// Quadrature counts per detent tick, or 0 when the PPR does not divide evenly.
+constexpr int32_t abz_counts_per_tick(uint32_t pulses_per_revolution, uint32_t ticks_per_revolution) {
+    if (pulses_per_revolution == 0 || ticks_per_revolution == 0) {
+        return 0;
+    }
+    const uint32_t counts = pulses_per_revolution * 4;
+    return counts % ticks_per_revolution == 0 ? static_cast<int32_t>(counts / ticks_per_revolution) : 0;
+}
+
+// Tick delta for a pulse-counter watch point at `watch_value`.
+constexpr int32_t abz_watch_delta(int watch_value) {
+    return watch_value > 0 ? 1 : (watch_value < 0 ? -1 : 0);
+}
+
+// I2C resync for the ABZ path. Compares the detent index implied by the
+// absolute angle with the counted position modulo one revolution, so a fast
+// spin between resyncs cannot alias. The first settled reading latches the offset
+// between the two; later readings taken while the count is unchanged return
+// the correction needed to get back within the one-tick hysteresis slack
+// (missed or extra pulses). Only readings with the count unchanged since the
+// previous one are used, because the angle and the count are not sampled at
+// the same instant.
+class AbzResync {
+public:
+    explicit AbzResync(uint32_t ticks_per_revolution = 96)
+        : ticks_per_revolution_(static_cast<int32_t>(ticks_per_revolution)) {}
+
+    void reset() {
+        has_offset_ = false;
+        has_last_ = false;
+    }
+
+    // The caller adds a non-zero result to its counted position.
+    int32_t correction(uint16_t raw, int32_t position) {
+        const bool settled = has_last_ && position == last_position_;
+        has_last_ = true;
+        last_position_ = position;
+        if (!settled) {
+            return 0;
+        }
+        const int32_t angle_tick =
+            static_cast<int32_t>((static_cast<uint32_t>(raw) * ticks_per_revolution_) / kMt6701AngleResolution);
+        if (!has_offset_) {
+            has_offset_ = true;
+            offset_ = wrap(angle_tick - position);
+            return 0;
+        }
+        int32_t error = wrap(angle_tick - position - offset_);
+        if (error >= ticks_per_revolution_ / 2) {
+            error -= ticks_per_revolution_;
+        }
+        if (error > 1 || error < -1) {
+            last_position_ += error;
+            return error;
+        }
+        return 0;
+    }
+
+private:
+    int32_t wrap(int32_t ticks) const {
+        const int32_t r = ticks % ticks_per_revolution_;
+        return r < 0 ? r + ticks_per_revolution_ : r;
+    }
+
+    int32_t ticks_per_revolution_;
+    int32_t offset_ = 0;
+    int32_t last_position_ = 0;
+    bool has_offset_ = false;
+    bool has_last_ = false;
+};
+
+}  // namespace dial
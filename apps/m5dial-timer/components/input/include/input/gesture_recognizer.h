@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "board/touch_types.h"
+#include "input/touch_event.h"
+
+namespace dial {
+
+// Thresholds in controller pixels and milliseconds.
+struct GestureConfig {
+    uint32_t tap_max_duration_ms = 400;
+    uint32_t double_tap_max_interval_ms = 350;
+    uint32_t long_press_min_duration_ms = 600;
+    uint16_t tap_max_movement = 40;
+    uint16_t swipe_min_distance = 60;
+    uint32_t swipe_max_duration_ms = 700;
+    uint8_t edge_zone_percent = 20;
+    uint16_t screen_width = 240;
+    uint16_t screen_height = 240;
+};
+
+// One controller read. contact_start_us, when set on the sample that first
+// sees a contact, backdates the contact to the INT edge so tap and long-press
+// timing does not depend on the poll interval.
+struct TouchSample {
+    int64_t timestamp_us = 0;
+    int64_t contact_start_us = -1;
+    TouchReport report{};
+};
+
+// A 5-byte point read carries one point; it fills both report slots so the
+// two-finger midpoint is that point.
+inline TouchSample touch_sample(int64_t timestamp_us, const TouchPoint& point) {
+    TouchSample sample{};
+    sample.timestamp_us = timestamp_us;
+    if (point.touched) {
+        sample.report.touch_count = point.touch_count > 0 ? point.touch_count : 1;
+        sample.report.x[0] = sample.report.x[1] = point.x;
+        sample.report.y[0] = sample.report.y[1] = point.y;
+    }
+    return sample;
+}
+
+enum class GestureState : uint8_t {
+    Idle,     // no contact; a single tap may be waiting out the double-tap window
+    Pressed,  // one finger down, still a tap, swipe or long-press candidate
+    Held,     // one finger down, long press already reported
+    Multi,    // two or more fingers seen during this contact
+};
+
+// Touch count of the sample, the column the transition table is indexed by.
+enum class GestureInput : uint8_t {
+    Release,
+    Contact,
+    Multi,
+};
+
+constexpr uint32_t kGestureStateCount = 4;
+constexpr uint32_t kGestureInputCount = 3;
+
+// Guard conditions, sampled before any action runs.
+constexpr uint8_t kGestureGuardTapDue = 1u << 0;         // pending tap past its double-tap window
+constexpr uint8_t kGestureGuardDoubleWindow = 1u << 1;   // pending tap still inside its window
+constexpr uint8_t kGestureGuardLongPressDue = 1u << 2;   // contact held for long_press_min_duration_ms
+constexpr uint8_t kGestureGuardTapShape = 1u << 3;       // contact short and still enough for a tap
+constexpr uint8_t kGestureGuardSwipeShape = 1u << 4;     // contact long and quick enough for a swipe
+constexpr uint8_t kGestureGuardHardwareSwipe = 1u << 5;  // controller reported a move gesture
+constexpr uint32_t kGestureGuardBits = 6;
+
+// Actions, applied in this order.
+constexpr uint16_t kGestureActionFlushTap = 1u << 0;       // report the pending tap, if any
+constexpr uint16_t kGestureActionBeginContact = 1u << 1;   // contact start point and time
+constexpr uint16_t kGestureActionTrack = 1u << 2;          // contact's latest point
+constexpr uint16_t kGestureActionBeginMulti = 1u << 3;     // two-finger start point and time
+constexpr uint16_t kGestureActionLongPress = 1u << 4;
+constexpr uint16_t kGestureActionHardwareSwipe = 1u << 5;  // direction from the gesture ID
+constexpr uint16_t kGestureActionSwipe = 1u << 6;          // direction from the end points
+constexpr uint16_t kGestureActionDoubleTap = 1u << 7;      // pairs with the pending tap
+constexpr uint16_t kGestureActionPendTap = 1u << 8;        // hold the tap for the double-tap window
+constexpr uint16_t kGestureActionTwoFinger = 1u << 9;
+constexpr uint16_t kGestureActionDropTap = 1u << 10;       // forget the pending tap
+
+struct GestureTransition {
+    GestureState next;
+    uint16_t actions;
+};
+
+// Single table lookup; the table is generated at compile time from the rule
+// list in gesture_recognizer.cpp.
+GestureTransition next_gesture_transition(GestureState current, GestureInput input, uint8_t guards);
+
+// Most events one update() can report: a pending tap flushed ahead of the
+// contact's own gesture.
+constexpr size_t kMaxGestureEvents = 2;
+
+// Turns a stream of timestamped samples into TouchEvents. Platform-free: the
+// firmware feeds it controller reads, the host tools recorded or synthetic
+// traces and the simulator's mouse. Not thread-safe.
+class GestureRecognizer {
+public:
+    explicit GestureRecognizer(const GestureConfig& config = {}) { configure(config); }
+
+    void configure(const GestureConfig& config);
+    const GestureConfig& config() const { return config_; }
+    void reset();
+
+    // Samples must be in timestamp order. Writes up to kMaxGestureEvents
+    // events to `out` and returns how many. A pending tap is only reported by
+    // a later sample, so an idle caller should feed one at tap_deadline_us().
+    size_t update(const TouchSample& sample, TouchEvent* out);
+
+    GestureState state() const { return state_; }
+    bool contact_active() const { return state_ != GestureState::Idle; }
+    bool tap_pending() const { return pending_tap_; }
+    int64_t tap_deadline_us() const { return pending_tap_timestamp_us_ + double_tap_us_; }
+
+    uint32_t samples() const { return samples_; }
+    uint32_t hardware_swipes() const { return hardware_swipes_; }
+    uint32_t software_swipes() const { return software_swipes_; }
+
+private:
+    // Evaluates only the guard bits in `needed`.
+    uint8_t guards(const TouchSample& sample, uint8_t needed) const;
+    TapZone classify_zone(uint16_t x, uint16_t y) const;
+    TouchEvent make_event(TouchEventType type, uint16_t x, uint16_t y, int64_t since_us, int64_t now_us) const;
+    TouchEvent make_swipe_event(int32_t dx, int32_t dy, int64_t now_us) const;
+
+    GestureConfig config_{};
+    // Millisecond thresholds as microsecond limits, so guards() compares raw
+    // timestamps: a duration of d us is within "<= N ms" when d < (N + 1) ms.
+    int64_t double_tap_us_ = 0;
+    int64_t long_press_us_ = 0;
+    int64_t tap_limit_us_ = 0;
+    int64_t swipe_limit_us_ = 0;
+    GestureState state_ = GestureState::Idle;
+    TouchGesture contact_gesture_ = TouchGesture::None;
+
+    uint16_t start_x_ = 0;
+    uint16_t start_y_ = 0;
+    uint16_t last_x_ = 0;
+    uint16_t last_y_ = 0;
+    int64_t start_us_ = 0;
+
+    bool pending_tap_ = false;
+    TouchEvent pending_tap_event_{};
+    int64_t pending_tap_timestamp_us_ = 0;
+
+    uint32_t samples_ = 0;
+    uint32_t hardware_swipes_ = 0;
+    uint32_t software_swipes_ = 0;
+};
+
+}  // namespace dial
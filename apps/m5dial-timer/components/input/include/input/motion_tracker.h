@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+// Filtered knob motion in MT6701 raw units (1/16384 rev).
+struct EncoderMotion {
+    int32_t position;      // unwrapped angle; wraps after ~131k net revolutions
+    int32_t velocity;      // raw units per second
+    int32_t acceleration;  // raw units per second squared
+};
+
+// Fading-memory gains for theta = 0.7 (alpha = 1 - theta^3,
+// beta = 1.5 (1 - theta)^2 (1 + theta), gamma = 0.5 (1 - theta)^3), in Q16.
+struct MotionTrackerConfig {
+    uint32_t alpha_q16 = 43057;
+    uint32_t beta_q16 = 15041;
+    uint32_t gamma_q16 = 885;
+    uint32_t max_gap_us = 250000;      // longer gaps restart at the measurement
+    uint32_t max_residual_raw = 4096;  // larger jumps (glitches, resyncs) restart too
+};
+
+// Integer alpha-beta-gamma tracker. State is Q8 raw units; time steps are
+// converted to Q20 seconds, and the 1/dt reciprocal is cached because the
+// reader samples at a handful of fixed intervals.
+// Platform-free: callers pass measurement timestamps in microseconds.
+class MotionTracker {
+public:
+    explicit MotionTracker(const MotionTrackerConfig& config = {}) : config_(config) {}
+
+    void reset() { primed_ = false; }
+
+    // Feeds an unwrapped position measurement taken at `timestamp_us`.
+    EncoderMotion update(int32_t position, uint32_t timestamp_us);
+
+    EncoderMotion motion() const {
+        return EncoderMotion{
+            .position = static_cast<int32_t>(position_q8_ >> 8),
+            .velocity = static_cast<int32_t>(velocity_q8_ >> 8),
+            .acceleration = static_cast<int32_t>(acceleration_q8_ >> 8),
+        };
+    }
+    bool primed() const { return primed_; }
+
+private:
+    void restart(int32_t position, uint32_t timestamp_us);
+
+    MotionTrackerConfig config_;
+    int64_t position_q8_ = 0;
+    int64_t velocity_q8_ = 0;      // per second
+    int64_t acceleration_q8_ = 0;  // per second squared
+    uint32_t last_timestamp_us_ = 0;
+    uint32_t cached_dt_us_ = 0;
+    int64_t cached_dt_q20_ = 0;
+    int64_t cached_inv_dt_q20_ = 0;  // 1/dt in Q20 per second
+    bool primed_ = false;
+};
+
+}  // namespace dial
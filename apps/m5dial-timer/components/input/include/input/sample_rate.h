@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+enum class SampleRate : uint8_t {
+    Idle,    // knob at rest past the quiet period
+    Active,  // slow turns
+    Fast,    // motion just started, or spinning fast
+};
+
+struct SampleRateConfig {
+    uint32_t fast_interval_us = 1000;
+    uint32_t active_interval_us = 5000;
+    uint32_t idle_interval_us = 50000;
+    uint32_t quiet_period_us = 2000000;     // no motion for this long drops to Idle
+    uint32_t velocity_window_us = 20000;    // displacement is judged over this window
+    uint32_t motion_deadband_raw = 8;       // smaller changes are sensor noise
+    uint32_t fast_enter_raw_per_s = 16384;  // 1 rev/s
+    uint32_t fast_exit_raw_per_s = 8192;    // 0.5 rev/s
+};
+
+// Picks the angle sampling interval from recent motion. Any motion out of Idle
+// goes straight to Fast; from there the windowed speed moves between Fast and
+// Active with separate enter/exit thresholds, and a full quiet period without
+// motion falls back to Idle.
+class SampleRateGovernor {
+public:
+    explicit SampleRateGovernor(const SampleRateConfig& config = {}) : config_(config) {}
+
+    // `delta_raw` is the angle change since the previous sample, taken
+    // `elapsed_us` ago. Returns the interval until the next sample.
+    uint32_t update(int32_t delta_raw, uint32_t elapsed_us) {
+        window_raw_ += delta_raw;
+        window_us_ += elapsed_us;
+        const uint32_t displacement = static_cast<uint32_t>(window_raw_ < 0 ? -window_raw_ : window_raw_);
+        const bool moved = displacement > config_.motion_deadband_raw;
+
+        if (rate_ == SampleRate::Idle) {
+            if (moved) {
+                quiet_us_ = 0;
+                set_rate(SampleRate::Fast);
+            }
+            reset_window();
+            return interval_us();
+        }
+        if (window_us_ < config_.velocity_window_us) {
+            return interval_us();
+        }
+
+        const uint64_t speed = static_cast<uint64_t>(displacement) * 1000000u / window_us_;
+        quiet_us_ = moved ? 0 : quiet_us_ + window_us_;
+        reset_window();
+
+        if (quiet_us_ >= config_.quiet_period_us) {
+            set_rate(SampleRate::Idle);
+        } else if (speed >= config_.fast_enter_raw_per_s) {
+            set_rate(SampleRate::Fast);
+        } else if (speed < config_.fast_exit_raw_per_s) {
+            set_rate(SampleRate::Active);
+        }
+        return interval_us();
+    }
+
+    SampleRate rate() const { return rate_; }
+    uint32_t rate_changes() const { return rate_changes_; }
+
+    uint32_t interval_us() const {
+        switch (rate_) {
+            case SampleRate::Fast:
+                return config_.fast_interval_us;
+            case SampleRate::Active:
+                return config_.active_interval_us;
+            case SampleRate::Idle:
+            default:
+                return config_.idle_interval_us;
+        }
+    }
+
+private:
+    void set_rate(SampleRate rate) {
+        if (rate != rate_) {
+            rate_ = rate;
+            ++rate_changes_;
+        }
+    }
+
+    void reset_window() {
+        window_raw_ = 0;
+        window_us_ = 0;
+    }
+
+    SampleRateConfig config_;
+    SampleRate rate_ = SampleRate::Fast;
+    int32_t window_raw_ = 0;
+    uint32_t window_us_ = 0;
+    uint32_t quiet_us_ = 0;
+    uint32_t rate_changes_ = 0;
+};
+
+}  // namespace dial
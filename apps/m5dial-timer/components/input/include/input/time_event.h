@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+enum class TimeEventType : uint8_t {
+    Delta,
+    Commit,
+    Control,
+    Boundary,  // countdown boundary timer fired (posted by the timer engine itself)
+};
+
+enum class ControlCommand : uint8_t {
+    None,
+    ToggleRun,
+    Reset,
+};
+
+struct TimeDeltaEvent {
+    TimeEventType type = TimeEventType::Delta;
+    int32_t total_seconds;    // clamped total setpoint after applying delta
+    int32_t delta_seconds;    // signed delta applied for this event
+    uint32_t timestamp_us;    // when the encoder event occurred
+    uint32_t multiplier;      // step in units of the finest selector step (1 = slowest turn)
+    ControlCommand control = ControlCommand::None;
+};
+
+}  // namespace dial
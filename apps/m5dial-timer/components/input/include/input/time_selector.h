@@ -1,70 +1,70 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
+#include "input/ballistic_curve.h"
 #include "input/encoder_reader.h"
+#include "input/time_event.h"
 
 namespace dial {
 
-enum class TimeEventType : uint8_t {
-    Delta,
-    Commit,
-    Control,
-};
-
-enum class ControlCommand : uint8_t {
-    None,
-    ToggleRun,
-    Reset,
-};
-
 struct TimeSelectorConfig {
-    uint32_t base_step_seconds = 15 * 60;   // default 15 minutes
-    uint32_t medium_multiplier = 2;         // medium speed multiplier
-    uint32_t fast_multiplier = 4;           // fast speed multiplier (1h when base=15m)
-    float medium_threshold_tps = 20.0f;     // ticks per second threshold for medium speed
-    float fast_threshold_tps = 40.0f;       // ticks per second threshold for fast speed
+    uint32_t initial_seconds = 15 * 60;     // setpoint before the first turn
+    BallisticCurve curve = ballistic::kSmooth;  // seconds per tick vs. filtered speed
+    uint32_t ticks_per_revolution = 96;     // must match EncoderConfig
     uint32_t max_total_seconds = 6 * 3600;  // 6 hours default clamp
-    uint32_t queue_depth = 16;
     uint32_t commit_timeout_ms = 1000;      // inactivity window before commit
 };
 
-struct TimeDeltaEvent {
-    TimeEventType type = TimeEventType::Delta;
-    int32_t total_seconds;    // clamped total setpoint after applying delta
-    int32_t delta_seconds;    // signed delta applied for this event
-    uint32_t timestamp_us;    // when the encoder event occurred
-    uint32_t multiplier;      // multiplier applied (1, medium, fast)
-    ControlCommand control = ControlCommand::None;
-};
+// Receives each selector event; returns once the event is queued. Called from
+// the encoder reader task (deltas) and the esp_timer task (commits).
+using TimeEventSink = void (*)(const TimeDeltaEvent& event);
 
+// Turns encoder ticks into setpoint deltas and a commit after inactivity.
+// Has no task of its own: the encoder reader calls handle_sample() inline, so
+// a tick reaches the sink without another queue hop, and a one-shot esp_timer
+// posts the commit commit_timeout_ms after the last tick. Nothing wakes while
+// the knob is idle.
 class TimeSelector {
 public:
     TimeSelector() = default;
     esp_err_t init(const TimeSelectorConfig& config);
-    void start();
+    void set_sink(TimeEventSink sink) { sink_ = sink; }
+
+    // Encoder reader task only.
+    void handle_sample(const EncoderSample& sample);
 
-    QueueHandle_t event_queue() const { return event_queue_; }
+    // Any task.
     void set_input_locked(bool locked);
-    bool input_locked() const { return input_locked_; }
+    bool input_locked() const { return input_locked_.load(std::memory_order_relaxed); }
+
+    uint32_t commits() const { return commits_; }
+    uint32_t commit_rearms() const { return commit_rearms_; }  // timer fired before the deadline
+    uint32_t max_commit_late_us() const { return max_commit_late_us_; }
+    void log_stats();
 
 private:
-    static void task_entry(void* arg);
-    void run();
-    void process_sample(const EncoderSample& sample);
+    static void commit_timer_callback(void* arg);
+
+    void on_commit_timer();
+    void arm_commit(int64_t now_us);
+    void emit(const TimeDeltaEvent& event);
 
     TimeSelectorConfig config_{};
-    QueueHandle_t event_queue_ = nullptr;
-    TaskHandle_t task_handle_ = nullptr;
-    int32_t accumulated_seconds_ = 15 * 60;  // start with default 15 min
-    uint32_t last_timestamp_us_ = 0;
-    uint64_t last_activity_us_ = 0;
-    bool commit_sent_ = false;
-    bool input_locked_ = false;
+    TimeEventSink sink_ = nullptr;
+    std::atomic<int32_t> accumulated_seconds_{15 * 60};  // written by the reader, read by the commit timer
+    BallisticTable table_{};
+    esp_timer_handle_t commit_timer_ = nullptr;
+    std::atomic<int64_t> last_activity_us_{0};
+    std::atomic<bool> commit_armed_{false};
+    std::atomic<bool> input_locked_{false};
+    uint32_t commits_ = 0;
+    uint32_t commit_rearms_ = 0;
+    uint32_t max_commit_late_us_ = 0;
 };
 
 extern TimeSelector g_time_selector;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+enum class TouchEventType : uint8_t {
+    Tap,
+    DoubleTap,
+    LongPress,
+    SwipeUp,
+    SwipeDown,
+    SwipeLeft,
+    SwipeRight,
+    TwoFingerTap,
+};
+
+enum class TapZone : uint8_t {
+    Center,
+    TopEdge,
+    BottomEdge,
+    LeftEdge,
+    RightEdge,
+};
+
+struct TouchEvent {
+    TouchEventType type = TouchEventType::Tap;
+    TapZone zone = TapZone::Center;
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint32_t duration_ms = 0;
+};
+
+}  // namespace dial
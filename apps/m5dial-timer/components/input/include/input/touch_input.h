@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "freertos/FreeRTOS.h"
@@ -7,47 +8,62 @@
 #include "freertos/task.h"
 #include "esp_err.h"
 
-namespace dial {
-
-enum class TouchEventType : uint8_t {
-    Tap,
-    DoubleTap,
-    LongPress,
-    SwipeUp,
-    SwipeDown,
-    SwipeLeft,
-    SwipeRight,
-    TwoFingerTap,
-};
+#include "board/dial_board.h"
+#include "input/gesture_recognizer.h"
+#include "input/touch_event.h"
+#include "input/touch_trace.h"
 
-enum class TapZone : uint8_t {
-    Center,
-    TopEdge,
-    BottomEdge,
-    LeftEdge,
-    RightEdge,
-};
+namespace dial {
 
-struct TouchEvent {
-    TouchEventType type = TouchEventType::Tap;
-    TapZone zone = TapZone::Center;
-    uint16_t x = 0;
-    uint16_t y = 0;
-    uint32_t duration_ms = 0;
+enum class GestureSource : uint8_t {
+    Software,  // 5-byte point reads every poll_interval_ms, classified here
+    Hardware,  // FT3267 gesture ID plus both points in one burst
 };
 
 struct TouchConfig {
+    // Hardware mode takes swipe direction from the controller's gesture
+    // engine, so contacts are polled at hardware_poll_interval_ms; taps, long
+    // presses and two-finger taps are still timed by the recognizer, and swipes
+    // the controller does not report are classified from the contact's end
+    // points. After kHardwareMissesBeforeFallback such misses with no hardware
+    // gesture ever seen, the task drops back to Software.
+    GestureSource gesture_source = GestureSource::Hardware;
+    uint32_t hardware_poll_interval_ms = 30;
     uint32_t poll_interval_ms = 10;
-    uint32_t tap_max_duration_ms = 400;
-    uint32_t double_tap_max_interval_ms = 350;
-    uint32_t long_press_min_duration_ms = 600;
-    uint16_t tap_max_movement = 40;  // pixels in controller space
-    uint16_t swipe_min_distance = 60;
-    uint32_t swipe_max_duration_ms = 700;
-    uint8_t edge_zone_percent = 20;
-    uint16_t screen_width = 240;
-    uint16_t screen_height = 240;
+    GestureConfig gesture{};
     uint32_t queue_depth = 8;
+    bool use_interrupt = true;  // sleep on the FT3267 INT line when idle; polls if absent
+    bool record_trace = false;  // keep samples and events for dump_trace()
+};
+
+// Touch-down detection latency buckets (INT edge to first read seeing the
+// contact), upper bounds in microseconds; the last bucket is open-ended.
+constexpr uint32_t kTouchLatencyBucketUs[] = {1000, 2000, 5000, 10000, 20000};
+constexpr size_t kTouchLatencyBuckets = sizeof(kTouchLatencyBucketUs) / sizeof(kTouchLatencyBucketUs[0]) + 1;
+
+// Tap latency buckets (touch-down INT edge to the Tap reaching emit()). A tap
+// is held for the double-tap window after lift-off, so this includes the
+// finger's contact time plus double_tap_max_interval_ms.
+constexpr uint32_t kTapLatencyBucketUs[] = {400000, 500000, 600000, 700000, 800000};
+constexpr size_t kTapLatencyBuckets = sizeof(kTapLatencyBucketUs) / sizeof(kTapLatencyBucketUs[0]) + 1;
+
+constexpr uint32_t kHardwareMissesBeforeFallback = 3;
+
+struct TouchStats {
+    bool interrupt_mode = false;
+    GestureSource gesture_source = GestureSource::Software;
+    uint32_t i2c_reads = 0;
+    uint32_t i2c_bytes = 0;
+    uint32_t active_us = 0;  // task time outside waits, I2C transfers included
+    uint32_t hardware_gestures = 0;
+    uint32_t software_swipes = 0;  // swipes classified from end points
+    uint32_t trace_dropped = 0;
+    uint32_t interrupts = 0;
+    uint32_t events = 0;
+    uint32_t latency_buckets[kTouchLatencyBuckets] = {};
+    uint32_t max_latency_us = 0;
+    uint32_t tap_latency_buckets[kTapLatencyBuckets] = {};
+    uint32_t max_tap_latency_us = 0;
 };
 
 class TouchInput {
@@ -56,37 +72,49 @@ public:
 
     esp_err_t init(const TouchConfig& config = {});
     QueueHandle_t queue() const { return queue_; }
+    TouchStats stats() const;
+    // Logs I2C reads/s since the previous call, I2C bytes and task time per
+    // gesture, and the touch-down and tap latency histograms.
+    void log_stats();
+    // Prints up to max_records recorded trace lines to the console; no-op
+    // unless TouchConfig::record_trace. Call from a task other than the touch
+    // task.
+    size_t dump_trace(size_t max_records);
 
 private:
     static void task_entry(void* arg);
+    void enable_wake();
     void run();
-
-    TouchEvent make_tap_event(uint16_t x, uint16_t y, uint32_t duration_ms) const;
-    TapZone classify_zone(uint16_t x, uint16_t y) const;
+    TouchSample read_sample(int64_t now_us);
+    void check_hardware_fallback(uint32_t hardware_before, uint32_t software_before);
+    void wait_for_next_sample();
+    void emit(const TouchEvent& event);
+    void record_detect_latency(uint32_t latency_us);
+    void record_tap_latency(uint32_t latency_us);
 
     TouchConfig config_{};
     QueueHandle_t queue_ = nullptr;
     TaskHandle_t task_handle_ = nullptr;
     bool initialized_ = false;
 
-    bool last_active_ = false;
-    bool multi_active_ = false;
-    bool long_press_reported_ = false;
-    uint16_t start_x_ = 0;
-    uint16_t start_y_ = 0;
-    uint16_t last_x_ = 0;
-    uint16_t last_y_ = 0;
-    uint8_t last_touch_count_ = 0;
-    uint64_t start_us_ = 0;
-
-    uint16_t multi_start_x_ = 0;
-    uint16_t multi_start_y_ = 0;
-    uint64_t multi_start_us_ = 0;
-
-    bool pending_tap_ = false;
-    TouchEvent pending_tap_event_{};
-    uint64_t pending_tap_deadline_us_ = 0;
-    uint64_t pending_tap_timestamp_us_ = 0;
+    GestureRecognizer recognizer_{};
+    TouchTraceRecorder trace_{};
+
+    bool interrupt_mode_ = false;
+    GestureSource gesture_source_ = GestureSource::Software;
+    uint32_t hardware_misses_ = 0;
+    uint32_t active_us_ = 0;
+    uint32_t events_ = 0;
+    uint32_t latency_buckets_[kTouchLatencyBuckets] = {};
+    uint32_t max_latency_us_ = 0;
+    // INT edge of the current contact and of the tap the recognizer is
+    // holding; 0 when there was no edge.
+    uint32_t contact_edge_us_ = 0;
+    uint32_t pending_tap_edge_us_ = 0;
+    uint32_t tap_latency_buckets_[kTapLatencyBuckets] = {};
+    uint32_t max_tap_latency_us_ = 0;
+    uint32_t last_logged_reads_ = 0;
+    int64_t last_logged_us_ = 0;
 };
 
 extern TouchInput g_touch_input;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+
+#include "input/gesture_recognizer.h"
+#include "ringbuf/spsc_ring.h"
+
+namespace dial {
+
+// One recorded sample, or one event the recognizer reported for it.
+struct TouchTraceRecord {
+    int64_t timestamp_us = 0;
+    int64_t contact_start_us = -1;
+    TouchReport report{};
+    TouchEvent event{};
+    bool is_event = false;
+};
+
+constexpr size_t kTouchTraceDepth = 1024;
+
+// Records the touch task's samples and events for replay on the host
+// (tools/host-bench gesture_replay). The touch task pushes; dump() drains to
+// the console from another task, one CSV line per record:
+//   trace,S,timestamp_us,contact_start_us,touch_count,gesture,x0,y0,x1,y1
+//   trace,E,timestamp_us,type,zone,x,y,duration_ms
+// Enum fields are the integer values of TouchGesture, TouchEventType and
+// TapZone. Records that find the ring full are dropped and counted.
+class TouchTraceRecorder {
+public:
+    TouchTraceRecorder() = default;
+
+    // Allocates the ring in PSRAM, or internal RAM when there is none.
+    esp_err_t init();
+    bool enabled() const { return ring_ != nullptr; }
+
+    void record(const TouchSample& sample);
+    void record(const TouchEvent& event, int64_t timestamp_us);
+    // Prints up to max_records lines; returns how many.
+    size_t dump(size_t max_records);
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    using Ring = SpscRing<TouchTraceRecord, kTouchTraceDepth>;
+
+    void push(const TouchTraceRecord& record);
+
+    Ring* ring_ = nullptr;
+    std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace dial
@@ -0,0 +1,67 @@
+#include "input/angle_predictor.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "input/encoder_ticks.h"
+
+namespace dial {
+
+namespace {
+uint16_t wrap_angle(int32_t angle) {
+    return static_cast<uint16_t>(static_cast<uint32_t>(angle) & (kMt6701AngleResolution - 1));
+}
+}  // namespace
+
+int32_t AnglePredictor::advance(uint32_t dt_us) const {
+    const int64_t step = (static_cast<int64_t>(velocity_) * std::min(dt_us, config_.max_horizon_us)) / 1000000;
+    const int64_t limit = config_.max_advance_raw;
+    return static_cast<int32_t>(std::clamp(step, -limit, limit));
+}
+
+void AnglePredictor::observe(const AngleObservation& observation) {
+    if (!observation.valid) {
+        has_observation_ = false;
+        return;
+    }
+    int32_t velocity = observation.velocity;
+    if (has_observation_) {
+        const uint32_t gap_us = observation.timestamp_us - observation_.timestamp_us;
+        // Idle-rate gaps would only dilute the figures with zero-velocity holds.
+        if (gap_us > 0 && gap_us <= config_.max_horizon_us) {
+            const int32_t moved = mt6701_angle_delta(observation_.raw_angle, observation.raw_angle);
+            if (config_.difference_velocity) {
+                velocity = static_cast<int32_t>(static_cast<int64_t>(moved) * 1000000 / gap_us);
+            }
+            const uint16_t predicted = wrap_angle(observation_.raw_angle + advance(gap_us));
+            const uint32_t error = static_cast<uint32_t>(std::abs(mt6701_angle_delta(predicted, observation.raw_angle)));
+            const uint32_t hold_error = static_cast<uint32_t>(std::abs(moved));
+            ++stats_.scored;
+            stats_.error_total_raw += error;
+            stats_.error_max_raw = std::max(stats_.error_max_raw, error);
+            stats_.hold_error_total_raw += hold_error;
+            stats_.hold_error_max_raw = std::max(stats_.hold_error_max_raw, hold_error);
+        }
+    }
+    observation_ = observation;
+    velocity_ = velocity;
+    has_observation_ = true;
+}
+
+uint16_t AnglePredictor::predict(uint32_t now_us) {
+    // A sample stamped after `now_us` (taken between the caller's clock read
+    // and the load) wraps to a huge age; treat it as current.
+    uint32_t age_us = now_us - observation_.timestamp_us;
+    if (age_us > 0x80000000u) {
+        age_us = 0;
+    }
+    ++stats_.predictions;
+    stats_.age_total_us += age_us;
+    stats_.age_max_us = std::max(stats_.age_max_us, age_us);
+    if (age_us > config_.max_horizon_us) {
+        ++stats_.horizon_clamps;
+    }
+    return wrap_angle(observation_.raw_angle + advance(age_us));
+}
+
+}  // namespace dial
@@ -0,0 +1,64 @@
+#include "input/ballistic_curve.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dial {
+
+namespace {
+
+// Nearest allowed step on a log scale, so 450 s snaps to 600 rather than 300.
+uint16_t snap_step(float seconds) {
+    uint16_t best = kBallisticSteps.front();
+    float best_error = INFINITY;
+    for (uint16_t step : kBallisticSteps) {
+        const float error = std::fabs(std::log(seconds / static_cast<float>(step)));
+        if (error < best_error) {
+            best_error = error;
+            best = step;
+        }
+    }
+    return best;
+}
+
+}  // namespace
+
+void BallisticTable::build(const BallisticCurve& curve, uint32_t ticks_per_revolution) {
+    ticks_per_revolution_ = std::max<uint32_t>(1, ticks_per_revolution);
+    align_ = curve.align;
+    const size_t count = std::clamp<size_t>(curve.knot_count, 1, kMaxBallisticKnots);
+
+    size_t knot = 0;
+    for (uint32_t tps = 0; tps <= kMaxTicksPerSecond; ++tps) {
+        while (knot + 1 < count && tps >= curve.knots[knot + 1].ticks_per_second) {
+            ++knot;
+        }
+        const BallisticKnot& lo = curve.knots[knot];
+        float seconds = lo.seconds_per_tick;
+        if (curve.interpolate && knot + 1 < count && tps > lo.ticks_per_second) {
+            const BallisticKnot& hi = curve.knots[knot + 1];
+            const float t = static_cast<float>(tps - lo.ticks_per_second) /
+                            static_cast<float>(hi.ticks_per_second - lo.ticks_per_second);
+            seconds += t * (static_cast<float>(hi.seconds_per_tick) - seconds);
+        }
+        // Curves without alignment keep their exact steps (the legacy tiers).
+        lut_[tps] = curve.align ? snap_step(seconds) : static_cast<uint16_t>(seconds);
+    }
+}
+
+int32_t BallisticTable::advance(int32_t total, int32_t delta_ticks, uint32_t step_seconds) const {
+    const int32_t step = static_cast<int32_t>(std::max<uint32_t>(1, step_seconds));
+    if (!align_) {
+        return total + delta_ticks * step;
+    }
+    // Floor/ceil to the grid first, so the first tick off an odd value only
+    // goes as far as the next grid line.
+    if (delta_ticks > 0) {
+        const int32_t floor_index = total >= 0 ? total / step : -((-total + step - 1) / step);
+        return (floor_index + delta_ticks) * step;
+    }
+    const int32_t ceil_index = total >= 0 ? (total + step - 1) / step : -(-total / step);
+    return (ceil_index + delta_ticks) * step;
+}
+
+}  // namespace dial
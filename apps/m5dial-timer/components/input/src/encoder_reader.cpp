@@ -1,19 +1,19 @@
 #include "input/encoder_reader.h"
 
 #include <algorithm>
-#include <cmath>
 #include <atomic>
 
+#include <esp_attr.h>
 #include <esp_check.h>
 #include <esp_log.h>
 #include <esp_timer.h>
 
+#include "input/time_selector.h"
+
 namespace dial {
 
 namespace {
 constexpr const char* TAG = "EncoderReader";
-constexpr uint16_t kAngleResolution = 16384;  // 14-bit full scale
-constexpr uint16_t kHalfResolution = kAngleResolution / 2;
 }  // namespace
 
 EncoderReader g_encoder_reader;
@@ -33,14 +33,6 @@ esp_err_t EncoderReader::init(const EncoderConfig& config) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (sample_queue_ == nullptr) {
-        sample_queue_ = xQueueCreate(config_.sample_queue_depth, sizeof(EncoderSample));
-        if (sample_queue_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to create encoder queue");
-            return ESP_ERR_NO_MEM;
-        }
-    }
-
     i2c_config_t i2c_cfg = {};
     i2c_cfg.mode = I2C_MODE_MASTER;
     i2c_cfg.sda_io_num = static_cast<gpio_num_t>(config_.sda_gpio);
@@ -58,8 +50,36 @@ esp_err_t EncoderReader::init(const EncoderConfig& config) {
     i2c_ready_ = true;
 
     has_last_angle_ = false;
-    residual_ticks_ = 0.0f;
     last_angle_raw_ = 0;
+    angle_ticks_.set_ticks_per_revolution(config_.ticks_per_revolution);
+    abz_resync_ = AbzResync(config_.ticks_per_revolution);
+    tracker_ = MotionTracker(config_.motion);
+    unwrapped_angle_ = 0;
+    raw_per_tick_q8_ = (static_cast<int32_t>(kMt6701AngleResolution) << 8) /
+                       static_cast<int32_t>(config_.ticks_per_revolution);
+
+    active_backend_ = EncoderBackend::I2cPoll;
+    if (config_.backend == EncoderBackend::PcntAbz) {
+        const esp_err_t pcnt_rc = init_pcnt();
+        if (pcnt_rc == ESP_OK) {
+            active_backend_ = EncoderBackend::PcntAbz;
+        } else {
+            ESP_LOGW(TAG, "ABZ counter unavailable (%s), polling over I2C", esp_err_to_name(pcnt_rc));
+        }
+    }
+
+    // Sampling intervals go down to 1 ms, below the FreeRTOS tick, so the
+    // task sleeps on a notification from a one-shot esp_timer.
+    if (sample_timer_ == nullptr) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &EncoderReader::on_sample_timer,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "mt6701_sample",
+            .skip_unhandled_events = true,
+        };
+        ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &sample_timer_), TAG, "esp_timer_create failed");
+    }
 
     if (task_handle_ == nullptr) {
         BaseType_t res = xTaskCreatePinnedToCore(
@@ -77,16 +97,184 @@ esp_err_t EncoderReader::init(const EncoderConfig& config) {
         }
     }
 
-    ESP_LOGI(TAG, "MT6701 reader initialised (addr=0x%02X, sda=%d, scl=%d)",
-             config_.i2c_address, config_.sda_gpio, config_.scl_gpio);
+    ESP_LOGI(TAG, "MT6701 reader initialised (addr=0x%02X, sda=%d, scl=%d, %s)",
+             config_.i2c_address, config_.sda_gpio, config_.scl_gpio,
+             active_backend_ == EncoderBackend::PcntAbz ? "pcnt abz" : "i2c poll");
+    return ESP_OK;
+}
+
+esp_err_t EncoderReader::init_pcnt() {
+    if (config_.abz_a_gpio < 0 || config_.abz_b_gpio < 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    const int32_t counts_per_tick =
+        abz_counts_per_tick(config_.abz_pulses_per_revolution, config_.ticks_per_revolution);
+    if (counts_per_tick <= 0 || counts_per_tick > INT16_MAX) {
+        ESP_LOGE(TAG, "ABZ resolution %lu PPR does not divide into %lu ticks",
+                 static_cast<unsigned long>(config_.abz_pulses_per_revolution),
+                 static_cast<unsigned long>(config_.ticks_per_revolution));
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pcnt_unit_ != nullptr) {
+        return ESP_OK;
+    }
+
+    // Hitting either limit clears the counter, so each limit is one tick.
+    pcnt_unit_config_t unit_cfg = {};
+    unit_cfg.low_limit = -counts_per_tick;
+    unit_cfg.high_limit = counts_per_tick;
+    ESP_RETURN_ON_ERROR(pcnt_new_unit(&unit_cfg, &pcnt_unit_), TAG, "pcnt_new_unit failed");
+
+    pcnt_glitch_filter_config_t filter_cfg = {};
+    filter_cfg.max_glitch_ns = config_.abz_glitch_ns;
+    ESP_RETURN_ON_ERROR(pcnt_unit_set_glitch_filter(pcnt_unit_, &filter_cfg), TAG, "glitch filter failed");
+
+    // 4x quadrature decode: each channel counts both edges of one line,
+    // with the other line selecting the direction.
+    pcnt_chan_config_t chan_a_cfg = {};
+    chan_a_cfg.edge_gpio_num = config_.abz_a_gpio;
+    chan_a_cfg.level_gpio_num = config_.abz_b_gpio;
+    pcnt_channel_handle_t chan_a = nullptr;
+    ESP_RETURN_ON_ERROR(pcnt_new_channel(pcnt_unit_, &chan_a_cfg, &chan_a), TAG, "pcnt channel A failed");
+
+    pcnt_chan_config_t chan_b_cfg = {};
+    chan_b_cfg.edge_gpio_num = config_.abz_b_gpio;
+    chan_b_cfg.level_gpio_num = config_.abz_a_gpio;
+    pcnt_channel_handle_t chan_b = nullptr;
+    ESP_RETURN_ON_ERROR(pcnt_new_channel(pcnt_unit_, &chan_b_cfg, &chan_b), TAG, "pcnt channel B failed");
+
+    ESP_RETURN_ON_ERROR(pcnt_channel_set_edge_action(chan_a, PCNT_CHANNEL_EDGE_ACTION_DECREASE,
+                                                     PCNT_CHANNEL_EDGE_ACTION_INCREASE),
+                        TAG, "channel A edge action failed");
+    ESP_RETURN_ON_ERROR(pcnt_channel_set_level_action(chan_a, PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+                                                      PCNT_CHANNEL_LEVEL_ACTION_INVERSE),
+                        TAG, "channel A level action failed");
+    ESP_RETURN_ON_ERROR(pcnt_channel_set_edge_action(chan_b, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                                     PCNT_CHANNEL_EDGE_ACTION_DECREASE),
+                        TAG, "channel B edge action failed");
+    ESP_RETURN_ON_ERROR(pcnt_channel_set_level_action(chan_b, PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+                                                      PCNT_CHANNEL_LEVEL_ACTION_INVERSE),
+                        TAG, "channel B level action failed");
+
+    ESP_RETURN_ON_ERROR(pcnt_unit_add_watch_point(pcnt_unit_, counts_per_tick), TAG, "watch point failed");
+    ESP_RETURN_ON_ERROR(pcnt_unit_add_watch_point(pcnt_unit_, -counts_per_tick), TAG, "watch point failed");
+
+    pcnt_event_callbacks_t callbacks = {};
+    callbacks.on_reach = &EncoderReader::on_pcnt_reach;
+    ESP_RETURN_ON_ERROR(pcnt_unit_register_event_callbacks(pcnt_unit_, &callbacks, this), TAG,
+                        "pcnt callbacks failed");
+
+    ESP_RETURN_ON_ERROR(pcnt_unit_enable(pcnt_unit_), TAG, "pcnt_unit_enable failed");
+    ESP_RETURN_ON_ERROR(pcnt_unit_clear_count(pcnt_unit_), TAG, "pcnt_unit_clear_count failed");
+    ESP_RETURN_ON_ERROR(pcnt_unit_start(pcnt_unit_), TAG, "pcnt_unit_start failed");
+
+    ESP_LOGI(TAG, "ABZ counter on A=%d B=%d (%ld counts/tick, glitch %lu ns)", config_.abz_a_gpio,
+             config_.abz_b_gpio, static_cast<long>(counts_per_tick),
+             static_cast<unsigned long>(config_.abz_glitch_ns));
     return ESP_OK;
 }
 
+void EncoderReader::on_sample_timer(void* arg) {
+    auto* self = static_cast<EncoderReader*>(arg);
+    xTaskNotifyGive(self->task_handle_);
+}
+
 void EncoderReader::task_entry(void* arg) {
     auto* self = static_cast<EncoderReader*>(arg);
-    self->run();
+    if (self->active_backend_ == EncoderBackend::PcntAbz) {
+        self->run_abz();
+    } else {
+        self->run();
+    }
+}
+
+bool IRAM_ATTR EncoderReader::on_pcnt_reach(pcnt_unit_handle_t, const pcnt_watch_event_data_t* edata,
+                                            void* user_ctx) {
+    auto* self = static_cast<EncoderReader*>(user_ctx);
+    const int32_t delta = abz_watch_delta(edata->watch_point_value);
+    if (delta == 0) {
+        return false;
+    }
+    self->pcnt_events_.fetch_add(1, std::memory_order_relaxed);
+    self->pcnt_edge_us_.store(static_cast<uint32_t>(esp_timer_get_time()), std::memory_order_relaxed);
+    self->pcnt_position_.fetch_add(delta, std::memory_order_release);
+
+    // The reader task turns the new position into a selector event; a burst
+    // of ticks folds into one wakeup.
+    if (self->task_handle_ == nullptr) {
+        return false;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->task_handle_, &woken);
+    return woken == pdTRUE;
+}
+
+EncoderMotion EncoderReader::track(int32_t position, uint32_t timestamp_us) {
+    portENTER_CRITICAL_SAFE(&motion_lock_);
+    const EncoderMotion motion = tracker_.update(position, timestamp_us);
+    latest_motion_ = motion;
+    portEXIT_CRITICAL_SAFE(&motion_lock_);
+    return motion;
+}
+
+bool EncoderReader::latest_motion(EncoderMotion* out) const {
+    if (out == nullptr) {
+        return false;
+    }
+    portENTER_CRITICAL_SAFE(&motion_lock_);
+    const bool primed = tracker_.primed();
+    *out = latest_motion_;
+    portEXIT_CRITICAL_SAFE(&motion_lock_);
+    return primed;
 }
 
+void EncoderReader::publish(int32_t delta_ticks, const EncoderMotion& motion, uint32_t timestamp_us) {
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    g_time_selector.handle_sample(EncoderSample{
+        .delta_ticks = delta_ticks,
+        .timestamp_us = timestamp_us,
+        .motion = motion,
+    });
+}
+
+EncoderStats EncoderReader::stats() const {
+    return EncoderStats{
+        .samples = samples_.load(std::memory_order_relaxed),
+        .pcnt_events = pcnt_events_.load(std::memory_order_relaxed),
+        .i2c_reads = i2c_reads_,
+        .i2c_transactions = i2c_transactions_,
+        .i2c_errors = i2c_errors_,
+        .resync_corrections = resync_corrections_,
+        .sample_rate = sample_rate_,
+        .sample_interval_us = sample_interval_us_,
+        .rate_changes = rate_changes_,
+    };
+}
+
+
+void EncoderReader::publish_angle(uint16_t raw, uint32_t timestamp_us, int32_t velocity) {
+    last_angle_raw_.store(raw, std::memory_order_relaxed);
+    has_last_angle_.store(true, std::memory_order_relaxed);
+    observation_.store(AngleObservation{
+        .timestamp_us = timestamp_us,
+        .velocity = velocity,
+        .raw_angle = raw,
+        .valid = true,
+    });
+}
+
+void EncoderReader::invalidate_angle() {
+    has_last_angle_.store(false, std::memory_order_relaxed);
+    observation_.store(AngleObservation{});
+}
+
+bool EncoderReader::latest_observation(AngleObservation* out, uint32_t* generation) const {
+    if (out == nullptr || observation_.generation() == 0) {
+        return false;
+    }
+    *out = observation_.load(generation);
+    return out->valid;
+}
 
 bool EncoderReader::latest_raw_angle(uint16_t* out) const {
     if (!out) {
@@ -99,54 +287,138 @@ bool EncoderReader::latest_raw_angle(uint16_t* out) const {
     return true;
 }
 
+void EncoderReader::log_stats() {
+    const EncoderStats s = stats();
+    const int64_t now_us = esp_timer_get_time();
+    const double elapsed_s = last_logged_us_ > 0 ? static_cast<double>(now_us - last_logged_us_) / 1e6 : 0.0;
+    const double reads_per_s = elapsed_s > 0.0 ? static_cast<double>(s.i2c_reads - last_logged_reads_) / elapsed_s : 0.0;
+    last_logged_reads_ = s.i2c_reads;
+    last_logged_us_ = now_us;
+    static constexpr const char* kRateNames[] = {"idle", "active", "fast"};
+
+    ESP_LOGI(TAG, "%s: %.1f I2C reads/s (%lu transactions, %lu errors), %s %lu us (%lu changes), "
+                  "%lu pcnt events, %lu samples, %lu resyncs",
+             active_backend_ == EncoderBackend::PcntAbz ? "pcnt" : "poll", reads_per_s,
+             static_cast<unsigned long>(s.i2c_transactions), static_cast<unsigned long>(s.i2c_errors),
+             kRateNames[static_cast<uint8_t>(s.sample_rate)], static_cast<unsigned long>(s.sample_interval_us),
+             static_cast<unsigned long>(s.rate_changes), static_cast<unsigned long>(s.pcnt_events),
+             static_cast<unsigned long>(s.samples),
+             static_cast<unsigned long>(s.resync_corrections));
+}
+
+// Sleeps until wake_us. The PCNT ISR can also wake the task early, with the
+// timer still armed.
+void EncoderReader::wait_until(int64_t wake_us) {
+    constexpr int64_t kMinGapUs = 100;
+    const uint64_t delay_us = static_cast<uint64_t>(std::max(wake_us - esp_timer_get_time(), kMinGapUs));
+    if (esp_timer_restart(sample_timer_, delay_us) != ESP_OK) {
+        esp_timer_start_once(sample_timer_, delay_us);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
 void EncoderReader::run() {
-    const TickType_t delay_ticks = pdMS_TO_TICKS(std::max<uint32_t>(1, config_.poll_interval_ms));
-    const float ticks_per_unit = static_cast<float>(config_.ticks_per_revolution) /
-                                 static_cast<float>(kAngleResolution);
+    const uint32_t fixed_interval_us = std::max<uint32_t>(1, config_.poll_interval_ms) * 1000;
+    SampleRateGovernor governor(config_.sampling);
+    uint32_t interval_us = config_.adaptive_sampling ? governor.interval_us() : fixed_interval_us;
+    sample_rate_ = config_.adaptive_sampling ? governor.rate() : SampleRate::Active;
+    sample_interval_us_ = interval_us;
+    int64_t last_sample_us = esp_timer_get_time();
 
     while (true) {
+        const int64_t started_us = esp_timer_get_time();
         uint16_t raw = 0;
         if (read_raw_angle(&raw) == ESP_OK) {
-            if (has_last_angle_.load(std::memory_order_relaxed)) {
-                int32_t delta = static_cast<int32_t>(raw) - static_cast<int32_t>(last_angle_raw_.load(std::memory_order_relaxed));
-                if (delta > kHalfResolution) {
-                    delta -= kAngleResolution;
-                } else if (delta < -static_cast<int32_t>(kHalfResolution)) {
-                    delta += kAngleResolution;
-                }
-
-                residual_ticks_ += static_cast<float>(delta) * ticks_per_unit;
-                int32_t delta_ticks = static_cast<int32_t>(residual_ticks_);
-                if (delta_ticks != 0) {
-                    residual_ticks_ -= static_cast<float>(delta_ticks);
-                    EncoderSample sample{
-                        .delta_ticks = delta_ticks,
-                        .timestamp_us = static_cast<uint32_t>(esp_timer_get_time()),
-                    };
-                    xQueueSend(sample_queue_, &sample, 0);
-                }
-            } else {
-                has_last_angle_.store(true, std::memory_order_relaxed);
+            // The angle is latched somewhere in the two-transaction read.
+            const int64_t sampled_us = started_us + (esp_timer_get_time() - started_us) / 2;
+            const int32_t delta_raw = has_last_angle_.load(std::memory_order_relaxed)
+                                          ? mt6701_angle_delta(last_angle_raw_.load(std::memory_order_relaxed), raw)
+                                          : 0;
+            unwrapped_angle_ += delta_raw;
+            const EncoderMotion motion = track(unwrapped_angle_, static_cast<uint32_t>(sampled_us));
+            const int32_t delta_ticks = angle_ticks_.update(raw);
+            if (delta_ticks != 0) {
+                publish(delta_ticks, motion, static_cast<uint32_t>(sampled_us));
             }
-            last_angle_raw_.store(raw, std::memory_order_relaxed);
+            if (config_.adaptive_sampling) {
+                interval_us = governor.update(delta_raw, static_cast<uint32_t>(started_us - last_sample_us));
+                sample_rate_ = governor.rate();
+                rate_changes_ = governor.rate_changes();
+                sample_interval_us_ = interval_us;
+            }
+            last_sample_us = started_us;
+            publish_angle(raw, static_cast<uint32_t>(sampled_us), motion.velocity);
         } else {
-            has_last_angle_.store(false, std::memory_order_relaxed);
-            residual_ticks_ = 0.0f;
+            invalidate_angle();
+            angle_ticks_.reset();
+            portENTER_CRITICAL(&motion_lock_);
+            tracker_.reset();
+            portEXIT_CRITICAL(&motion_lock_);
         }
 
-        vTaskDelay(delay_ticks);
+        wait_until(started_us + interval_us);
+    }
+}
+
+// ABZ mode: ticks come from the PCNT ISR, which only bumps the position and
+// notifies. This loop publishes position changes, keeps the absolute angle
+// fresh and folds in whatever the counter missed.
+void EncoderReader::run_abz() {
+    const int64_t resync_interval_us = static_cast<int64_t>(std::max<uint32_t>(1, config_.resync_interval_ms)) * 1000;
+    sample_rate_ = SampleRate::Idle;
+    sample_interval_us_ = static_cast<uint32_t>(resync_interval_us);
+    int64_t next_resync_us = esp_timer_get_time();
+    int32_t published = pcnt_position_.load(std::memory_order_acquire);
+
+    while (true) {
+        int64_t now_us = esp_timer_get_time();
+        if (now_us >= next_resync_us) {
+            resync_abz();
+            next_resync_us = now_us + resync_interval_us;
+        }
+
+        const int32_t position = pcnt_position_.load(std::memory_order_acquire);
+        if (position != published) {
+            const uint32_t edge_us = pcnt_edge_us_.load(std::memory_order_relaxed);
+            const EncoderMotion motion =
+                track(static_cast<int32_t>((static_cast<int64_t>(position) * raw_per_tick_q8_) >> 8), edge_us);
+            publish(position - published, motion, edge_us);
+            published = position;
+        }
+
+        wait_until(next_resync_us);
+    }
+}
+
+void EncoderReader::resync_abz() {
+    uint16_t raw = 0;
+    const int64_t started_us = esp_timer_get_time();
+    if (read_raw_angle(&raw) != ESP_OK) {
+        invalidate_angle();
+        return;
+    }
+    const int64_t sampled_us = started_us + (esp_timer_get_time() - started_us) / 2;
+    const int32_t correction = abz_resync_.correction(raw, pcnt_position_.load(std::memory_order_acquire));
+    if (correction != 0) {
+        pcnt_position_.fetch_add(correction, std::memory_order_relaxed);
+        ++resync_corrections_;
+        ESP_LOGW(TAG, "ABZ count off by %ld ticks, resynced from I2C", static_cast<long>(correction));
     }
+    EncoderMotion motion{};
+    publish_angle(raw, static_cast<uint32_t>(sampled_us), latest_motion(&motion) ? motion.velocity : 0);
 }
 
 esp_err_t EncoderReader::read_raw_angle(uint16_t* out_raw) {
     if (!i2c_ready_ || out_raw == nullptr) {
         return ESP_ERR_INVALID_STATE;
     }
+    ++i2c_reads_;
 
     const TickType_t timeout = pdMS_TO_TICKS(std::max<uint32_t>(1, config_.i2c_timeout_ms));
 
     uint8_t reg = 0x03;
     uint8_t msb = 0;
+    ++i2c_transactions_;
     esp_err_t err = i2c_master_write_read_device(
         config_.i2c_port,
         config_.i2c_address,
@@ -156,12 +428,14 @@ esp_err_t EncoderReader::read_raw_angle(uint16_t* out_raw) {
         1,
         timeout);
     if (err != ESP_OK) {
+        ++i2c_errors_;
         ESP_LOGW(TAG, "Failed to read MT6701 MSB: %s", esp_err_to_name(err));
         return err;
     }
 
     reg = 0x04;
     uint8_t lsb = 0;
+    ++i2c_transactions_;
     err = i2c_master_write_read_device(
         config_.i2c_port,
         config_.i2c_address,
@@ -171,6 +445,7 @@ esp_err_t EncoderReader::read_raw_angle(uint16_t* out_raw) {
         1,
         timeout);
     if (err != ESP_OK) {
+        ++i2c_errors_;
         ESP_LOGW(TAG, "Failed to read MT6701 LSB: %s", esp_err_to_name(err));
         return err;
     }
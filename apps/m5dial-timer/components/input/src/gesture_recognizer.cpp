@@ -0,0 +1,387 @@
+#include "input/gesture_recognizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+namespace dial {
+
+namespace {
+
+constexpr uint8_t kStay = 0xFF;
+
+// One row per transition; the first row matching (state, input, guards) wins.
+// A row matches when (guards & guard_mask) == guard_value.
+struct GestureRule {
+    GestureState state;
+    GestureInput input;
+    uint8_t guard_mask;
+    uint8_t guard_value;
+    uint8_t next;
+    uint16_t actions;
+};
+
+constexpr uint8_t id(GestureState state) {
+    return static_cast<uint8_t>(state);
+}
+
+constexpr uint8_t kDoubleTapGuards = kGestureGuardTapShape | kGestureGuardDoubleWindow;
+
+constexpr GestureRule kGestureRules[] = {
+    // A pending tap is reported once its window has passed with no second
+    // contact; a contact that starts late reports it first.
+    {GestureState::Idle, GestureInput::Release, kGestureGuardTapDue, kGestureGuardTapDue, kStay, kGestureActionFlushTap},
+    {GestureState::Idle, GestureInput::Release, 0, 0, kStay, 0},
+    {GestureState::Idle, GestureInput::Contact, kGestureGuardTapDue, kGestureGuardTapDue, id(GestureState::Pressed),
+     kGestureActionFlushTap | kGestureActionBeginContact},
+    {GestureState::Idle, GestureInput::Contact, 0, 0, id(GestureState::Pressed), kGestureActionBeginContact},
+    {GestureState::Idle, GestureInput::Multi, kGestureGuardTapDue, kGestureGuardTapDue, id(GestureState::Multi),
+     kGestureActionFlushTap | kGestureActionBeginMulti},
+    {GestureState::Idle, GestureInput::Multi, 0, 0, id(GestureState::Multi), kGestureActionBeginMulti},
+
+    // One finger down. A second finger turns the contact into a two-finger
+    // tap; its single-finger history is dropped.
+    {GestureState::Pressed, GestureInput::Contact, kGestureGuardLongPressDue, kGestureGuardLongPressDue, id(GestureState::Held),
+     kGestureActionTrack | kGestureActionLongPress},
+    {GestureState::Pressed, GestureInput::Contact, 0, 0, kStay, kGestureActionTrack},
+    {GestureState::Pressed, GestureInput::Multi, 0, 0, id(GestureState::Multi), kGestureActionBeginMulti},
+    {GestureState::Held, GestureInput::Contact, 0, 0, kStay, kGestureActionTrack},
+    {GestureState::Held, GestureInput::Multi, 0, 0, id(GestureState::Multi), kGestureActionBeginMulti},
+
+    // Lift-off. The controller's gesture ID beats the end points; a swipe
+    // cancels a pending tap. A tap outside the double-tap window reports the
+    // pending one before taking its place.
+    {GestureState::Pressed, GestureInput::Release, kGestureGuardHardwareSwipe, kGestureGuardHardwareSwipe, id(GestureState::Idle),
+     kGestureActionHardwareSwipe | kGestureActionDropTap},
+    {GestureState::Pressed, GestureInput::Release, kGestureGuardSwipeShape, kGestureGuardSwipeShape, id(GestureState::Idle),
+     kGestureActionSwipe | kGestureActionDropTap},
+    {GestureState::Pressed, GestureInput::Release, kDoubleTapGuards, kDoubleTapGuards, id(GestureState::Idle),
+     kGestureActionDoubleTap},
+    {GestureState::Pressed, GestureInput::Release, kGestureGuardTapShape, kGestureGuardTapShape, id(GestureState::Idle),
+     kGestureActionFlushTap | kGestureActionPendTap},
+    {GestureState::Pressed, GestureInput::Release, 0, 0, id(GestureState::Idle), 0},
+    {GestureState::Held, GestureInput::Release, kGestureGuardHardwareSwipe, kGestureGuardHardwareSwipe, id(GestureState::Idle),
+     kGestureActionHardwareSwipe | kGestureActionDropTap},
+    {GestureState::Held, GestureInput::Release, kGestureGuardSwipeShape, kGestureGuardSwipeShape, id(GestureState::Idle),
+     kGestureActionSwipe | kGestureActionDropTap},
+    {GestureState::Held, GestureInput::Release, 0, 0, id(GestureState::Idle), 0},
+
+    // Two fingers: only the lift-off matters.
+    {GestureState::Multi, GestureInput::Contact, 0, 0, kStay, 0},
+    {GestureState::Multi, GestureInput::Multi, 0, 0, kStay, 0},
+    {GestureState::Multi, GestureInput::Release, 0, 0, id(GestureState::Idle), kGestureActionTwoFinger | kGestureActionDropTap},
+};
+
+constexpr size_t kRuleCount = sizeof(kGestureRules) / sizeof(kGestureRules[0]);
+constexpr uint32_t kGestureGuardCombos = 1u << kGestureGuardBits;
+constexpr uint32_t kTableSize = kGestureStateCount * kGestureInputCount * kGestureGuardCombos;
+
+// Packed cell: next state in bits 0-1, actions in bits 2-12.
+constexpr uint16_t kUncovered = 0xFFFF;
+constexpr uint16_t kEmittingActions =
+    kGestureActionFlushTap | kGestureActionLongPress | kGestureActionHardwareSwipe | kGestureActionSwipe | kGestureActionDoubleTap | kGestureActionTwoFinger;
+
+constexpr uint32_t table_index(uint32_t state, uint32_t input, uint32_t guards) {
+    return ((state * kGestureInputCount + input) << kGestureGuardBits) | guards;
+}
+
+constexpr int first_match(uint32_t state, uint32_t input, uint32_t guards) {
+    for (size_t i = 0; i < kRuleCount; ++i) {
+        const GestureRule& rule = kGestureRules[i];
+        if (static_cast<uint32_t>(rule.state) == state && static_cast<uint32_t>(rule.input) == input &&
+            (guards & rule.guard_mask) == rule.guard_value) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+constexpr std::array<uint16_t, kTableSize> build_table() {
+    std::array<uint16_t, kTableSize> table{};
+    for (uint32_t state = 0; state < kGestureStateCount; ++state) {
+        for (uint32_t input = 0; input < kGestureInputCount; ++input) {
+            for (uint32_t guards = 0; guards < kGestureGuardCombos; ++guards) {
+                const int rule = first_match(state, input, guards);
+                uint16_t cell = kUncovered;
+                if (rule >= 0) {
+                    const GestureRule& r = kGestureRules[rule];
+                    const uint8_t next = r.next == kStay ? static_cast<uint8_t>(state) : r.next;
+                    cell = static_cast<uint16_t>(next | (r.actions << 2));
+                }
+                table[table_index(state, input, guards)] = cell;
+            }
+        }
+    }
+    return table;
+}
+
+constexpr std::array<uint16_t, kTableSize> kTransitionTable = build_table();
+
+// Guards any rule for (state, input) tests; the others cannot change the
+// cell, so update() does not evaluate them.
+constexpr std::array<uint8_t, kGestureStateCount * kGestureInputCount> build_guard_masks() {
+    std::array<uint8_t, kGestureStateCount * kGestureInputCount> masks{};
+    for (const GestureRule& rule : kGestureRules) {
+        masks[static_cast<uint32_t>(rule.state) * kGestureInputCount + static_cast<uint32_t>(rule.input)] |=
+            rule.guard_mask;
+    }
+    return masks;
+}
+
+constexpr std::array<uint8_t, kGestureStateCount * kGestureInputCount> kGuardMasks = build_guard_masks();
+constexpr uint8_t kPendingTapGuards = kGestureGuardTapDue | kGestureGuardDoubleWindow;
+constexpr uint8_t kShapeGuards = kGestureGuardTapShape | kGestureGuardSwipeShape;
+
+constexpr bool all_covered() {
+    for (uint16_t cell : kTransitionTable) {
+        if (cell == kUncovered) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool all_rules_reachable() {
+    bool used[kRuleCount] = {};
+    for (uint32_t state = 0; state < kGestureStateCount; ++state) {
+        for (uint32_t input = 0; input < kGestureInputCount; ++input) {
+            for (uint32_t guards = 0; guards < kGestureGuardCombos; ++guards) {
+                const int rule = first_match(state, input, guards);
+                if (rule >= 0) {
+                    used[rule] = true;
+                }
+            }
+        }
+    }
+    for (bool u : used) {
+        if (!u) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool events_fit() {
+    for (const GestureRule& rule : kGestureRules) {
+        size_t events = 0;
+        for (uint16_t bits = rule.actions & kEmittingActions; bits != 0; bits &= static_cast<uint16_t>(bits - 1)) {
+            ++events;
+        }
+        if (events > kMaxGestureEvents) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(all_covered(), "every (state, input, guards) cell needs a gesture rule");
+static_assert(all_rules_reachable(), "a gesture rule is shadowed by an earlier one");
+static_assert(events_fit(), "a gesture rule reports more than kMaxGestureEvents events");
+static_assert((kGestureActionDropTap << 2) <= 0x7FFF, "actions must fit the packed cell");
+
+int64_t contact_start(const TouchSample& sample) {
+    return sample.contact_start_us >= 0 && sample.contact_start_us <= sample.timestamp_us ? sample.contact_start_us
+                                                                                           : sample.timestamp_us;
+}
+
+uint32_t elapsed_ms(int64_t since_us, int64_t now_us) {
+    return now_us > since_us ? static_cast<uint32_t>((now_us - since_us) / 1000) : 0;
+}
+
+}  // namespace
+
+GestureTransition next_gesture_transition(GestureState current, GestureInput input, uint8_t guards) {
+    const uint16_t cell = kTransitionTable[table_index(static_cast<uint32_t>(current), static_cast<uint32_t>(input),
+                                                       guards & (kGestureGuardCombos - 1))];
+    return GestureTransition{
+        .next = static_cast<GestureState>(cell & 0x03),
+        .actions = static_cast<uint16_t>(cell >> 2),
+    };
+}
+
+void GestureRecognizer::configure(const GestureConfig& config) {
+    config_ = config;
+    double_tap_us_ = static_cast<int64_t>(config_.double_tap_max_interval_ms) * 1000;
+    long_press_us_ = static_cast<int64_t>(config_.long_press_min_duration_ms) * 1000;
+    tap_limit_us_ = (static_cast<int64_t>(config_.tap_max_duration_ms) + 1) * 1000;
+    swipe_limit_us_ = (static_cast<int64_t>(config_.swipe_max_duration_ms) + 1) * 1000;
+}
+
+void GestureRecognizer::reset() {
+    state_ = GestureState::Idle;
+    contact_gesture_ = TouchGesture::None;
+    pending_tap_ = false;
+}
+
+uint8_t GestureRecognizer::guards(const TouchSample& sample, uint8_t needed) const {
+    const int64_t now_us = sample.timestamp_us;
+    uint8_t guards = 0;
+    if ((needed & kPendingTapGuards) != 0 && pending_tap_) {
+        guards |= now_us - pending_tap_timestamp_us_ <= double_tap_us_ ? kGestureGuardDoubleWindow : kGestureGuardTapDue;
+    }
+    if ((needed & kGestureGuardLongPressDue) != 0 && now_us - start_us_ >= long_press_us_) {
+        guards |= kGestureGuardLongPressDue;
+    }
+    if ((needed & kShapeGuards) != 0) {
+        const int64_t duration_us = now_us - start_us_;
+        const int32_t dx = static_cast<int32_t>(last_x_) - static_cast<int32_t>(start_x_);
+        const int32_t dy = static_cast<int32_t>(last_y_) - static_cast<int32_t>(start_y_);
+        const uint32_t movement = static_cast<uint32_t>(std::max(std::abs(dx), std::abs(dy)));
+        if (movement <= config_.tap_max_movement && duration_us < tap_limit_us_) {
+            guards |= kGestureGuardTapShape;
+        }
+        if (movement >= config_.swipe_min_distance && duration_us < swipe_limit_us_) {
+            guards |= kGestureGuardSwipeShape;
+        }
+    }
+    if ((needed & kGestureGuardHardwareSwipe) != 0) {
+        switch (contact_gesture_) {
+            case TouchGesture::MoveUp:
+            case TouchGesture::MoveDown:
+            case TouchGesture::MoveLeft:
+            case TouchGesture::MoveRight:
+                guards |= kGestureGuardHardwareSwipe;
+                break;
+            default:
+                break;
+        }
+    }
+    return guards;
+}
+
+TapZone GestureRecognizer::classify_zone(uint16_t x, uint16_t y) const {
+    const uint16_t top_threshold = static_cast<uint16_t>((config_.screen_height * config_.edge_zone_percent) / 100);
+    const uint16_t bottom_threshold = static_cast<uint16_t>(config_.screen_height - top_threshold);
+    const uint16_t left_threshold = static_cast<uint16_t>((config_.screen_width * config_.edge_zone_percent) / 100);
+    const uint16_t right_threshold = static_cast<uint16_t>(config_.screen_width - left_threshold);
+
+    if (y <= top_threshold) {
+        return TapZone::TopEdge;
+    }
+    if (y >= bottom_threshold) {
+        return TapZone::BottomEdge;
+    }
+    if (x <= left_threshold) {
+        return TapZone::LeftEdge;
+    }
+    if (x >= right_threshold) {
+        return TapZone::RightEdge;
+    }
+    return TapZone::Center;
+}
+
+TouchEvent GestureRecognizer::make_event(TouchEventType type, uint16_t x, uint16_t y, int64_t since_us,
+                                         int64_t now_us) const {
+    TouchEvent event{};
+    event.type = type;
+    event.zone = type == TouchEventType::TwoFingerTap ? TapZone::Center : classify_zone(x, y);
+    event.x = x;
+    event.y = y;
+    event.duration_ms = elapsed_ms(since_us, now_us);
+    return event;
+}
+
+TouchEvent GestureRecognizer::make_swipe_event(int32_t dx, int32_t dy, int64_t now_us) const {
+    TouchEvent event{};
+    if (std::abs(dy) >= std::abs(dx)) {
+        event.type = dy < 0 ? TouchEventType::SwipeUp : TouchEventType::SwipeDown;
+    } else {
+        event.type = dx < 0 ? TouchEventType::SwipeLeft : TouchEventType::SwipeRight;
+    }
+    event.x = start_x_;
+    event.y = start_y_;
+    event.duration_ms = elapsed_ms(start_us_, now_us);
+    return event;
+}
+
+size_t GestureRecognizer::update(const TouchSample& sample, TouchEvent* out) {
+    ++samples_;
+    const TouchReport& report = sample.report;
+    const int64_t now_us = sample.timestamp_us;
+    const GestureInput input = report.touch_count >= 2   ? GestureInput::Multi
+                               : report.touch_count == 1 ? GestureInput::Contact
+                                                         : GestureInput::Release;
+    // The gesture ID can arrive with the lift-off read; a stale one between
+    // contacts is ignored.
+    if (report.gesture != TouchGesture::None && (state_ != GestureState::Idle || input != GestureInput::Release)) {
+        contact_gesture_ = report.gesture;
+    }
+
+    const uint8_t needed = kGuardMasks[static_cast<uint32_t>(state_) * kGestureInputCount + static_cast<uint32_t>(input)];
+    const GestureTransition transition = next_gesture_transition(state_, input, guards(sample, needed));
+    const uint16_t actions = transition.actions;
+    size_t count = 0;
+
+    // Most samples only track a contact or wait out an idle gap.
+    if (transition.next == state_ && (actions & ~kGestureActionTrack) == 0) {
+        if (actions != 0) {
+            last_x_ = report.x[0];
+            last_y_ = report.y[0];
+        }
+        return 0;
+    }
+
+    if ((actions & kGestureActionFlushTap) != 0 && pending_tap_) {
+        out[count++] = pending_tap_event_;
+        pending_tap_ = false;
+    }
+    if ((actions & kGestureActionBeginContact) != 0) {
+        start_x_ = last_x_ = report.x[0];
+        start_y_ = last_y_ = report.y[0];
+        start_us_ = contact_start(sample);
+    }
+    if ((actions & kGestureActionTrack) != 0) {
+        last_x_ = report.x[0];
+        last_y_ = report.y[0];
+    }
+    if ((actions & kGestureActionBeginMulti) != 0) {
+        start_x_ = static_cast<uint16_t>((report.x[0] + report.x[1]) / 2);
+        start_y_ = static_cast<uint16_t>((report.y[0] + report.y[1]) / 2);
+        start_us_ = contact_start(sample);
+    }
+    if ((actions & kGestureActionLongPress) != 0) {
+        out[count++] = make_event(TouchEventType::LongPress, start_x_, start_y_, start_us_, now_us);
+    }
+    if ((actions & kGestureActionHardwareSwipe) != 0) {
+        // Gesture IDs are in panel coordinates, like the points.
+        int32_t hx = 0;
+        int32_t hy = 0;
+        switch (contact_gesture_) {
+            case TouchGesture::MoveUp: hy = -1; break;
+            case TouchGesture::MoveDown: hy = 1; break;
+            case TouchGesture::MoveLeft: hx = -1; break;
+            case TouchGesture::MoveRight: hx = 1; break;
+            default: break;
+        }
+        out[count++] = make_swipe_event(hx, hy, now_us);
+        ++hardware_swipes_;
+    }
+    if ((actions & kGestureActionSwipe) != 0) {
+        out[count++] = make_swipe_event(static_cast<int32_t>(last_x_) - static_cast<int32_t>(start_x_),
+                                        static_cast<int32_t>(last_y_) - static_cast<int32_t>(start_y_), now_us);
+        ++software_swipes_;
+    }
+    if ((actions & kGestureActionDoubleTap) != 0) {
+        out[count++] = make_event(TouchEventType::DoubleTap, start_x_, start_y_, start_us_, now_us);
+        pending_tap_ = false;
+    }
+    if ((actions & kGestureActionPendTap) != 0) {
+        pending_tap_event_ = make_event(TouchEventType::Tap, start_x_, start_y_, start_us_, now_us);
+        pending_tap_timestamp_us_ = now_us;
+        pending_tap_ = true;
+    }
+    if ((actions & kGestureActionTwoFinger) != 0) {
+        out[count++] = make_event(TouchEventType::TwoFingerTap, start_x_, start_y_, start_us_, now_us);
+    }
+    if ((actions & kGestureActionDropTap) != 0) {
+        pending_tap_ = false;
+    }
+
+    state_ = transition.next;
+    if (state_ == GestureState::Idle) {
+        contact_gesture_ = TouchGesture::None;
+    }
+    return count;
+}
+
+}  // namespace dial
@@ -0,0 +1,56 @@
+#include "input/motion_tracker.h"
+
+namespace dial {
+
+namespace {
+constexpr int64_t kUsToQ20Seconds = 1099512;  // round(2^40 / 1e6); (us * k) >> 20 is Q20 s
+}  // namespace
+
+void MotionTracker::restart(int32_t position, uint32_t timestamp_us) {
+    position_q8_ = static_cast<int64_t>(position) << 8;
+    velocity_q8_ = 0;
+    acceleration_q8_ = 0;
+    last_timestamp_us_ = timestamp_us;
+    primed_ = true;
+}
+
+EncoderMotion MotionTracker::update(int32_t position, uint32_t timestamp_us) {
+    const uint32_t dt_us = timestamp_us - last_timestamp_us_;
+    if (!primed_ || dt_us > config_.max_gap_us) {
+        restart(position, timestamp_us);
+        return motion();
+    }
+    if (dt_us == 0) {
+        return motion();
+    }
+    last_timestamp_us_ = timestamp_us;
+
+    if (dt_us != cached_dt_us_) {
+        cached_dt_us_ = dt_us;
+        cached_dt_q20_ = (static_cast<int64_t>(dt_us) * kUsToQ20Seconds) >> 20;
+        cached_inv_dt_q20_ = (int64_t{1} << 40) / cached_dt_q20_;
+    }
+    const int64_t dt = cached_dt_q20_;
+    const int64_t inv_dt = cached_inv_dt_q20_;
+
+    // Predict.
+    const int64_t accel_dt = (acceleration_q8_ * dt) >> 20;
+    const int64_t predicted_position = position_q8_ + ((velocity_q8_ * dt) >> 20) + ((accel_dt * dt) >> 21);
+    const int64_t predicted_velocity = velocity_q8_ + accel_dt;
+
+    const int64_t residual = (static_cast<int64_t>(position) << 8) - predicted_position;
+    const int64_t max_residual = static_cast<int64_t>(config_.max_residual_raw) << 8;
+    if (residual > max_residual || residual < -max_residual) {
+        restart(position, timestamp_us);
+        return motion();
+    }
+
+    // Correct.
+    position_q8_ = predicted_position + ((residual * config_.alpha_q16) >> 16);
+    velocity_q8_ = predicted_velocity + ((((residual * config_.beta_q16) >> 16) * inv_dt) >> 20);
+    const int64_t accel_step = (((residual * config_.gamma_q16) >> 15) * inv_dt) >> 20;
+    acceleration_q8_ += (accel_step * inv_dt) >> 20;
+    return motion();
+}
+
+}  // namespace dial
@@ -1,9 +1,8 @@
 #include "input/time_selector.h"
 
 #include <algorithm>
-#include <cmath>
 
-#include <freertos/task.h>
+#include <esp_check.h>
 #include <esp_log.h>
 #include <esp_timer.h>
 
@@ -11,6 +10,7 @@ namespace dial {
 
 namespace {
 constexpr const char* TAG = "TimeSelector";
+constexpr int64_t kMinArmDelayUs = 50;  // esp_timer rejects shorter one-shots
 }
 
 TimeSelector g_time_selector;
@@ -18,131 +18,122 @@ TimeSelector g_time_selector;
 esp_err_t TimeSelector::init(const TimeSelectorConfig& config) {
     config_ = config;
 
-    if (event_queue_ == nullptr) {
-        event_queue_ = xQueueCreate(config.queue_depth, sizeof(TimeDeltaEvent));
-        if (event_queue_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to create event queue");
-            return ESP_ERR_NO_MEM;
-        }
+    if (commit_timer_ == nullptr) {
+        esp_timer_create_args_t args{
+            .callback = &TimeSelector::commit_timer_callback,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "selector_commit",
+            .skip_unhandled_events = true,
+        };
+        ESP_RETURN_ON_ERROR(esp_timer_create(&args, &commit_timer_), TAG, "esp_timer_create failed");
     }
-
-    accumulated_seconds_ = std::min<int32_t>(config_.base_step_seconds, config_.max_total_seconds);
-    last_timestamp_us_ = 0;
-    last_activity_us_ = 0;
-    commit_sent_ = false;
+    esp_timer_stop(commit_timer_);
+    commit_armed_.store(false);
+
+    accumulated_seconds_.store(std::min<int32_t>(config_.initial_seconds, config_.max_total_seconds),
+                               std::memory_order_relaxed);
+    table_.build(config_.curve, config_.ticks_per_revolution);
+    last_activity_us_.store(0);
+    ESP_LOGI(TAG, "Time selector ready (%lu-%lu s per tick, commit after %lu ms)",
+             static_cast<unsigned long>(table_.finest_step()),
+             static_cast<unsigned long>(table_.seconds_per_tick(INT32_MAX)),
+             static_cast<unsigned long>(config_.commit_timeout_ms));
     return ESP_OK;
 }
 
-void TimeSelector::start() {
-    if (task_handle_ != nullptr) {
-        ESP_LOGW(TAG, "Time selector already running");
+void TimeSelector::set_input_locked(bool locked) {
+    // A pending commit is dropped when its timer fires.
+    input_locked_.store(locked, std::memory_order_relaxed);
+}
+
+void TimeSelector::commit_timer_callback(void* arg) {
+    static_cast<TimeSelector*>(arg)->on_commit_timer();
+}
+
+// Ticks only move last_activity_us_ forward, so the timer armed by the first
+// tick of a turn re-arms for the remainder here instead of being restarted on
+// every tick. Clearing commit_armed_ before reading the activity time means a
+// tick racing with this callback is either seen here or arms a fresh timer.
+void TimeSelector::on_commit_timer() {
+    commit_armed_.store(false);
+    const int64_t now_us = esp_timer_get_time();
+    const int64_t due_us = last_activity_us_.load() + static_cast<int64_t>(config_.commit_timeout_ms) * 1000;
+    if (now_us < due_us) {
+        if (!commit_armed_.exchange(true)) {
+            ++commit_rearms_;
+            esp_timer_start_once(commit_timer_, static_cast<uint64_t>(std::max(due_us - now_us, kMinArmDelayUs)));
+        }
         return;
     }
-
-    const BaseType_t res = xTaskCreatePinnedToCore(
-        &TimeSelector::task_entry,
-        "time_selector",
-        4096,
-        this,
-        6,
-        &task_handle_,
-        0);
-    if (res != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create time selector task");
-        task_handle_ = nullptr;
+    if (input_locked()) {
+        return;
     }
+    ++commits_;
+    max_commit_late_us_ = std::max(max_commit_late_us_, static_cast<uint32_t>(now_us - due_us));
+
+    TimeDeltaEvent commit_event{};
+    commit_event.type = TimeEventType::Commit;
+    commit_event.total_seconds = accumulated_seconds_.load(std::memory_order_relaxed);
+    commit_event.delta_seconds = 0;
+    commit_event.timestamp_us = static_cast<uint32_t>(now_us);
+    commit_event.multiplier = 0;
+    commit_event.control = ControlCommand::None;
+    emit(commit_event);
 }
 
-void TimeSelector::task_entry(void* arg) {
-    auto* self = static_cast<TimeSelector*>(arg);
-    self->run();
+void TimeSelector::log_stats() {
+    ESP_LOGI(TAG, "%lu commits (%lu timer re-arms), worst %lu us past the deadline",
+             static_cast<unsigned long>(commits_), static_cast<unsigned long>(commit_rearms_),
+             static_cast<unsigned long>(max_commit_late_us_));
 }
 
-void TimeSelector::set_input_locked(bool locked) {
-    input_locked_ = locked;
-    if (locked) {
-        last_activity_us_ = 0;
-        commit_sent_ = true;
+void TimeSelector::emit(const TimeDeltaEvent& event) {
+    if (sink_ != nullptr) {
+        sink_(event);
     }
 }
 
-void TimeSelector::run() {
-    EncoderSample sample;
-    const TickType_t wait_ticks = pdMS_TO_TICKS(10);
-    while (true) {
-        if (xQueueReceive(g_encoder_reader.queue(), &sample, wait_ticks) == pdTRUE) {
-            commit_sent_ = false;
-            last_activity_us_ = static_cast<uint64_t>(sample.timestamp_us);
-            process_sample(sample);
-        } else {
-            if (!commit_sent_ && last_activity_us_ != 0) {
-                const uint64_t now_us = esp_timer_get_time();
-                const uint64_t elapsed_ms = (now_us - last_activity_us_) / 1000ULL;
-                if (elapsed_ms >= config_.commit_timeout_ms) {
-                    TimeDeltaEvent commit_event{};
-                    commit_event.type = TimeEventType::Commit;
-                    commit_event.total_seconds = accumulated_seconds_;
-                    commit_event.delta_seconds = 0;
-                    commit_event.timestamp_us = static_cast<uint32_t>(now_us);
-                    commit_event.multiplier = 0;
-                    commit_event.control = ControlCommand::None;
-                    if (event_queue_ != nullptr) {
-                        xQueueSend(event_queue_, &commit_event, portMAX_DELAY);
-                    }
-                    commit_sent_ = true;
-                }
-            }
-        }
+void TimeSelector::arm_commit(int64_t now_us) {
+    last_activity_us_.store(now_us);
+    if (!commit_armed_.exchange(true)) {
+        esp_timer_start_once(commit_timer_, static_cast<uint64_t>(config_.commit_timeout_ms) * 1000);
     }
 }
 
-void TimeSelector::process_sample(const EncoderSample& sample) {
-    if (input_locked_) {
+void TimeSelector::handle_sample(const EncoderSample& sample) {
+    if (input_locked() || sample.delta_ticks == 0) {
         return;
     }
-    if (sample.delta_ticks == 0) {
-        return;
-    }
-
-    const uint32_t now_us = sample.timestamp_us;
-    const uint32_t dt_us = last_timestamp_us_ == 0 ? 0 : (now_us - last_timestamp_us_);
-    last_timestamp_us_ = now_us;
-
-    float ticks_per_second = 0.0f;
-    if (dt_us > 0) {
-        ticks_per_second = std::abs(static_cast<float>(sample.delta_ticks)) / (static_cast<float>(dt_us) / 1'000'000.0f);
-    }
+    const int64_t now_us = esp_timer_get_time();
 
-    uint32_t multiplier = 1;
-    if (ticks_per_second >= config_.fast_threshold_tps) {
-        multiplier = config_.fast_multiplier;
-    } else if (ticks_per_second >= config_.medium_threshold_tps) {
-        multiplier = config_.medium_multiplier;
-    }
+    // Speed comes from the reader's tracker rather than the gap between
+    // samples, which jitters with sampling and batching.
+    const uint32_t step_seconds = table_.seconds_per_tick(sample.motion.velocity);
+    const uint32_t multiplier = step_seconds / std::max<uint32_t>(1, table_.finest_step());
 
-    const int32_t delta_seconds = static_cast<int32_t>(sample.delta_ticks) * static_cast<int32_t>(config_.base_step_seconds) * static_cast<int32_t>(multiplier);
-    const int32_t previous = accumulated_seconds_;
-    int32_t next = previous + delta_seconds;
+    const int32_t previous = accumulated_seconds_.load(std::memory_order_relaxed);
+    int32_t next = table_.advance(previous, sample.delta_ticks, step_seconds);
     next = std::clamp(next, static_cast<int32_t>(0), static_cast<int32_t>(config_.max_total_seconds));
 
     if (next == previous) {
+        arm_commit(now_us);  // turning against a clamp still defers the commit
         return;
     }
 
-    accumulated_seconds_ = next;
-    const int32_t applied_delta = accumulated_seconds_ - previous;
+    accumulated_seconds_.store(next, std::memory_order_relaxed);
+    const int32_t applied_delta = next - previous;
 
     TimeDeltaEvent event{};
     event.type = TimeEventType::Delta;
-    event.total_seconds = accumulated_seconds_;
+    event.total_seconds = next;
     event.delta_seconds = applied_delta;
     event.timestamp_us = sample.timestamp_us;
     event.multiplier = multiplier;
     event.control = ControlCommand::None;
-
-    if (event_queue_ != nullptr) {
-        xQueueSend(event_queue_, &event, portMAX_DELAY);
-    }
+    emit(event);
+    // After the delta is queued, so the commit cannot overtake it.
+    arm_commit(now_us);
 }
 
 }  // namespace dial
@@ -1,7 +1,7 @@
 #include "input/touch_input.h"
 
 #include <algorithm>
-#include <cstdlib>
+#include <iterator>
 
 #include <esp_log.h>
 #include <esp_timer.h>
@@ -12,7 +12,17 @@ namespace dial {
 
 namespace {
 constexpr const char* TAG = "TouchInput";
+
+template <size_t N>
+void record_latency(const uint32_t (&bounds_us)[N], uint32_t latency_us, uint32_t (&buckets)[N + 1], uint32_t* max_us) {
+    size_t bucket = 0;
+    while (bucket < N && latency_us >= bounds_us[bucket]) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+    *max_us = std::max(*max_us, latency_us);
 }
+}  // namespace
 
 TouchInput g_touch_input;
 
@@ -27,6 +37,10 @@ esp_err_t TouchInput::init(const TouchConfig& config) {
     }
 
     config_ = config;
+    recognizer_.configure(config_.gesture);
+    if (config_.record_trace && trace_.init() != ESP_OK) {
+        ESP_LOGW(TAG, "Touch trace disabled");
+    }
 
     if (queue_ == nullptr) {
         queue_ = xQueueCreate(config_.queue_depth, sizeof(TouchEvent));
@@ -59,164 +73,183 @@ esp_err_t TouchInput::init(const TouchConfig& config) {
 
 void TouchInput::task_entry(void* arg) {
     auto* self = static_cast<TouchInput*>(arg);
+    self->enable_wake();
+    self->gesture_source_ = self->config_.gesture_source;
     self->run();
 }
 
-TapZone TouchInput::classify_zone(uint16_t x, uint16_t y) const {
-    const uint16_t top_threshold = static_cast<uint16_t>((config_.screen_height * config_.edge_zone_percent) / 100);
-    const uint16_t bottom_threshold = static_cast<uint16_t>(config_.screen_height - top_threshold);
-    const uint16_t left_threshold = static_cast<uint16_t>((config_.screen_width * config_.edge_zone_percent) / 100);
-    const uint16_t right_threshold = static_cast<uint16_t>(config_.screen_width - left_threshold);
+void TouchInput::enable_wake() {
+    // The INT edge is timestamped in both modes so the latency histogram
+    // compares them; only interrupt mode sleeps on it.
+    TaskHandle_t wake_task = config_.use_interrupt ? xTaskGetCurrentTaskHandle() : nullptr;
+    const esp_err_t irq_status = g_board.touch().enable_interrupt(wake_task);
+    interrupt_mode_ = wake_task != nullptr && irq_status == ESP_OK;
+    ESP_LOGI(TAG, "Touch input %s, %s gestures", interrupt_mode_ ? "interrupt-driven" : "polling",
+             config_.gesture_source == GestureSource::Hardware ? "hardware" : "software");
+}
 
-    if (y <= top_threshold) {
-        return TapZone::TopEdge;
-    }
-    if (y >= bottom_threshold) {
-        return TapZone::BottomEdge;
+void TouchInput::emit(const TouchEvent& event) {
+    if (queue_ != nullptr) {
+        xQueueSend(queue_, &event, 0);
     }
-    if (x <= left_threshold) {
-        return TapZone::LeftEdge;
+    ++events_;
+}
+
+void TouchInput::record_detect_latency(uint32_t latency_us) {
+    record_latency(kTouchLatencyBucketUs, latency_us, latency_buckets_, &max_latency_us_);
+}
+
+void TouchInput::record_tap_latency(uint32_t latency_us) {
+    record_latency(kTapLatencyBucketUs, latency_us, tap_latency_buckets_, &max_tap_latency_us_);
+}
+
+void TouchInput::wait_for_next_sample() {
+    if (!interrupt_mode_ || recognizer_.contact_active()) {
+        const uint32_t poll_ms = gesture_source_ == GestureSource::Hardware ? config_.hardware_poll_interval_ms
+                                                                             : config_.poll_interval_ms;
+        vTaskDelay(pdMS_TO_TICKS(std::max<uint32_t>(1, poll_ms)));
+        return;
     }
-    if (x >= right_threshold) {
-        return TapZone::RightEdge;
+
+    // Idle: sleep until the next contact edge, or until a pending single tap
+    // is due to be reported.
+    TickType_t wait = portMAX_DELAY;
+    if (recognizer_.tap_pending()) {
+        const int64_t due_us = std::max<int64_t>(0, recognizer_.tap_deadline_us() - esp_timer_get_time());
+        wait = pdMS_TO_TICKS(static_cast<uint64_t>(due_us) / 1000ULL) + 1;
     }
-    return TapZone::Center;
+    ulTaskNotifyTake(pdTRUE, wait);
 }
 
-TouchEvent TouchInput::make_tap_event(uint16_t x, uint16_t y, uint32_t duration_ms) const {
-    TouchEvent event{};
-    event.type = TouchEventType::Tap;
-    event.zone = classify_zone(x, y);
-    event.x = x;
-    event.y = y;
-    event.duration_ms = duration_ms;
-    return event;
+TouchStats TouchInput::stats() const {
+    TouchStats out{};
+    out.interrupt_mode = interrupt_mode_;
+    out.gesture_source = gesture_source_;
+    out.i2c_reads = g_board.touch().read_count();
+    out.i2c_bytes = g_board.touch().bus_bytes();
+    out.active_us = active_us_;
+    out.hardware_gestures = recognizer_.hardware_swipes();
+    out.software_swipes = recognizer_.software_swipes();
+    out.trace_dropped = trace_.dropped();
+    out.interrupts = g_board.touch().interrupt_count();
+    out.events = events_;
+    std::copy(std::begin(latency_buckets_), std::end(latency_buckets_), std::begin(out.latency_buckets));
+    out.max_latency_us = max_latency_us_;
+    std::copy(std::begin(tap_latency_buckets_), std::end(tap_latency_buckets_), std::begin(out.tap_latency_buckets));
+    out.max_tap_latency_us = max_tap_latency_us_;
+    return out;
 }
 
-void TouchInput::run() {
-    const TickType_t delay_ticks = pdMS_TO_TICKS(std::max<uint32_t>(1, config_.poll_interval_ms));
+void TouchInput::log_stats() {
+    const TouchStats s = stats();
+    const int64_t now_us = esp_timer_get_time();
+    const double elapsed_s = last_logged_us_ > 0 ? static_cast<double>(now_us - last_logged_us_) / 1e6 : 0.0;
+    const double reads_per_s = elapsed_s > 0.0 ? static_cast<double>(s.i2c_reads - last_logged_reads_) / elapsed_s : 0.0;
+    last_logged_reads_ = s.i2c_reads;
+    last_logged_us_ = now_us;
 
-    TouchPoint point{};
-    while (true) {
-        const uint64_t now_us = esp_timer_get_time();
+    const double events = s.events > 0 ? static_cast<double>(s.events) : 1.0;
 
-        if (pending_tap_ && !last_active_ && !multi_active_ && now_us >= pending_tap_deadline_us_) {
-            if (queue_ != nullptr) {
-                xQueueSend(queue_, &pending_tap_event_, 0);
-            }
-            pending_tap_ = false;
-            pending_tap_timestamp_us_ = 0;
-            pending_tap_deadline_us_ = 0;
-        }
+    ESP_LOGI(TAG, "%s/%s: %.1f I2C reads/s, %lu irqs, %lu events (%lu hw swipes, %lu sw swipes), "
+                  "per event %.0f reads %.0f bytes %.0f us, touch-down latency <1/<2/<5/<10/<20/>=20 ms: "
+                  "%lu/%lu/%lu/%lu/%lu/%lu (max %lu us)",
+             s.interrupt_mode ? "irq" : "poll", s.gesture_source == GestureSource::Hardware ? "hw" : "sw", reads_per_s,
+             static_cast<unsigned long>(s.interrupts), static_cast<unsigned long>(s.events),
+             static_cast<unsigned long>(s.hardware_gestures), static_cast<unsigned long>(s.software_swipes),
+             s.i2c_reads / events, s.i2c_bytes / events, s.active_us / events,
+             static_cast<unsigned long>(s.latency_buckets[0]), static_cast<unsigned long>(s.latency_buckets[1]),
+             static_cast<unsigned long>(s.latency_buckets[2]), static_cast<unsigned long>(s.latency_buckets[3]),
+             static_cast<unsigned long>(s.latency_buckets[4]), static_cast<unsigned long>(s.latency_buckets[5]),
+             static_cast<unsigned long>(s.max_latency_us));
+    ESP_LOGI(TAG, "%s: tap latency (INT edge to emit) <400/<500/<600/<700/<800/>=800 ms: %lu/%lu/%lu/%lu/%lu/%lu "
+                  "(max %lu us)",
+             s.interrupt_mode ? "irq" : "poll", static_cast<unsigned long>(s.tap_latency_buckets[0]),
+             static_cast<unsigned long>(s.tap_latency_buckets[1]), static_cast<unsigned long>(s.tap_latency_buckets[2]),
+             static_cast<unsigned long>(s.tap_latency_buckets[3]), static_cast<unsigned long>(s.tap_latency_buckets[4]),
+             static_cast<unsigned long>(s.tap_latency_buckets[5]), static_cast<unsigned long>(s.max_tap_latency_us));
+    if (trace_.enabled()) {
+        ESP_LOGI(TAG, "Touch trace: %lu records dropped", static_cast<unsigned long>(s.trace_dropped));
+    }
+}
 
-        bool touch_ok = g_board.touch().read(&point) == ESP_OK;
-        const bool active = touch_ok && point.touched;
-        const uint8_t touches = touch_ok ? point.touch_count : 0;
+size_t TouchInput::dump_trace(size_t max_records) {
+    return trace_.dump(max_records);
+}
 
-        if (touches >= 2) {
-            if (!multi_active_) {
-                multi_active_ = true;
-                multi_start_x_ = point.x;
-                multi_start_y_ = point.y;
-                multi_start_us_ = now_us;
-            }
-            last_active_ = false;
+TouchSample TouchInput::read_sample(int64_t now_us) {
+    TouchController& touch = g_board.touch();
+    TouchSample sample{};
+    if (gesture_source_ == GestureSource::Hardware) {
+        sample.timestamp_us = now_us;
+        if (touch.read_report(&sample.report) != ESP_OK) {
+            sample.report = TouchReport{};
         }
+    } else {
+        TouchPoint point{};
+        sample = touch_sample(now_us, touch.read(&point) == ESP_OK ? point : TouchPoint{});
+    }
 
-        if (active && touches == 1 && !multi_active_) {
-            last_x_ = point.x;
-            last_y_ = point.y;
-            if (!last_active_) {
-                start_x_ = point.x;
-                start_y_ = point.y;
-                start_us_ = now_us;
-                long_press_reported_ = false;
-            } else if (!long_press_reported_) {
-                const uint32_t duration_ms = static_cast<uint32_t>((now_us - start_us_) / 1000ULL);
-                if (duration_ms >= config_.long_press_min_duration_ms) {
-                    TouchEvent event{};
-                    event.type = TouchEventType::LongPress;
-                    event.zone = classify_zone(start_x_, start_y_);
-                    event.x = start_x_;
-                    event.y = start_y_;
-                    event.duration_ms = duration_ms;
-                    if (queue_ != nullptr) {
-                        xQueueSend(queue_, &event, 0);
-                    }
-                    long_press_reported_ = true;
-                }
-            }
-            last_active_ = true;
-        } else if (!active) {
-            if (multi_active_) {
-                TouchEvent event{};
-                event.type = TouchEventType::TwoFingerTap;
-                event.x = multi_start_x_;
-                event.y = multi_start_y_;
-                event.duration_ms = static_cast<uint32_t>((now_us - multi_start_us_) / 1000ULL);
-                if (queue_ != nullptr) {
-                    xQueueSend(queue_, &event, 0);
-                }
-                multi_active_ = false;
-                last_active_ = false;
-                pending_tap_ = false;
-                pending_tap_timestamp_us_ = 0;
-                pending_tap_deadline_us_ = 0;
-                continue;
-            }
+    // The contact starts at the INT edge when there is one, so tap and
+    // long-press timing keeps its resolution at the slower hardware poll.
+    if (sample.report.touch_count > 0 && !recognizer_.contact_active()) {
+        const uint32_t edge_us = touch.take_contact_edge_us();
+        contact_edge_us_ = edge_us;
+        if (edge_us != 0) {
+            const uint32_t latency_us = static_cast<uint32_t>(now_us) - edge_us;
+            record_detect_latency(static_cast<uint32_t>(esp_timer_get_time()) - edge_us);
+            sample.contact_start_us = now_us - std::min<int64_t>(latency_us, now_us);
+        }
+    }
+    return sample;
+}
 
-            if (last_active_) {
-                const uint32_t duration_ms = static_cast<uint32_t>((now_us - start_us_) / 1000ULL);
-                const int32_t dx = static_cast<int32_t>(last_x_) - static_cast<int32_t>(start_x_);
-                const int32_t dy = static_cast<int32_t>(last_y_) - static_cast<int32_t>(start_y_);
-                const uint16_t movement = static_cast<uint16_t>(std::max(std::abs(dx), std::abs(dy)));
-
-                const bool is_swipe = movement >= config_.swipe_min_distance && duration_ms <= config_.swipe_max_duration_ms;
-                const bool is_tap = movement <= config_.tap_max_movement && duration_ms <= config_.tap_max_duration_ms;
-
-                if (is_swipe) {
-                    TouchEvent event{};
-                    if (std::abs(dy) >= std::abs(dx)) {
-                        event.type = dy < 0 ? TouchEventType::SwipeUp : TouchEventType::SwipeDown;
-                    } else {
-                        event.type = dx < 0 ? TouchEventType::SwipeLeft : TouchEventType::SwipeRight;
-                    }
-                    event.x = start_x_;
-                    event.y = start_y_;
-                    event.duration_ms = duration_ms;
-                    if (queue_ != nullptr) {
-                        xQueueSend(queue_, &event, 0);
-                    }
-                    pending_tap_ = false;
-                } else if (!long_press_reported_ && is_tap) {
-                    TouchEvent tap_event = make_tap_event(start_x_, start_y_, duration_ms);
-                    if (pending_tap_ && (now_us - pending_tap_timestamp_us_) <= static_cast<uint64_t>(config_.double_tap_max_interval_ms) * 1000ULL) {
-                        TouchEvent event{};
-                        event.type = TouchEventType::DoubleTap;
-                        event.zone = tap_event.zone;
-                        event.x = tap_event.x;
-                        event.y = tap_event.y;
-                        event.duration_ms = tap_event.duration_ms;
-                        if (queue_ != nullptr) {
-                            xQueueSend(queue_, &event, 0);
-                        }
-                        pending_tap_ = false;
-                        pending_tap_timestamp_us_ = 0;
-                        pending_tap_deadline_us_ = 0;
-                    } else {
-                        pending_tap_event_ = tap_event;
-                        pending_tap_timestamp_us_ = now_us;
-                        pending_tap_deadline_us_ = now_us + static_cast<uint64_t>(config_.double_tap_max_interval_ms) * 1000ULL;
-                        pending_tap_ = true;
-                    }
-                }
-            }
+void TouchInput::check_hardware_fallback(uint32_t hardware_before, uint32_t software_before) {
+    if (gesture_source_ != GestureSource::Hardware) {
+        return;
+    }
+    if (recognizer_.hardware_swipes() != hardware_before) {
+        hardware_misses_ = 0;
+    } else if (recognizer_.software_swipes() != software_before && recognizer_.hardware_swipes() == 0 &&
+               ++hardware_misses_ >= kHardwareMissesBeforeFallback) {
+        ESP_LOGW(TAG, "Controller reported no gestures for %lu swipes; using software gestures",
+                 static_cast<unsigned long>(hardware_misses_));
+        gesture_source_ = GestureSource::Software;
+    }
+}
+
+// Reads, timestamps and hands each sample to the recognizer; all gesture
+// timing and classification lives there.
+void TouchInput::run() {
+    TouchEvent events[kMaxGestureEvents];
+    while (true) {
+        const int64_t now_us = esp_timer_get_time();
+        const TouchSample sample = read_sample(now_us);
+        const bool was_active = recognizer_.contact_active();
+        const uint32_t hardware_before = recognizer_.hardware_swipes();
+        const uint32_t software_before = recognizer_.software_swipes();
 
-            last_active_ = false;
+        const bool tap_was_pending = recognizer_.tap_pending();
+        const int64_t tap_deadline_before = recognizer_.tap_deadline_us();
+
+        const size_t count = recognizer_.update(sample, events);
+        if (trace_.enabled() && (was_active || sample.report.touch_count > 0 || count > 0)) {
+            trace_.record(sample);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            emit(events[i]);
+            // A Tap is always the held one, never the contact that just ended.
+            if (events[i].type == TouchEventType::Tap && pending_tap_edge_us_ != 0) {
+                record_tap_latency(static_cast<uint32_t>(esp_timer_get_time()) - pending_tap_edge_us_);
+            }
+            trace_.record(events[i], now_us);
+        }
+        if (recognizer_.tap_pending() && (!tap_was_pending || recognizer_.tap_deadline_us() != tap_deadline_before)) {
+            pending_tap_edge_us_ = contact_edge_us_;
         }
+        check_hardware_fallback(hardware_before, software_before);
 
-        last_touch_count_ = touches;
-        vTaskDelay(delay_ticks);
+        active_us_ += static_cast<uint32_t>(esp_timer_get_time() - now_us);
+        wait_for_next_sample();
     }
 }
 
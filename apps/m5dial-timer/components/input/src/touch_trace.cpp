@@ -0,0 +1,78 @@
+#include "input/touch_trace.h"
+
+#include <cstdio>
+#include <new>
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+namespace dial {
+
+namespace {
+constexpr const char* TAG = "TouchTrace";
+}
+
+esp_err_t TouchTraceRecorder::init() {
+    if (ring_ != nullptr) {
+        return ESP_OK;
+    }
+    void* mem = heap_caps_aligned_alloc(kRingCacheLine, sizeof(Ring), MALLOC_CAP_SPIRAM);
+    const bool psram = mem != nullptr;
+    if (mem == nullptr) {
+        mem = heap_caps_aligned_alloc(kRingCacheLine, sizeof(Ring), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (mem == nullptr) {
+        ESP_LOGE(TAG, "No memory for a %u-record trace", static_cast<unsigned>(kTouchTraceDepth));
+        return ESP_ERR_NO_MEM;
+    }
+    ring_ = new (mem) Ring();
+    ESP_LOGI(TAG, "Recording touch trace, %u records (%u bytes in %s)", static_cast<unsigned>(kTouchTraceDepth),
+             static_cast<unsigned>(sizeof(Ring)), psram ? "PSRAM" : "internal RAM");
+    return ESP_OK;
+}
+
+void TouchTraceRecorder::push(const TouchTraceRecord& record) {
+    if (ring_ != nullptr && !ring_->push(record)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TouchTraceRecorder::record(const TouchSample& sample) {
+    TouchTraceRecord record{};
+    record.timestamp_us = sample.timestamp_us;
+    record.contact_start_us = sample.contact_start_us;
+    record.report = sample.report;
+    push(record);
+}
+
+void TouchTraceRecorder::record(const TouchEvent& event, int64_t timestamp_us) {
+    TouchTraceRecord record{};
+    record.timestamp_us = timestamp_us;
+    record.event = event;
+    record.is_event = true;
+    push(record);
+}
+
+size_t TouchTraceRecorder::dump(size_t max_records) {
+    if (ring_ == nullptr) {
+        return 0;
+    }
+    TouchTraceRecord r{};
+    size_t printed = 0;
+    while (printed < max_records && ring_->pop(&r)) {
+        if (r.is_event) {
+            std::printf("trace,E,%lld,%u,%u,%u,%u,%lu\n", static_cast<long long>(r.timestamp_us),
+                        static_cast<unsigned>(r.event.type), static_cast<unsigned>(r.event.zone), r.event.x,
+                        r.event.y, static_cast<unsigned long>(r.event.duration_ms));
+        } else {
+            std::printf("trace,S,%lld,%lld,%u,%u,%u,%u,%u,%u\n", static_cast<long long>(r.timestamp_us),
+                        static_cast<long long>(r.contact_start_us), r.report.touch_count,
+                        static_cast<unsigned>(r.report.gesture), r.report.x[0], r.report.y[0], r.report.x[1],
+                        r.report.y[1]);
+        }
+        ++printed;
+    }
+    return printed;
+}
+
+}  // namespace dial
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#endif
+
+namespace dial {
+
+// Alignment that keeps a ring's producer and consumer indices apart. Internal
+// SRAM on the S3 is uncached, so this only matters for rings placed in PSRAM
+// and on the host, but it costs a few bytes per ring either way.
+#if defined(CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE)
+inline constexpr size_t kRingCacheLine = CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE;
+#else
+inline constexpr size_t kRingCacheLine = 64;
+#endif
+
+}  // namespace dial
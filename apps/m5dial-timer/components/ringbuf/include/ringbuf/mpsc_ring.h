@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "ringbuf/cache_line.h"
+
+namespace dial {
+
+// Bounded multi-producer/single-consumer ring of a trivially-copyable type.
+// Producers claim a slot with a CAS on the shared tail, copy the item in and
+// publish it through the slot's sequence number, so push() is lock-free and
+// safe from ISRs and several tasks at once. A producer preempted between
+// claim and publish holds back later items until it resumes: pop() reports
+// empty in the meantime and the producer's own wakeup follows the publish.
+// Items from one producer come out in the order it pushed them. Platform-free.
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "MpscRing requires a trivially copyable type");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity must be a power of two");
+    static_assert(Capacity <= (1u << 30), "MpscRing sequence numbers are 32-bit");
+
+public:
+    using value_type = T;
+    static constexpr size_t capacity() { return Capacity; }
+
+    MpscRing() {
+        for (uint32_t i = 0; i < Capacity; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any producer. False when full; the item is not stored.
+    bool push(const T& item) {
+        uint32_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & kMask];
+            const int32_t lag = static_cast<int32_t>(slot->seq.load(std::memory_order_acquire) - pos);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;  // the consumer has not freed this slot yet
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = item;
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. False when empty or the next slot is still being written.
+    bool pop(T* out) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[head & kMask];
+        if (slot.seq.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        *out = slot.value;
+        slot.seq.store(head + static_cast<uint32_t>(Capacity), std::memory_order_release);
+        head_.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate; counts claimed slots, including ones not yet published.
+    size_t size() const {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        return tail_.load(std::memory_order_relaxed) - head;
+    }
+    // Consumer side: true when pop() would fail, even if a slot is claimed.
+    bool empty() const {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        return slots_[head & kMask].seq.load(std::memory_order_acquire) != head + 1;
+    }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity - 1);
+
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        T value;
+    };
+
+    alignas(kRingCacheLine) std::atomic<uint32_t> tail_{0};
+    alignas(kRingCacheLine) std::atomic<uint32_t> head_{0};
+    alignas(kRingCacheLine) Slot slots_[Capacity];
+};
+
+}  // namespace dial
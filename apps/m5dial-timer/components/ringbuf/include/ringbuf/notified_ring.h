@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace dial {
+
+// A ring plus its consumer wakeup. The consumer drains with pop() and sleeps
+// in wait() (or uses pop_wait()); producers push() or push_from_isr() and
+// signal the waker only when the consumer has announced it is going to sleep,
+// so a busy consumer costs producers a fence rather than a kernel call. The
+// announce/recheck and push/check pairs are both fenced, so a push racing
+// with the consumer going to sleep is never missed.
+//
+// Waker needs wake(), wake_from_isr(bool* yield) and wait(timeout) -> bool;
+// TaskNotifyWaker is the FreeRTOS one. Other producers (a queue, a timer
+// callback) may share the waker by calling waker().wake() directly; those
+// wakes are unconditional.
+template <typename Ring, typename Waker>
+class NotifiedRing {
+public:
+    using value_type = typename Ring::value_type;
+
+    NotifiedRing() = default;
+    explicit NotifiedRing(Waker waker) : waker_(std::move(waker)) {}
+
+    bool push(const value_type& item) {
+        if (!ring_.push(item)) {
+            return false;
+        }
+        if (consumer_sleeping()) {
+            waker_.wake();
+        }
+        return true;
+    }
+
+    // *yield is set when a higher-priority consumer was woken.
+    bool push_from_isr(const value_type& item, bool* yield) {
+        if (!ring_.push(item)) {
+            return false;
+        }
+        if (consumer_sleeping()) {
+            waker_.wake_from_isr(yield);
+        }
+        return true;
+    }
+
+    bool pop(value_type* out) { return ring_.pop(out); }
+
+    // Consumer: sleep until something may be ready. Returns at once if the
+    // ring is not empty; false if the waker timed out.
+    template <typename Timeout>
+    bool wait(Timeout timeout) {
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ring_.empty()) {
+            sleeping_.store(false, std::memory_order_relaxed);
+            return true;
+        }
+        const bool woken = waker_.wait(timeout);
+        sleeping_.store(false, std::memory_order_relaxed);
+        return woken;
+    }
+
+    // Consumer: pop, sleeping while the ring is empty. False if the wait
+    // timed out with nothing to pop.
+    template <typename Timeout>
+    bool pop_wait(value_type* out, Timeout timeout) {
+        while (!ring_.pop(out)) {
+            if (!wait(timeout)) {
+                return ring_.pop(out);
+            }
+        }
+        return true;
+    }
+
+    Ring& ring() { return ring_; }
+    const Ring& ring() const { return ring_; }
+    Waker& waker() { return waker_; }
+
+private:
+    bool consumer_sleeping() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return sleeping_.load(std::memory_order_relaxed) && sleeping_.exchange(false, std::memory_order_relaxed);
+    }
+
+    Ring ring_{};
+    Waker waker_{};
+    std::atomic<bool> sleeping_{false};
+};
+
+}  // namespace dial
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dial {
+
+// Sequence-locked cell holding the latest value of a small trivially-copyable
+// type. Readers never block the writer and never see a torn value; they retry
+// while a store is in flight. Single writer: store() must only ever be called
+// from one task at a time (the engine for snapshots, the encoder reader for
+// angles). The payload is kept in relaxed atomic words so the retry protocol
+// is free of data races. Platform-free.
+template <typename T>
+class SeqlockCell {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqlockCell requires a trivially copyable type");
+
+public:
+    void store(const T& value) {
+        // Odd while the payload is being written, even again once it is.
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::array<uint32_t, kWords> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Single read attempt; false if a store was in progress.
+    bool try_load(T* out, uint32_t* generation = nullptr) const {
+        const uint32_t before = seq_.load(std::memory_order_acquire);
+        if (before & 1u) {
+            return false;
+        }
+
+        std::array<uint32_t, kWords> buffer{};
+        for (size_t i = 0; i < kWords; ++i) {
+            buffer[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        // Through void*: default member initialisers in T trip -Wclass-memaccess.
+        std::memcpy(static_cast<void*>(out), buffer.data(), sizeof(T));
+        if (generation != nullptr) {
+            *generation = before / 2;
+        }
+        return true;
+    }
+
+    T load(uint32_t* generation = nullptr) const {
+        T value{};
+        while (!try_load(&value, generation)) {
+        }
+        return value;
+    }
+
+    // Number of completed stores; 0 means the cell was never written.
+    uint32_t generation() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::atomic<uint32_t>, kWords> words_{};
+};
+
+}  // namespace dial
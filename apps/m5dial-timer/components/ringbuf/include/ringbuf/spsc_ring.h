@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "ringbuf/cache_line.h"
+
+namespace dial {
+
+// Bounded single-producer/single-consumer ring of a trivially-copyable type.
+// push() and pop() never block and never enter a critical section, so either
+// end may run in an ISR. Each side owns one free-running index on its own
+// cache line and keeps a private copy of the other side's index, re-reading
+// the shared one only when the copy says full (producer) or empty (consumer).
+// Pair with NotifiedRing for the consumer wakeup. Platform-free.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing requires a trivially copyable type");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+    static_assert(Capacity <= (1u << 31), "SpscRing indices are 32-bit");
+
+public:
+    using value_type = T;
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Producer side. False when full; the item is not stored.
+    bool push(const T& item) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= Capacity) {
+                return false;
+            }
+        }
+        slots_[tail & kMask] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. False when empty.
+    bool pop(T* out) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        *out = slots_[head & kMask];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from any context; exact from either end.
+    size_t size() const {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity - 1);
+
+    alignas(kRingCacheLine) std::atomic<uint32_t> tail_{0};
+    uint32_t head_cache_ = 0;  // producer's view of head_
+    alignas(kRingCacheLine) std::atomic<uint32_t> head_{0};
+    uint32_t tail_cache_ = 0;  // consumer's view of tail_
+    alignas(kRingCacheLine) T slots_[Capacity];
+};
+
+}  // namespace dial
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace dial {
+
+// NotifiedRing waker backed by a direct-to-task notification used as a
+// counting semaphore. Bind the consuming task before producers start (or
+// accept that earlier wakes are skipped; the items stay in the ring). Pick a
+// notification index the task does not use for anything else.
+class TaskNotifyWaker {
+public:
+    explicit TaskNotifyWaker(UBaseType_t index = 0) : index_(index) {}
+    TaskNotifyWaker(const TaskNotifyWaker& other) : task_(other.task_.load()), index_(other.index_) {}
+
+    void bind(TaskHandle_t task) { task_.store(task, std::memory_order_release); }
+    void bind_current() { bind(xTaskGetCurrentTaskHandle()); }
+
+    void wake() {
+        TaskHandle_t task = task_.load(std::memory_order_acquire);
+        if (task != nullptr) {
+            xTaskNotifyGiveIndexed(task, index_);
+        }
+    }
+
+    void wake_from_isr(bool* yield) {
+        TaskHandle_t task = task_.load(std::memory_order_acquire);
+        if (task == nullptr) {
+            return;
+        }
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(task, index_, &woken);
+        if (woken == pdTRUE && yield != nullptr) {
+            *yield = true;
+        }
+    }
+
+    // Consumer task only.
+    bool wait(TickType_t timeout) { return ulTaskNotifyTakeIndexed(index_, pdTRUE, timeout) > 0; }
+
+private:
+    std::atomic<TaskHandle_t> task_{nullptr};
+    UBaseType_t index_ = 0;
+};
+
+}  // namespace dial
@@ -4,7 +4,7 @@
 
 #include <esp_err.h>
 
-#include "timer/timer_engine.h"
+#include "timer/timer_types.h"
 
 namespace dial::persistence {
 
@@ -15,8 +15,26 @@ struct RestoredState {
     bool valid = false;
 };
 
+struct PersistenceStats {
+    uint32_t requests = 0;           // save() calls
+    uint32_t coalesced = 0;          // requests superseded before reaching flash
+    uint32_t unchanged_skipped = 0;  // flushes dropped because flash already matched
+    uint32_t commits = 0;            // nvs_commit() calls
+    uint32_t entries_written = 0;    // 32-byte NVS entries consumed (wear)
+    uint32_t failures = 0;
+    uint32_t max_flush_us = 0;       // worst set+commit time
+};
+
 esp_err_t init();
+// Starts the write-behind worker and registers a shutdown flush. Until then
+// save() writes through synchronously.
+esp_err_t start();
+// Non-blocking once started: keeps only the latest snapshot and lets the
+// worker write it after a quiet debounce window.
 esp_err_t save(const TimerSnapshot& snapshot);
+// Writes any pending snapshot now (before power-off or restart).
+esp_err_t flush();
 esp_err_t load(RestoredState* out);
+PersistenceStats stats();
 
 }  // namespace dial::persistence
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "timer/timer_types.h"
+
+namespace dial::warm_restart {
+
+struct WarmState {
+    TimerState state = TimerState::Idle;
+    uint32_t setpoint_seconds = 0;
+    int64_t remaining_us = 0;  // at restore time; <= 0 if the deadline passed during the reset
+    bool running = false;
+    uint32_t generation = 0;
+};
+
+// Mirrors the live timer into RTC slow memory (deadline kept on the RTC
+// counter, which keeps running through CPU and watchdog resets).
+void record(TimerState state, uint32_t setpoint_seconds, int64_t remaining_us, bool running);
+// True only after a warm reset with an intact, plausible mirror.
+bool restore(WarmState* out);
+
+}  // namespace dial::warm_restart
@@ -1,7 +1,16 @@
 #include "services/state_persistence.h"
 
+#include <algorithm>
+#include <cstddef>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <esp_log.h>
 #include <esp_check.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include <esp_timer.h>
 #include <nvs.h>
 #include <nvs_flash.h>
 
@@ -10,13 +19,42 @@ namespace dial::persistence {
 namespace {
 constexpr const char* TAG = "StatePersist";
 constexpr const char* kNamespace = "timer";
-constexpr const char* kKeyState = "state";
-constexpr const char* kKeySetpoint = "setpoint";
-constexpr const char* kKeyRemaining = "remain";
+constexpr const char* kKeyRecord = "snap";
+// Pre-v1 layout, read once for migration and then erased.
+constexpr const char* kLegacyKeyState = "state";
+constexpr const char* kLegacyKeySetpoint = "setpoint";
+constexpr const char* kLegacyKeyRemaining = "remain";
+constexpr uint8_t kRecordVersion = 1;
+constexpr uint32_t kEntriesPerWrite = 3;    // blob chunk header + one data entry + blob index
+constexpr uint32_t kDebounceMs = 1500;      // quiet time before writing
+constexpr uint32_t kMaxDeferMs = 10000;     // upper bound on unsaved changes
+constexpr uint32_t kRetryMinMs = 500;       // first retry after a failed write
+constexpr uint32_t kRetryMaxMs = 30000;     // backoff cap
 
 nvs_handle_t g_handle = 0;
 bool g_initialised = false;
 
+// Everything in one blob so a save is one atomic NVS write and a torn or
+// foreign record is caught by the CRC rather than restored half-updated.
+struct StateRecord {
+    uint8_t version;
+    uint8_t state;
+    uint16_t reserved;
+    uint32_t setpoint_seconds;
+    uint32_t remaining_ms;
+    uint32_t crc;  // CRC-32 (LE) over all preceding bytes
+};
+static_assert(sizeof(StateRecord) == 16, "StateRecord layout is persisted");
+
+TaskHandle_t g_writer_task = nullptr;
+SemaphoreHandle_t g_write_mutex = nullptr;
+portMUX_TYPE g_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+TimerSnapshot g_pending{};
+bool g_dirty = false;
+TimerSnapshot g_last_written{};
+bool g_has_written = false;
+PersistenceStats g_stats{};  // under g_pending_lock, which stats() takes
+
 uint8_t encode_state(TimerState state) {
     return static_cast<uint8_t>(state);
 }
@@ -28,6 +66,161 @@ TimerState decode_state(uint8_t raw) {
     return static_cast<TimerState>(raw);
 }
 
+uint32_t record_crc(const StateRecord& record) {
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&record), offsetof(StateRecord, crc));
+}
+
+StateRecord make_record(TimerState state, uint32_t setpoint_seconds, uint32_t remaining_ms) {
+    StateRecord record{};
+    record.version = kRecordVersion;
+    record.state = encode_state(state);
+    record.setpoint_seconds = setpoint_seconds;
+    record.remaining_ms = remaining_ms;
+    record.crc = record_crc(record);
+    return record;
+}
+
+bool same_record(const TimerSnapshot& a, const TimerSnapshot& b) {
+    return a.state == b.state && a.setpoint_seconds == b.setpoint_seconds && a.remaining_ms == b.remaining_ms;
+}
+
+esp_err_t write_record(const TimerSnapshot& snapshot) {
+    const int64_t start_us = esp_timer_get_time();
+    const StateRecord record = make_record(snapshot.state, snapshot.setpoint_seconds, snapshot.remaining_ms);
+    ESP_RETURN_ON_ERROR(nvs_set_blob(g_handle, kKeyRecord, &record, sizeof(record)), TAG, "set record failed");
+    ESP_RETURN_ON_ERROR(nvs_commit(g_handle), TAG, "commit failed");
+
+    const uint32_t elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    portENTER_CRITICAL(&g_pending_lock);
+    ++g_stats.commits;
+    g_stats.entries_written += kEntriesPerWrite;
+    g_stats.max_flush_us = elapsed_us > g_stats.max_flush_us ? elapsed_us : g_stats.max_flush_us;
+    portEXIT_CRITICAL(&g_pending_lock);
+    return ESP_OK;
+}
+
+// Writes the pending snapshot, if any. Serialised so the worker and a
+// shutdown flush never interleave NVS calls. A failed write puts the snapshot
+// back as pending unless a newer one arrived meanwhile.
+esp_err_t write_pending() {
+    xSemaphoreTake(g_write_mutex, portMAX_DELAY);
+
+    TimerSnapshot snapshot{};
+    bool dirty = false;
+    portENTER_CRITICAL(&g_pending_lock);
+    dirty = g_dirty;
+    snapshot = g_pending;
+    g_dirty = false;
+    portEXIT_CRITICAL(&g_pending_lock);
+
+    esp_err_t err = ESP_OK;
+    if (dirty) {
+        if (g_has_written && same_record(snapshot, g_last_written)) {
+            portENTER_CRITICAL(&g_pending_lock);
+            ++g_stats.unchanged_skipped;
+            portEXIT_CRITICAL(&g_pending_lock);
+        } else {
+            err = write_record(snapshot);
+            if (err == ESP_OK) {
+                g_last_written = snapshot;
+                g_has_written = true;
+            } else {
+                portENTER_CRITICAL(&g_pending_lock);
+                ++g_stats.failures;
+                if (!g_dirty) {
+                    g_pending = snapshot;
+                    g_dirty = true;
+                }
+                portEXIT_CRITICAL(&g_pending_lock);
+            }
+        }
+    }
+
+    xSemaphoreGive(g_write_mutex);
+    return err;
+}
+
+void writer_task(void*) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const int64_t first_dirty_us = esp_timer_get_time();
+
+        // Restart the debounce window on every new save, but never defer
+        // past kMaxDeferMs from the first one.
+        while (true) {
+            const int64_t deferred_ms = (esp_timer_get_time() - first_dirty_us) / 1000;
+            if (deferred_ms >= kMaxDeferMs) {
+                break;
+            }
+            const uint32_t wait_ms = std::min<uint32_t>(kDebounceMs, kMaxDeferMs - static_cast<uint32_t>(deferred_ms));
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) == 0) {
+                break;
+            }
+        }
+        // Retry a failed write with backoff; save() meanwhile only replaces
+        // the pending snapshot.
+        uint32_t backoff_ms = kRetryMinMs;
+        while (write_pending() != ESP_OK) {
+            vTaskDelay(pdMS_TO_TICKS(backoff_ms));
+            backoff_ms = std::min(backoff_ms * 2, kRetryMaxMs);
+        }
+    }
+}
+
+// Reads the three-key layout, rewrites it as a record and drops the old keys.
+esp_err_t migrate_legacy(RestoredState* out) {
+    uint8_t state_raw = 0;
+    uint32_t setpoint = 0;
+    uint32_t remaining = 0;
+
+    esp_err_t err = nvs_get_u8(g_handle, kLegacyKeyState, &state_raw);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_get_u32(g_handle, kLegacyKeySetpoint, &setpoint);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_get_u32(g_handle, kLegacyKeyRemaining, &remaining);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    out->state = decode_state(state_raw);
+    out->setpoint_seconds = setpoint;
+    out->remaining_ms = remaining;
+    out->valid = true;
+
+    const TimerSnapshot snapshot{
+        .state = out->state,
+        .setpoint_seconds = setpoint,
+        .remaining_seconds = remaining / 1000,
+        .remaining_ms = remaining,
+        .monotonic_us = 0,
+    };
+    xSemaphoreTake(g_write_mutex, portMAX_DELAY);
+    err = write_record(snapshot);
+    if (err == ESP_OK) {
+        g_last_written = snapshot;
+        g_has_written = true;
+        nvs_erase_key(g_handle, kLegacyKeyState);
+        nvs_erase_key(g_handle, kLegacyKeySetpoint);
+        nvs_erase_key(g_handle, kLegacyKeyRemaining);
+        err = nvs_commit(g_handle);
+    }
+    xSemaphoreGive(g_write_mutex);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Legacy state migration not written (%s)", esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "Migrated legacy state keys to record v%u", kRecordVersion);
+    }
+    return ESP_OK;
+}
+
+void flush_on_shutdown() {
+    flush();
+}
+
 }  // namespace
 
 esp_err_t init() {
@@ -35,6 +228,13 @@ esp_err_t init() {
         return ESP_OK;
     }
 
+    if (g_write_mutex == nullptr) {
+        g_write_mutex = xSemaphoreCreateMutex();
+        if (g_write_mutex == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     esp_err_t err = nvs_open(kNamespace, NVS_READWRITE, &g_handle);
     ESP_RETURN_ON_ERROR(err, TAG, "Failed to open NVS handle");
 
@@ -42,15 +242,68 @@ esp_err_t init() {
     return ESP_OK;
 }
 
+esp_err_t start() {
+    if (g_writer_task != nullptr) {
+        return ESP_OK;
+    }
+    if (!g_initialised) {
+        ESP_RETURN_ON_ERROR(init(), TAG, "NVS init failed");
+    }
+
+    const BaseType_t res = xTaskCreatePinnedToCore(
+        &writer_task,
+        "persist",
+        3072,
+        nullptr,
+        2,
+        &g_writer_task,
+        1);
+    if (res != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create persistence task");
+        g_writer_task = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = esp_register_shutdown_handler(&flush_on_shutdown);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Shutdown flush unavailable (%s)", esp_err_to_name(err));
+    }
+    return ESP_OK;
+}
+
 esp_err_t save(const TimerSnapshot& snapshot) {
     if (!g_initialised) {
         ESP_RETURN_ON_ERROR(init(), TAG, "NVS init failed");
     }
 
-    ESP_RETURN_ON_ERROR(nvs_set_u8(g_handle, kKeyState, encode_state(snapshot.state)), TAG, "set state failed");
-    ESP_RETURN_ON_ERROR(nvs_set_u32(g_handle, kKeySetpoint, snapshot.setpoint_seconds), TAG, "set setpoint failed");
-    ESP_RETURN_ON_ERROR(nvs_set_u32(g_handle, kKeyRemaining, snapshot.remaining_ms), TAG, "set remaining failed");
-    return nvs_commit(g_handle);
+    portENTER_CRITICAL(&g_pending_lock);
+    ++g_stats.requests;
+    if (g_dirty) {
+        ++g_stats.coalesced;
+    }
+    g_pending = snapshot;
+    g_dirty = true;
+    portEXIT_CRITICAL(&g_pending_lock);
+
+    if (g_writer_task == nullptr) {
+        return write_pending();
+    }
+    xTaskNotifyGive(g_writer_task);
+    return ESP_OK;
+}
+
+esp_err_t flush() {
+    if (!g_initialised) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return write_pending();
+}
+
+PersistenceStats stats() {
+    portENTER_CRITICAL(&g_pending_lock);
+    const PersistenceStats copy = g_stats;
+    portEXIT_CRITICAL(&g_pending_lock);
+    return copy;
 }
 
 esp_err_t load(RestoredState* out) {
@@ -65,27 +318,37 @@ esp_err_t load(RestoredState* out) {
         }
     }
 
-    uint8_t state_raw = 0;
-    uint32_t setpoint = 0;
-    uint32_t remaining = 0;
-
-    esp_err_t err = nvs_get_u8(g_handle, kKeyState, &state_raw);
-    if (err != ESP_OK) {
-        return err;
+    StateRecord record{};
+    size_t length = sizeof(record);
+    esp_err_t err = nvs_get_blob(g_handle, kKeyRecord, &record, &length);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return migrate_legacy(out);
     }
-    err = nvs_get_u32(g_handle, kKeySetpoint, &setpoint);
     if (err != ESP_OK) {
         return err;
     }
-    err = nvs_get_u32(g_handle, kKeyRemaining, &remaining);
-    if (err != ESP_OK) {
-        return err;
+    if (length != sizeof(record) || record.version != kRecordVersion) {
+        ESP_LOGW(TAG, "Ignoring state record v%u (%u bytes)", record.version, static_cast<unsigned>(length));
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (record.crc != record_crc(record)) {
+        ESP_LOGW(TAG, "State record CRC mismatch");
+        return ESP_ERR_INVALID_CRC;
     }
 
-    out->state = decode_state(state_raw);
-    out->setpoint_seconds = setpoint;
-    out->remaining_ms = remaining;
+    out->state = decode_state(record.state);
+    out->setpoint_seconds = record.setpoint_seconds;
+    out->remaining_ms = record.remaining_ms;
     out->valid = true;
+
+    g_last_written = TimerSnapshot{
+        .state = out->state,
+        .setpoint_seconds = record.setpoint_seconds,
+        .remaining_seconds = record.remaining_ms / 1000,
+        .remaining_ms = record.remaining_ms,
+        .monotonic_us = 0,
+    };
+    g_has_written = true;
     return ESP_OK;
 }
 
@@ -0,0 +1,101 @@
+#include "services/warm_restart.h"
+
+#include <cstddef>
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <esp_rtc_time.h>
+#include <esp_system.h>
+
+namespace dial::warm_restart {
+
+namespace {
+constexpr const char* TAG = "WarmRestart";
+constexpr uint32_t kMagic = 0x44494C31;  // "DIL1"
+
+struct Mirror {
+    uint32_t magic;
+    uint32_t generation;
+    uint8_t state;
+    uint8_t running;
+    uint16_t reserved;
+    uint32_t setpoint_seconds;
+    int64_t deadline_rtc_us;  // valid while running
+    int64_t frozen_us;        // valid while stopped
+    uint32_t crc;             // CRC-32 (LE) over all preceding bytes
+};
+
+RTC_NOINIT_ATTR Mirror g_mirror;
+uint32_t g_generation = 0;
+
+uint32_t mirror_crc(const Mirror& mirror) {
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&mirror), offsetof(Mirror, crc));
+}
+
+bool is_warm_reset(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_SW:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+        case ESP_RST_DEEPSLEEP:
+        case ESP_RST_BROWNOUT:  // RTC memory usually survives; the CRC decides
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+void record(TimerState state, uint32_t setpoint_seconds, int64_t remaining_us, bool running) {
+    Mirror next{};
+    next.magic = kMagic;
+    next.generation = ++g_generation;
+    next.state = static_cast<uint8_t>(state);
+    next.running = running ? 1 : 0;
+    next.setpoint_seconds = setpoint_seconds;
+    if (running) {
+        next.deadline_rtc_us = static_cast<int64_t>(esp_rtc_get_time_us()) + remaining_us;
+    } else {
+        next.frozen_us = remaining_us;
+    }
+    next.crc = mirror_crc(next);
+    // A reset mid-copy leaves a CRC mismatch, which restore() rejects.
+    g_mirror = next;
+}
+
+bool restore(WarmState* out) {
+    const esp_reset_reason_t reason = esp_reset_reason();
+    if (!is_warm_reset(reason)) {
+        return false;
+    }
+    const Mirror mirror = g_mirror;
+    if (mirror.magic != kMagic || mirror.crc != mirror_crc(mirror) ||
+        mirror.state > static_cast<uint8_t>(TimerState::Finished)) {
+        ESP_LOGW(TAG, "No usable RTC mirror after reset reason %d", static_cast<int>(reason));
+        return false;
+    }
+
+    const int64_t span_us = static_cast<int64_t>(mirror.setpoint_seconds) * 1'000'000;
+    const int64_t remaining_us = mirror.running
+                                     ? mirror.deadline_rtc_us - static_cast<int64_t>(esp_rtc_get_time_us())
+                                     : mirror.frozen_us;
+    if (remaining_us > span_us) {
+        // RTC counter restarted (e.g. a brownout that also reset the RTC domain).
+        ESP_LOGW(TAG, "RTC mirror deadline out of range, ignoring");
+        return false;
+    }
+
+    out->state = static_cast<TimerState>(mirror.state);
+    out->setpoint_seconds = mirror.setpoint_seconds;
+    out->remaining_us = remaining_us;
+    out->running = mirror.running != 0;
+    out->generation = mirror.generation;
+    g_generation = mirror.generation;
+    return true;
+}
+
+}  // namespace dial::warm_restart
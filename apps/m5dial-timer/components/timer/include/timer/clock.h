@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+// Monotonic time source injected into the platform-free timer core. The
+// firmware backs it with esp_timer_get_time(); host harnesses use a simulated
+// clock so multi-hour sessions run in seconds.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual int64_t now_us() const = 0;
+};
+
+}  // namespace dial
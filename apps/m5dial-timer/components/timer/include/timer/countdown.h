@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dial {
+
+// Deadline-based countdown. Remaining time is always derived from an absolute
+// monotonic deadline, so late or skipped wakeups never accumulate drift.
+// Platform-free: callers pass the current monotonic time in microseconds.
+class Countdown {
+public:
+    void start(int64_t now_us, int64_t duration_ms);
+    // Runs with an explicit remaining time; <= 0 means already expired.
+    void resume(int64_t now_us, int64_t remaining_us);
+    void stop(int64_t now_us);
+    void reset(int64_t duration_ms);
+
+    bool running() const { return running_; }
+    bool expired(int64_t now_us) const { return running_ && now_us >= deadline_us_; }
+    int64_t deadline_us() const { return deadline_us_; }
+    int64_t remaining_us(int64_t now_us) const {
+        if (!running_) {
+            return frozen_us_;
+        }
+        return deadline_us_ > now_us ? deadline_us_ - now_us : 0;
+    }
+    int64_t remaining_ms(int64_t now_us) const { return remaining_us(now_us) / 1000; }
+
+    // Absolute time of the next visible change: the displayed second rolling
+    // over or expiry. Colour thresholds are whole seconds, so they always fall
+    // on one of these boundaries. Returns -1 when not running.
+    int64_t next_boundary_us(int64_t now_us) const;
+
+    // Absolute time at which floor(remaining * steps / span) next decreases,
+    // for span-relative indicators such as the progress ring.
+    int64_t next_fraction_boundary_us(int64_t now_us, int64_t span_us, uint32_t steps) const;
+
+private:
+    int64_t deadline_us_ = 0;
+    int64_t frozen_us_ = 0;
+    bool running_ = false;
+};
+
+}  // namespace dial
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+#include "ringbuf/seqlock.h"
+#include "timer/timer_types.h"
+
+namespace dial {
+
+// Latest-value TimerSnapshot channel. The engine stores into a seqlock cell and
+// wakes every subscribed task with a direct task notification; any number of
+// readers copy the latest snapshot without queues or kernel critical sections.
+class SnapshotChannel {
+public:
+    static constexpr size_t kMaxSubscribers = 6;
+
+    // Registers a task to be notified (notification index 0) on every publish.
+    esp_err_t subscribe(TaskHandle_t task);
+    void publish(const TimerSnapshot& snapshot);
+
+    // Copies the latest snapshot; false if nothing was published yet.
+    bool latest(TimerSnapshot* out, uint32_t* generation = nullptr) const;
+
+    // Blocks the calling (subscribed) task until a snapshot newer than
+    // *generation is available, then updates *generation.
+    bool wait(TimerSnapshot* out, uint32_t* generation, TickType_t timeout = portMAX_DELAY) const;
+
+    uint32_t generation() const { return cell_.generation(); }
+
+private:
+    SeqlockCell<TimerSnapshot> cell_{};
+    std::array<std::atomic<TaskHandle_t>, kMaxSubscribers> subscribers_{};
+    std::atomic<uint32_t> subscriber_count_{0};
+};
+
+}  // namespace dial
@@ -1,9 +1,84 @@
 #pragma once
 
-#include "timer/timer_engine.h"
+#include <cstdint>
+
+#include "input/time_event.h"
+#include "timer/timer_types.h"
 
 namespace dial {
 
-TimerState determine_next_state(TimerState current, const TimeDeltaEvent& event, bool auto_start);
+// Event kinds the transition table is indexed by. Control events are split by
+// command so each press is its own column.
+enum class TimerInput : uint8_t {
+    Delta,
+    Commit,
+    ToggleRun,
+    Reset,
+    NoControl,
+    Boundary,
+};
+
+constexpr uint32_t kTimerStateCount = 5;
+constexpr uint32_t kTimerInputCount = 6;
+static_assert(static_cast<uint32_t>(TimerState::Finished) + 1 == kTimerStateCount, "table rows");
+static_assert(static_cast<uint32_t>(TimerInput::Boundary) + 1 == kTimerInputCount, "table columns");
+// timer_input() names every event type and command; a new one must be mapped there.
+static_assert(static_cast<uint32_t>(TimeEventType::Boundary) + 1 == 4, "unmapped TimeEventType");
+static_assert(static_cast<uint32_t>(ControlCommand::Reset) + 1 == 3, "unmapped ControlCommand");
+
+// Guard conditions, sampled before any action runs.
+constexpr uint8_t kGuardTotalNonZero = 1u << 0;     // event.total_seconds != 0
+constexpr uint8_t kGuardTotalPositive = 1u << 1;    // event.total_seconds > 0
+constexpr uint8_t kGuardDeltaNonZero = 1u << 2;     // event.delta_seconds != 0
+constexpr uint8_t kGuardSetpointNonZero = 1u << 3;  // engine setpoint before the event
+constexpr uint8_t kGuardAutoStart = 1u << 4;        // TimerEngineConfig::auto_start
+constexpr uint8_t kGuardExpired = 1u << 5;          // countdown running and past its deadline
+constexpr uint8_t kGuardResidual = 1u << 6;         // countdown has time left (running or frozen)
+constexpr uint32_t kTimerGuardBits = 7;
+
+// Actions, applied in this order: setpoint first, then countdown, then storage.
+constexpr uint8_t kActionApplyDelta = 1u << 0;     // setpoint += delta, clamped
+constexpr uint8_t kActionClearSetpoint = 1u << 1;  // setpoint = 0
+constexpr uint8_t kActionStart = 1u << 2;          // start countdown from the setpoint
+constexpr uint8_t kActionStop = 1u << 3;           // reset countdown to the setpoint
+constexpr uint8_t kActionPersist = 1u << 4;        // write snapshot to storage
+
+struct TimerTransition {
+    TimerState next;
+    uint8_t actions;
+};
+
+// Out-of-range values (a corrupted event) map to NoControl, which changes nothing.
+constexpr TimerInput timer_input(const TimeDeltaEvent& event) {
+    switch (event.type) {
+        case TimeEventType::Delta: return TimerInput::Delta;
+        case TimeEventType::Commit: return TimerInput::Commit;
+        case TimeEventType::Boundary: return TimerInput::Boundary;
+        case TimeEventType::Control:
+            switch (event.control) {
+                case ControlCommand::None: return TimerInput::NoControl;
+                case ControlCommand::ToggleRun: return TimerInput::ToggleRun;
+                case ControlCommand::Reset: return TimerInput::Reset;
+            }
+            return TimerInput::NoControl;
+    }
+    return TimerInput::NoControl;
+}
+
+constexpr uint8_t timer_guards(const TimeDeltaEvent& event, uint32_t setpoint_seconds, bool auto_start,
+                               bool expired, bool residual) {
+    return static_cast<uint8_t>(
+        (event.total_seconds != 0 ? kGuardTotalNonZero : 0) |
+        (event.total_seconds > 0 ? kGuardTotalPositive : 0) |
+        (event.delta_seconds != 0 ? kGuardDeltaNonZero : 0) |
+        (setpoint_seconds != 0 ? kGuardSetpointNonZero : 0) |
+        (auto_start ? kGuardAutoStart : 0) |
+        (expired ? kGuardExpired : 0) |
+        (residual ? kGuardResidual : 0));
+}
+
+// Single table lookup; the table is generated at compile time from the rule
+// list in state_machine.cpp.
+TimerTransition next_transition(TimerState current, TimerInput input, uint8_t guards);
 
 }  // namespace dial
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+#include "input/time_event.h"
+#include "timer/clock.h"
+#include "timer/countdown.h"
+#include "timer/timer_types.h"
+
+namespace dial {
+
+struct TimerEngineConfig {
+    uint32_t max_total_seconds = 6 * 3600;
+    bool auto_start = true;
+    bool interpolate_subsecond = false;  // also wake on progress-ring degree steps
+};
+
+// What the platform shell has to do after the core consumed an event.
+struct TimerEffects {
+    bool persist = false;  // snapshot should be written to storage
+};
+
+// Platform-free countdown and state logic. Owns the setpoint, state and
+// deadline; the caller feeds it events, arms a wakeup at next_wakeup_us() and
+// posts a Boundary event when that wakeup fires.
+class TimerCore {
+public:
+    void init(const TimerEngineConfig& config, const Clock& clock);
+    void restore(TimerState state, uint32_t setpoint_seconds, uint32_t remaining_ms);
+    // Continues a countdown that was running before a warm reset.
+    void resume(uint32_t setpoint_seconds, int64_t remaining_us);
+
+    TimerEffects handle(const TimeDeltaEvent& event);
+
+    // Folds `next` into the not yet handled `pending` when both are Delta
+    // events: deltas add up and the later total/multiplier win. Only folds
+    // when handling the sum lands where handling both would: the state is
+    // Idle or Editing, neither event reaches a limit (total 0 or
+    // max_total_seconds, where the transition or the clamp differs) and the
+    // sum is not a zero delta.
+    bool fold_delta(TimeDeltaEvent* pending, const TimeDeltaEvent& next) const;
+
+    // Absolute time of the next countdown boundary, or -1 when none is due.
+    int64_t next_wakeup_us() const;
+
+    TimerSnapshot snapshot() const;
+    // Returns true (and the snapshot) if it differs visibly from the last one
+    // taken through this call.
+    bool take_visible_change(TimerSnapshot* out);
+
+    TimerState state() const { return state_; }
+    uint32_t setpoint_seconds() const { return setpoint_seconds_; }
+    const Countdown& countdown() const { return countdown_; }
+    const TimerEngineConfig& config() const { return config_; }
+
+private:
+    uint32_t clamped_setpoint(int32_t delta_seconds) const;
+
+    TimerEngineConfig config_{};
+    const Clock* clock_ = nullptr;
+
+    TimerState state_ = TimerState::Idle;
+    uint32_t setpoint_seconds_ = 15 * 60;
+    Countdown countdown_{};
+    bool has_published_ = false;
+    TimerSnapshot last_published_{};
+};
+
+}  // namespace dial
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include "freertos/FreeRTOS.h"
@@ -7,45 +8,103 @@
 #include "esp_err.h"
 #include "esp_timer.h"
 
-#include "input/time_selector.h"
+#include "input/time_event.h"
+#include "ringbuf/mpsc_ring.h"
+#include "ringbuf/notified_ring.h"
+#include "ringbuf/seqlock.h"
+#include "ringbuf/task_notify_waker.h"
+#include "timer/clock.h"
+#include "timer/snapshot_channel.h"
+#include "timer/timer_core.h"
 #include "timer/timer_types.h"
 
 namespace dial {
 
-struct TimerEngineConfig {
-    uint32_t max_total_seconds = 6 * 3600;
-    uint32_t snapshot_hz = 30;
-    bool auto_start = true;
+class EspTimerClock : public Clock {
+public:
+    int64_t now_us() const override { return esp_timer_get_time(); }
+};
+
+enum class RestoreSource : uint8_t {
+    Defaults,
+    Nvs,  // cold boot: persisted snapshot, countdown demoted to Editing
+    Rtc,  // warm reset: RTC mirror, countdown keeps running
 };
 
+// FreeRTOS/esp_timer shell around TimerCore: owns the input channels, the
+// boundary timer, persistence and snapshot publication. Knob events arrive on
+// a lock-free ring written by the encoder reader task (deltas) and the
+// selector's commit timer, which latches its commit in a seqlock cell when
+// the ring is full; touch, control and boundary events share a queue. Every
+// producer notifies the engine task.
+
 class TimerEngine {
 public:
     TimerEngine() = default;
     esp_err_t init(const TimerEngineConfig& config);
     void start();
 
-    QueueHandle_t snapshot_queue() const { return snapshot_queue_; }
+    SnapshotChannel& snapshots() { return snapshot_channel_; }
+    const TimerEngineConfig& config() const { return config_; }
+    // TimeSelector's sink: deltas from the encoder reader task (waits while
+    // the ring is full), commits from the esp_timer task (never blocks).
+    void post_selector_event(const TimeDeltaEvent& event);
     void enqueue_time_delta(const TimeDeltaEvent& event);
     void enqueue_control(ControlCommand command);
     void enqueue_quick_delta(int32_t delta_seconds);
+    uint32_t timer_wakeups() const { return timer_wakeups_; }
+    uint32_t snapshots_published() const { return snapshots_published_; }
+    uint32_t events_received() const { return events_received_; }
+    uint32_t events_batched() const { return events_batched_; }  // folded into a preceding delta
+    uint32_t events_applied() const { return events_applied_; }
+    uint32_t ring_full_waits() const { return ring_full_waits_.load(std::memory_order_relaxed); }
+    uint32_t commits_latched() const { return commits_latched_.load(std::memory_order_relaxed); }  // ring was full
+    RestoreSource restore_source() const { return restore_source_; }
+    uint32_t restore_us() const { return restore_us_; }
 
 private:
     static void timer_callback(void* arg);
     static void task_entry(void* arg);
 
     void run();
+    void wake();
+    void post_commit(const TimeDeltaEvent& event);
+    bool next_event(TimeDeltaEvent* out);
+    void apply_batch(const TimeDeltaEvent& first);
+    bool apply(const TimeDeltaEvent& event);
     void publish_snapshot();
     void on_tick();
+    void arm_next_boundary();
+    void restore_state();
+    void mirror_state();
 
     TimerEngineConfig config_{};
+    EspTimerClock clock_{};
+    TimerCore core_{};
     esp_timer_handle_t esp_timer_ = nullptr;
-    QueueHandle_t snapshot_queue_ = nullptr;
+    SnapshotChannel snapshot_channel_{};
     QueueHandle_t delta_queue_ = nullptr;
+    NotifiedRing<MpscRing<TimeDeltaEvent, 32>, TaskNotifyWaker> selector_ring_{};
+    SeqlockCell<TimeDeltaEvent> latched_commit_{};  // written by the commit timer only
+    std::atomic<uint32_t> commit_taken_{0};         // generation of the last latched commit applied
     TaskHandle_t task_handle_ = nullptr;
 
-    TimerState state_ = TimerState::Idle;
-    uint32_t setpoint_seconds_ = 15 * 60;
-    int64_t remaining_ms_ = static_cast<int64_t>(15 * 60 * 1000);
+    std::atomic<int64_t> armed_wakeup_us_{-1};
+    uint32_t timer_wakeups_ = 0;
+    uint32_t snapshots_published_ = 0;
+    uint32_t events_received_ = 0;
+    uint32_t events_batched_ = 0;
+    uint32_t events_applied_ = 0;
+    std::atomic<uint32_t> ring_full_waits_{0};
+    std::atomic<uint32_t> commits_latched_{0};
+
+    RestoreSource restore_source_ = RestoreSource::Defaults;
+    uint32_t restore_us_ = 0;
+    TimerState mirrored_state_ = TimerState::Idle;
+    uint32_t mirrored_setpoint_ = 0;
+    int64_t mirrored_deadline_us_ = -1;
+    bool mirrored_running_ = false;
+    bool has_mirrored_ = false;
 };
 
 extern TimerEngine g_timer_engine;
@@ -20,4 +20,17 @@ struct TimerSnapshot {
     uint64_t monotonic_us = 0;
 };
 
+constexpr uint32_t kProgressArcSteps = 360;
+
+// Progress ring position in whole degrees. Shared by the UI and the engine's
+// change detection so a snapshot is only published when the ring would move.
+inline uint32_t progress_arc_step(const TimerSnapshot& snapshot) {
+    if (snapshot.setpoint_seconds == 0) {
+        return 0;
+    }
+    const uint64_t total_ms = static_cast<uint64_t>(snapshot.setpoint_seconds) * 1000ULL;
+    const uint64_t step = (static_cast<uint64_t>(kProgressArcSteps) * snapshot.remaining_ms) / total_ms;
+    return static_cast<uint32_t>(step > kProgressArcSteps ? kProgressArcSteps : step);
+}
+
 }  // namespace dial
@@ -0,0 +1,63 @@
+#include "timer/countdown.h"
+
+#include <algorithm>
+
+namespace dial {
+
+namespace {
+constexpr int64_t kUsPerSecond = 1'000'000;
+}  // namespace
+
+void Countdown::start(int64_t now_us, int64_t duration_ms) {
+    deadline_us_ = now_us + std::max<int64_t>(0, duration_ms) * 1000;
+    frozen_us_ = 0;
+    running_ = true;
+}
+
+void Countdown::resume(int64_t now_us, int64_t remaining_us) {
+    deadline_us_ = now_us + remaining_us;
+    frozen_us_ = 0;
+    running_ = true;
+}
+
+void Countdown::stop(int64_t now_us) {
+    if (!running_) {
+        return;
+    }
+    frozen_us_ = remaining_us(now_us);
+    running_ = false;
+}
+
+void Countdown::reset(int64_t duration_ms) {
+    frozen_us_ = std::max<int64_t>(0, duration_ms) * 1000;
+    deadline_us_ = 0;
+    running_ = false;
+}
+
+int64_t Countdown::next_boundary_us(int64_t now_us) const {
+    if (!running_) {
+        return -1;
+    }
+    // The displayed value is floor(remaining / 1 s); it drops from s to s - 1
+    // on the first microsecond where remaining < s seconds.
+    const int64_t seconds = remaining_us(now_us) / kUsPerSecond;
+    if (seconds == 0) {
+        return deadline_us_;
+    }
+    return deadline_us_ - seconds * kUsPerSecond + 1;
+}
+
+int64_t Countdown::next_fraction_boundary_us(int64_t now_us, int64_t span_us, uint32_t steps) const {
+    if (!running_ || span_us <= 0 || steps == 0) {
+        return -1;
+    }
+    const int64_t step = remaining_us(now_us) * steps / span_us;
+    if (step == 0) {
+        return deadline_us_;
+    }
+    // Largest remaining value that maps to step - 1.
+    const int64_t threshold_us = (step * span_us + steps - 1) / steps - 1;
+    return deadline_us_ - threshold_us;
+}
+
+}  // namespace dial
@@ -0,0 +1,68 @@
+#include "timer/snapshot_channel.h"
+
+#include <algorithm>
+
+#include <esp_log.h>
+
+namespace dial {
+
+namespace {
+constexpr const char* TAG = "SnapshotChannel";
+constexpr int kSpinsBeforeSleep = 64;
+}  // namespace
+
+esp_err_t SnapshotChannel::subscribe(TaskHandle_t task) {
+    if (task == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint32_t slot = subscriber_count_.fetch_add(1, std::memory_order_acq_rel);
+    if (slot >= kMaxSubscribers) {
+        subscriber_count_.fetch_sub(1, std::memory_order_acq_rel);
+        ESP_LOGE(TAG, "Subscriber limit (%u) reached", static_cast<unsigned>(kMaxSubscribers));
+        return ESP_ERR_NO_MEM;
+    }
+    subscribers_[slot].store(task, std::memory_order_release);
+    return ESP_OK;
+}
+
+void SnapshotChannel::publish(const TimerSnapshot& snapshot) {
+    cell_.store(snapshot);
+
+    const uint32_t count = std::min<uint32_t>(subscriber_count_.load(std::memory_order_acquire), kMaxSubscribers);
+    for (uint32_t i = 0; i < count; ++i) {
+        TaskHandle_t task = subscribers_[i].load(std::memory_order_acquire);
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+}
+
+bool SnapshotChannel::latest(TimerSnapshot* out, uint32_t* generation) const {
+    if (out == nullptr || cell_.generation() == 0) {
+        return false;
+    }
+    // A writer preempted mid-store on this core would starve a spinning
+    // reader, so back off to the scheduler after a short spin.
+    int spins = 0;
+    while (!cell_.try_load(out, generation)) {
+        if (++spins >= kSpinsBeforeSleep) {
+            vTaskDelay(1);
+            spins = 0;
+        }
+    }
+    return true;
+}
+
+bool SnapshotChannel::wait(TimerSnapshot* out, uint32_t* generation, TickType_t timeout) const {
+    if (out == nullptr || generation == nullptr) {
+        return false;
+    }
+    while (cell_.generation() == *generation) {
+        if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+            return false;
+        }
+    }
+    return latest(out, generation);
+}
+
+}  // namespace dial
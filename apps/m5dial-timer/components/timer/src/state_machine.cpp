@@ -1,42 +1,160 @@
 #include "timer/state_machine.h"
 
+#include <array>
+#include <cstddef>
+
 namespace dial {
 
-TimerState determine_next_state(TimerState current, const TimeDeltaEvent& event, bool auto_start) {
-    if (event.type == TimeEventType::Commit) {
-        if (event.total_seconds == 0) {
-            return TimerState::Idle;
-        }
-        if (!auto_start) {
-            return TimerState::Arming;
+namespace {
+
+constexpr uint8_t kAnyState = 0xFF;
+constexpr uint8_t kStay = 0xFF;
+
+// One row per transition; the first row matching (state, input, guards) wins.
+// A row matches when (guards & guard_mask) == guard_value.
+struct TimerRule {
+    uint8_t state;
+    TimerInput input;
+    uint8_t guard_mask;
+    uint8_t guard_value;
+    uint8_t next;
+    uint8_t actions;
+};
+
+constexpr uint8_t id(TimerState state) {
+    return static_cast<uint8_t>(state);
+}
+
+constexpr uint8_t kEditDelta = kActionApplyDelta | kActionStop;
+
+constexpr TimerRule kTimerRules[] = {
+    // Knob/touch deltas always stop the countdown; reaching zero while
+    // counting finishes the timer.
+    {id(TimerState::Idle), TimerInput::Delta, kGuardTotalPositive | kGuardDeltaNonZero,
+     kGuardTotalPositive | kGuardDeltaNonZero, id(TimerState::Editing), kEditDelta},
+    {id(TimerState::Idle), TimerInput::Delta, 0, 0, kStay, kEditDelta},
+    {id(TimerState::Editing), TimerInput::Delta, kGuardTotalNonZero, 0, id(TimerState::Idle), kEditDelta},
+    {id(TimerState::Editing), TimerInput::Delta, 0, 0, id(TimerState::Editing), kEditDelta},
+    {id(TimerState::Arming), TimerInput::Delta, kGuardTotalNonZero, 0, id(TimerState::Idle), kEditDelta},
+    {id(TimerState::Arming), TimerInput::Delta, 0, 0, id(TimerState::Editing), kEditDelta},
+    {id(TimerState::Counting), TimerInput::Delta, kGuardTotalNonZero, 0, id(TimerState::Finished),
+     kEditDelta | kActionPersist},
+    {id(TimerState::Counting), TimerInput::Delta, 0, 0, id(TimerState::Editing), kEditDelta},
+    {id(TimerState::Finished), TimerInput::Delta, kGuardTotalPositive, kGuardTotalPositive,
+     id(TimerState::Editing), kEditDelta},
+    {id(TimerState::Finished), TimerInput::Delta, 0, 0, kStay, kEditDelta | kActionPersist},
+
+    // Commit from the selector, in any state.
+    {kAnyState, TimerInput::Commit, kGuardTotalNonZero, 0, id(TimerState::Idle), kActionStop | kActionPersist},
+    {kAnyState, TimerInput::Commit, kGuardAutoStart, 0, id(TimerState::Arming), kActionStop | kActionPersist},
+    {kAnyState, TimerInput::Commit, kGuardSetpointNonZero, kGuardSetpointNonZero, id(TimerState::Counting),
+     kActionStart | kActionPersist},
+    {kAnyState, TimerInput::Commit, 0, 0, id(TimerState::Counting), kActionStop | kActionPersist},
+
+    // Start/stop button.
+    {id(TimerState::Counting), TimerInput::ToggleRun, 0, 0, id(TimerState::Editing), kActionStop | kActionPersist},
+    {kAnyState, TimerInput::ToggleRun, kGuardSetpointNonZero, kGuardSetpointNonZero, id(TimerState::Counting),
+     kActionStart | kActionPersist},
+    {kAnyState, TimerInput::ToggleRun, 0, 0, kStay, 0},
+
+    // Reset is a no-op only when there is nothing left to clear.
+    {id(TimerState::Idle), TimerInput::Reset, kGuardSetpointNonZero | kGuardResidual, 0, kStay, 0},
+    {kAnyState, TimerInput::Reset, 0, 0, id(TimerState::Idle), kActionClearSetpoint | kActionStop | kActionPersist},
+
+    {kAnyState, TimerInput::NoControl, 0, 0, kStay, 0},
+
+    // Countdown wakeups only matter once the deadline has passed.
+    {id(TimerState::Counting), TimerInput::Boundary, kGuardExpired, kGuardExpired, id(TimerState::Finished),
+     kActionClearSetpoint | kActionStop | kActionPersist},
+    {kAnyState, TimerInput::Boundary, 0, 0, kStay, 0},
+};
+
+constexpr size_t kRuleCount = sizeof(kTimerRules) / sizeof(kTimerRules[0]);
+constexpr uint32_t kGuardCombos = 1u << kTimerGuardBits;
+constexpr uint32_t kTableSize = kTimerStateCount * kTimerInputCount * kGuardCombos;
+
+// Packed cell: next state in bits 0-2, actions in bits 3-7.
+constexpr uint8_t kUncovered = 0x07;
+
+constexpr uint32_t table_index(uint32_t state, uint32_t input, uint32_t guards) {
+    return ((state * kTimerInputCount + input) << kTimerGuardBits) | guards;
+}
+
+constexpr int first_match(uint32_t state, uint32_t input, uint32_t guards) {
+    for (size_t i = 0; i < kRuleCount; ++i) {
+        const TimerRule& rule = kTimerRules[i];
+        if ((rule.state == kAnyState || rule.state == state) &&
+            static_cast<uint32_t>(rule.input) == input &&
+            (guards & rule.guard_mask) == rule.guard_value) {
+            return static_cast<int>(i);
         }
-        return TimerState::Counting;
     }
+    return -1;
+}
 
-    switch (current) {
-        case TimerState::Idle:
-            if (event.delta_seconds != 0 && event.total_seconds > 0) {
-                return TimerState::Editing;
+constexpr std::array<uint8_t, kTableSize> build_table() {
+    std::array<uint8_t, kTableSize> table{};
+    for (uint32_t state = 0; state < kTimerStateCount; ++state) {
+        for (uint32_t input = 0; input < kTimerInputCount; ++input) {
+            for (uint32_t guards = 0; guards < kGuardCombos; ++guards) {
+                const int rule = first_match(state, input, guards);
+                uint8_t cell = kUncovered;
+                if (rule >= 0) {
+                    const TimerRule& r = kTimerRules[rule];
+                    const uint8_t next = r.next == kStay ? static_cast<uint8_t>(state) : r.next;
+                    cell = static_cast<uint8_t>(next | (r.actions << 3));
+                }
+                table[table_index(state, input, guards)] = cell;
             }
-            break;
-        case TimerState::Editing:
-        case TimerState::Arming:
-            if (event.total_seconds == 0) {
-                return TimerState::Idle;
-            }
-            return TimerState::Editing;
-        case TimerState::Counting:
-            if (event.total_seconds == 0) {
-                return TimerState::Finished;
-            }
-            return TimerState::Editing;  // knob movement interrupts countdown
-        case TimerState::Finished:
-            if (event.total_seconds > 0) {
-                return TimerState::Editing;
+        }
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, kTableSize> kTransitionTable = build_table();
+
+constexpr bool all_covered() {
+    for (uint8_t cell : kTransitionTable) {
+        if (cell == kUncovered) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool all_rules_reachable() {
+    bool used[kRuleCount] = {};
+    for (uint32_t state = 0; state < kTimerStateCount; ++state) {
+        for (uint32_t input = 0; input < kTimerInputCount; ++input) {
+            for (uint32_t guards = 0; guards < kGuardCombos; ++guards) {
+                const int rule = first_match(state, input, guards);
+                if (rule >= 0) {
+                    used[rule] = true;
+                }
             }
-            break;
+        }
+    }
+    for (bool u : used) {
+        if (!u) {
+            return false;
+        }
     }
-    return current;
+    return true;
+}
+
+static_assert(all_covered(), "every (state, input, guards) cell needs a transition rule");
+static_assert(all_rules_reachable(), "a transition rule is shadowed by an earlier one");
+static_assert(kActionPersist << 3 <= 0xFF, "actions must fit the packed cell");
+
+}  // namespace
+
+TimerTransition next_transition(TimerState current, TimerInput input, uint8_t guards) {
+    const uint8_t cell = kTransitionTable[table_index(static_cast<uint32_t>(current), static_cast<uint32_t>(input),
+                                                      guards & (kGuardCombos - 1))];
+    return TimerTransition{
+        .next = static_cast<TimerState>(cell & 0x07),
+        .actions = static_cast<uint8_t>(cell >> 3),
+    };
 }
 
 }  // namespace dial
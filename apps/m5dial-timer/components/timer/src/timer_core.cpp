@@ -0,0 +1,150 @@
+#include "timer/timer_core.h"
+
+#include <algorithm>
+
+#include "timer/state_machine.h"
+
+namespace dial {
+
+namespace {
+
+bool is_visible_change(const TimerSnapshot& previous, const TimerSnapshot& next) {
+    return previous.state != next.state ||
+           previous.setpoint_seconds != next.setpoint_seconds ||
+           previous.remaining_seconds != next.remaining_seconds ||
+           progress_arc_step(previous) != progress_arc_step(next);
+}
+
+}  // namespace
+
+void TimerCore::init(const TimerEngineConfig& config, const Clock& clock) {
+    config_ = config;
+    clock_ = &clock;
+
+    state_ = TimerState::Idle;
+    setpoint_seconds_ = std::min(config_.max_total_seconds, static_cast<uint32_t>(15 * 60));
+    countdown_.reset(static_cast<int64_t>(setpoint_seconds_) * 1000);
+    has_published_ = false;
+}
+
+void TimerCore::restore(TimerState state, uint32_t setpoint_seconds, uint32_t remaining_ms) {
+    setpoint_seconds_ = std::min(setpoint_seconds, config_.max_total_seconds);
+    countdown_.reset(std::min<int64_t>(static_cast<int64_t>(remaining_ms), static_cast<int64_t>(setpoint_seconds_) * 1000));
+    if (setpoint_seconds_ == 0) {
+        state_ = TimerState::Idle;
+    } else if (state == TimerState::Counting || state == TimerState::Arming) {
+        state_ = TimerState::Editing;
+    } else {
+        state_ = state;
+    }
+}
+
+void TimerCore::resume(uint32_t setpoint_seconds, int64_t remaining_us) {
+    setpoint_seconds_ = std::min(setpoint_seconds, config_.max_total_seconds);
+    if (setpoint_seconds_ == 0) {
+        state_ = TimerState::Idle;
+        countdown_.reset(0);
+        return;
+    }
+    state_ = TimerState::Counting;
+    countdown_.resume(clock_->now_us(), std::min<int64_t>(remaining_us, static_cast<int64_t>(setpoint_seconds_) * 1'000'000));
+}
+
+TimerEffects TimerCore::handle(const TimeDeltaEvent& event) {
+    const int64_t now_us = clock_->now_us();
+    const uint8_t guards = timer_guards(event, setpoint_seconds_, config_.auto_start,
+                                        countdown_.expired(now_us), countdown_.remaining_us(now_us) != 0);
+    const TimerTransition transition = next_transition(state_, timer_input(event), guards);
+
+    const uint8_t actions = transition.actions;
+    if (actions & (kActionApplyDelta | kActionClearSetpoint)) {
+        setpoint_seconds_ = (actions & kActionClearSetpoint) ? 0 : clamped_setpoint(event.delta_seconds);
+    }
+    if (actions & kActionStart) {
+        countdown_.start(now_us, static_cast<int64_t>(setpoint_seconds_) * 1000);
+    } else if (actions & kActionStop) {
+        countdown_.reset(static_cast<int64_t>(setpoint_seconds_) * 1000);
+    }
+    state_ = transition.next;
+
+    TimerEffects effects{};
+    effects.persist = (transition.actions & kActionPersist) != 0;
+    return effects;
+}
+
+bool TimerCore::fold_delta(TimeDeltaEvent* pending, const TimeDeltaEvent& next) const {
+    if (pending->type != TimeEventType::Delta || next.type != TimeEventType::Delta) {
+        return false;
+    }
+    // Counting, Arming and Finished leave on the first delta; from Idle and
+    // Editing only reaching zero does.
+    if (state_ != TimerState::Idle && state_ != TimerState::Editing) {
+        return false;
+    }
+    const auto max_total = static_cast<int64_t>(config_.max_total_seconds);
+    const int64_t after_pending = static_cast<int64_t>(setpoint_seconds_) + pending->delta_seconds;
+    if (pending->total_seconds <= 0 || pending->total_seconds >= max_total || next.total_seconds <= 0 ||
+        after_pending <= 0 || after_pending >= max_total) {
+        return false;
+    }
+    const int64_t folded = static_cast<int64_t>(pending->delta_seconds) + static_cast<int64_t>(next.delta_seconds);
+    if (folded == 0 || folded > INT32_MAX || folded < INT32_MIN) {
+        return false;
+    }
+    pending->delta_seconds = static_cast<int32_t>(folded);
+    pending->total_seconds = next.total_seconds;
+    pending->timestamp_us = next.timestamp_us;
+    pending->multiplier = next.multiplier;
+    return true;
+}
+
+uint32_t TimerCore::clamped_setpoint(int32_t delta_seconds) const {
+    int64_t updated = static_cast<int64_t>(setpoint_seconds_) + static_cast<int64_t>(delta_seconds);
+    updated = std::max<int64_t>(
+        0,
+        std::min<int64_t>(updated, static_cast<int64_t>(config_.max_total_seconds)));
+    return static_cast<uint32_t>(updated);
+}
+
+int64_t TimerCore::next_wakeup_us() const {
+    const int64_t now_us = clock_->now_us();
+    int64_t boundary_us = countdown_.next_boundary_us(now_us);
+    if (boundary_us < 0) {
+        return -1;
+    }
+    if (config_.interpolate_subsecond) {
+        const int64_t span_us = static_cast<int64_t>(setpoint_seconds_) * 1'000'000;
+        const int64_t arc_us = countdown_.next_fraction_boundary_us(now_us, span_us, kProgressArcSteps);
+        if (arc_us >= 0) {
+            boundary_us = std::min(boundary_us, arc_us);
+        }
+    }
+    return boundary_us;
+}
+
+TimerSnapshot TimerCore::snapshot() const {
+    const int64_t now_us = clock_->now_us();
+    const int64_t remaining_ms = countdown_.remaining_ms(now_us);
+    return TimerSnapshot{
+        .state = state_,
+        .setpoint_seconds = setpoint_seconds_,
+        .remaining_seconds = static_cast<uint32_t>(remaining_ms / 1000),
+        .remaining_ms = static_cast<uint32_t>(remaining_ms),
+        .monotonic_us = static_cast<uint64_t>(now_us),
+    };
+}
+
+bool TimerCore::take_visible_change(TimerSnapshot* out) {
+    const TimerSnapshot current = snapshot();
+    if (has_published_ && !is_visible_change(last_published_, current)) {
+        return false;
+    }
+    last_published_ = current;
+    has_published_ = true;
+    if (out != nullptr) {
+        *out = current;
+    }
+    return true;
+}
+
+}  // namespace dial
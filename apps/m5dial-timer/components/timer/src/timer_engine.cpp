@@ -6,14 +6,20 @@
 #include <esp_log.h>
 #include <esp_check.h>
 
-#include "timer/state_machine.h"
 #include "services/state_persistence.h"
+#include "services/warm_restart.h"
 
 namespace dial {
 
 namespace {
 constexpr const char* TAG = "TimerEngine";
-constexpr uint32_t kTimerPeriodUs = 1000;  // 1 ms
+constexpr int64_t kMinArmDelayUs = 50;  // esp_timer rejects shorter one-shots
+constexpr UBaseType_t kQueueLength = 16;
+constexpr UBaseType_t kMaxBatch = kQueueLength;  // bounds latency under a sustained spin
+
+bool is_reset(const TimeDeltaEvent& event) {
+    return event.type == TimeEventType::Control && event.control == ControlCommand::Reset;
+}
 }  // namespace
 
 TimerEngine g_timer_engine;
@@ -21,16 +27,8 @@ TimerEngine g_timer_engine;
 esp_err_t TimerEngine::init(const TimerEngineConfig& config) {
     config_ = config;
 
-    if (snapshot_queue_ == nullptr) {
-        snapshot_queue_ = xQueueCreate(1, sizeof(TimerSnapshot));
-        if (snapshot_queue_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to create snapshot queue");
-            return ESP_ERR_NO_MEM;
-        }
-    }
-
     if (delta_queue_ == nullptr) {
-        delta_queue_ = xQueueCreate(16, sizeof(TimeDeltaEvent));
+        delta_queue_ = xQueueCreate(kQueueLength, sizeof(TimeDeltaEvent));
         if (delta_queue_ == nullptr) {
             ESP_LOGE(TAG, "Failed to create delta queue");
             return ESP_ERR_NO_MEM;
@@ -48,26 +46,36 @@ esp_err_t TimerEngine::init(const TimerEngineConfig& config) {
         ESP_RETURN_ON_ERROR(esp_timer_create(&args, &esp_timer_), TAG, "esp_timer_create failed");
     }
 
-    state_ = TimerState::Idle;
-    setpoint_seconds_ = std::min(config_.max_total_seconds, static_cast<uint32_t>(15 * 60));
-    remaining_ms_ = static_cast<int64_t>(setpoint_seconds_) * 1000;
+    core_.init(config_, clock_);
+    restore_state();
+    mirror_state();
+    arm_next_boundary();
+    publish_snapshot();
 
+    return ESP_OK;
+}
+
+void TimerEngine::restore_state() {
+    const int64_t start_us = esp_timer_get_time();
+
+    warm_restart::WarmState warm;
     persistence::RestoredState restored;
-    if (persistence::load(&restored) == ESP_OK && restored.valid) {
-        setpoint_seconds_ = std::min(restored.setpoint_seconds, config_.max_total_seconds);
-        remaining_ms_ = std::min<int64_t>(static_cast<int64_t>(restored.remaining_ms), static_cast<int64_t>(setpoint_seconds_) * 1000);
-        if (setpoint_seconds_ == 0) {
-            state_ = TimerState::Idle;
-        } else if (restored.state == TimerState::Counting || restored.state == TimerState::Arming) {
-            state_ = TimerState::Editing;
+    if (warm_restart::restore(&warm)) {
+        if (warm.running) {
+            core_.resume(warm.setpoint_seconds, warm.remaining_us);
         } else {
-            state_ = restored.state;
+            core_.restore(warm.state, warm.setpoint_seconds, static_cast<uint32_t>(warm.remaining_us / 1000));
         }
+        restore_source_ = RestoreSource::Rtc;
+    } else if (persistence::load(&restored) == ESP_OK && restored.valid) {
+        core_.restore(restored.state, restored.setpoint_seconds, restored.remaining_ms);
+        restore_source_ = RestoreSource::Nvs;
     }
 
-    publish_snapshot();
-
-    return ESP_OK;
+    restore_us_ = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    ESP_LOGI(TAG, "State restored from %s in %lu us",
+             restore_source_ == RestoreSource::Rtc ? "RTC mirror" : (restore_source_ == RestoreSource::Nvs ? "NVS" : "defaults"),
+             static_cast<unsigned long>(restore_us_));
 }
 
 void TimerEngine::start() {
@@ -92,6 +100,7 @@ void TimerEngine::start() {
 
 void TimerEngine::task_entry(void* arg) {
     auto* self = static_cast<TimerEngine*>(arg);
+    self->selector_ring_.waker().bind_current();
     self->run();
 }
 
@@ -102,12 +111,13 @@ void TimerEngine::enqueue_control(ControlCommand command) {
 
     TimeDeltaEvent event{};
     event.type = TimeEventType::Control;
-    event.total_seconds = static_cast<int32_t>(setpoint_seconds_);
+    event.total_seconds = static_cast<int32_t>(core_.setpoint_seconds());
     event.delta_seconds = 0;
     event.timestamp_us = static_cast<uint32_t>(esp_timer_get_time());
     event.multiplier = 0;
     event.control = command;
     xQueueSend(delta_queue_, &event, portMAX_DELAY);
+    wake();
 }
 
 void TimerEngine::enqueue_quick_delta(int32_t delta_seconds) {
@@ -117,7 +127,7 @@ void TimerEngine::enqueue_quick_delta(int32_t delta_seconds) {
     TimeDeltaEvent event{};
     event.type = TimeEventType::Delta;
     event.delta_seconds = delta_seconds;
-    int64_t projected = static_cast<int64_t>(setpoint_seconds_) + static_cast<int64_t>(delta_seconds);
+    int64_t projected = static_cast<int64_t>(core_.setpoint_seconds()) + static_cast<int64_t>(delta_seconds);
     projected = std::max<int64_t>(0, projected);
     projected = std::min<int64_t>(projected, static_cast<int64_t>(config_.max_total_seconds));
     event.total_seconds = static_cast<int32_t>(projected);
@@ -125,163 +135,178 @@ void TimerEngine::enqueue_quick_delta(int32_t delta_seconds) {
     event.multiplier = 1;
     event.control = ControlCommand::None;
     xQueueSend(delta_queue_, &event, portMAX_DELAY);
+    wake();
 }
 
-void TimerEngine::run() {
-    TickType_t last_publish = xTaskGetTickCount();
-    const TickType_t publish_interval = pdMS_TO_TICKS(1000 / config_.snapshot_hz);
+void TimerEngine::post_selector_event(const TimeDeltaEvent& event) {
+    if (event.type == TimeEventType::Commit) {
+        post_commit(event);
+        return;
+    }
+    // Deltas come from the reader task. The engine outranks it, so a full
+    // ring only happens if it is stuck behind persistence; wait rather than
+    // drop or reorder a delta.
+    while (!selector_ring_.push(event)) {
+        ring_full_waits_.fetch_add(1, std::memory_order_relaxed);
+        wake();
+        vTaskDelay(1);
+    }
+}
+
+void TimerEngine::post_commit(const TimeDeltaEvent& event) {
+    // Runs in the esp_timer task, which must never block: on a full ring the
+    // commit is latched instead and picked up once the ring drains. While one
+    // is latched later commits overwrite it, so the newest total wins. A
+    // commit lands behind the deltas it covers because the selector arms its
+    // timer after posting them.
+    if (latched_commit_.generation() == commit_taken_.load(std::memory_order_acquire) &&
+        selector_ring_.push(event)) {
+        return;
+    }
+    latched_commit_.store(event);
+    commits_latched_.fetch_add(1, std::memory_order_relaxed);
+    wake();
+}
+
+// The queue producers share the ring's waker.
+void TimerEngine::wake() {
+    selector_ring_.waker().wake();
+}
+
+bool TimerEngine::next_event(TimeDeltaEvent* out) {
+    // Boundaries are pushed to the front of the queue, so it drains first.
+    if (xQueueReceive(delta_queue_, out, 0) == pdTRUE || selector_ring_.pop(out)) {
+        return true;
+    }
+    uint32_t generation = 0;
+    if (latched_commit_.generation() == commit_taken_.load(std::memory_order_relaxed) ||
+        !latched_commit_.try_load(out, &generation)) {
+        return false;
+    }
+    commit_taken_.store(generation, std::memory_order_release);
+    return true;
+}
 
+void TimerEngine::run() {
     TimeDeltaEvent event;
     while (true) {
-        if (xQueueReceive(delta_queue_, &event, pdMS_TO_TICKS(5)) == pdTRUE) {
-            if (event.type == TimeEventType::Control) {
-                bool changed = false;
-                switch (event.control) {
-                    case ControlCommand::ToggleRun:
-                        if (state_ == TimerState::Counting) {
-                            if (esp_timer_is_active(esp_timer_)) {
-                                esp_timer_stop(esp_timer_);
-                            }
-                            state_ = TimerState::Editing;
-                            remaining_ms_ = static_cast<int64_t>(setpoint_seconds_) * 1000;
-                            changed = true;
-                        } else {
-                            if (setpoint_seconds_ > 0) {
-                                remaining_ms_ = static_cast<int64_t>(setpoint_seconds_) * 1000;
-                                if (esp_timer_is_active(esp_timer_)) {
-                                    esp_timer_stop(esp_timer_);
-                                }
-                                esp_timer_start_periodic(esp_timer_, kTimerPeriodUs);
-                                state_ = TimerState::Counting;
-                                changed = true;
-                            }
-                        }
-                        break;
-                    case ControlCommand::Reset:
-                        if (setpoint_seconds_ != 0 || remaining_ms_ != 0 || state_ != TimerState::Idle) {
-                            setpoint_seconds_ = 0;
-                            remaining_ms_ = 0;
-                            if (esp_timer_is_active(esp_timer_)) {
-                                esp_timer_stop(esp_timer_);
-                            }
-                            state_ = TimerState::Idle;
-                            changed = true;
-                        }
-                        break;
-                    case ControlCommand::None:
-                    default:
-                        break;
-                }
-
-                if (changed) {
-                    TimerSnapshot snapshot{
-                        .state = state_,
-                        .setpoint_seconds = setpoint_seconds_,
-                        .remaining_seconds = static_cast<uint32_t>(remaining_ms_ <= 0 ? 0 : (remaining_ms_ / 1000)),
-                        .remaining_ms = static_cast<uint32_t>(remaining_ms_ <= 0 ? 0 : remaining_ms_),
-                        .monotonic_us = static_cast<uint64_t>(esp_timer_get_time()),
-                    };
-                    persistence::save(snapshot);
-                    publish_snapshot();
-                }
-                continue;
-            }
-
-            if (event.type == TimeEventType::Delta) {
-                int64_t updated = static_cast<int64_t>(setpoint_seconds_) + static_cast<int64_t>(event.delta_seconds);
-                updated = std::max<int64_t>(
-                    0,
-                    std::min<int64_t>(updated, static_cast<int64_t>(config_.max_total_seconds)));
-                setpoint_seconds_ = static_cast<uint32_t>(updated);
-                remaining_ms_ = static_cast<int64_t>(setpoint_seconds_) * 1000;
-            }
-
-            state_ = determine_next_state(state_, event, config_.auto_start);
-
-            if (state_ == TimerState::Finished || state_ == TimerState::Idle || setpoint_seconds_ == 0) {
-                remaining_ms_ = static_cast<int64_t>(setpoint_seconds_) * 1000;
-                if (esp_timer_is_active(esp_timer_)) {
-                    esp_timer_stop(esp_timer_);
-                }
-            } else if (state_ == TimerState::Counting) {
-                remaining_ms_ = static_cast<int64_t>(setpoint_seconds_) * 1000;
-                if (esp_timer_is_active(esp_timer_)) {
-                    esp_timer_stop(esp_timer_);
-                }
-                esp_timer_start_periodic(esp_timer_, kTimerPeriodUs);
-            } else {
-                if (esp_timer_is_active(esp_timer_)) {
-                    esp_timer_stop(esp_timer_);
-                }
-            }
-
-            if (event.type == TimeEventType::Commit || state_ == TimerState::Finished) {
-                TimerSnapshot snapshot{
-                    .state = state_,
-                    .setpoint_seconds = setpoint_seconds_,
-                    .remaining_seconds = static_cast<uint32_t>((remaining_ms_ < 0 ? 0 : remaining_ms_) / 1000),
-                    .remaining_ms = static_cast<uint32_t>(remaining_ms_ < 0 ? 0 : remaining_ms_),
-                    .monotonic_us = static_cast<uint64_t>(esp_timer_get_time()),
-                };
-                persistence::save(snapshot);
-                publish_snapshot();
-                continue;
-            }
+        // Anything posted before start() or during the last batch is picked
+        // up here. Countdown boundaries arrive as Boundary events from the
+        // one-shot timer, so Idle and Finished leave the task blocked.
+        while (next_event(&event)) {
+            apply_batch(event);
         }
+        selector_ring_.wait(portMAX_DELAY);
+    }
+}
 
-        const TickType_t now = xTaskGetTickCount();
-        if (now - last_publish >= publish_interval) {
-            publish_snapshot();
-            last_publish = now;
+void TimerEngine::apply_batch(const TimeDeltaEvent& first) {
+    // Drain whatever queued up behind the wake-up, folding runs of deltas so
+    // a fast spin costs one setpoint update, one re-arm and one publish.
+    TimeDeltaEvent pending = first;
+    TimeDeltaEvent next;
+    bool persist = false;
+    bool reset = false;
+    ++events_received_;
+    for (UBaseType_t drained = 1; drained < kMaxBatch; ++drained) {
+        if (!next_event(&next)) {
+            break;
+        }
+        ++events_received_;
+        if (core_.fold_delta(&pending, next)) {
+            ++events_batched_;
+            continue;
         }
+        persist |= apply(pending);
+        reset |= is_reset(pending);
+        pending = next;
+    }
+    persist |= apply(pending);
+    reset |= is_reset(pending);
+
+    if (persist) {
+        persistence::save(core_.snapshot());
+    }
+    mirror_state();
+    arm_next_boundary();
+    publish_snapshot();
+    if (persist && reset) {
+        // A reset the user asked for should not sit out the write-behind
+        // debounce. Written after publishing so the UI does not wait on flash.
+        persistence::flush();
     }
 }
 
+void TimerEngine::mirror_state() {
+    // Only on changes that a warm restart would need: the deadline is fixed
+    // while counting, so boundary wake-ups do not touch RTC memory.
+    const Countdown& countdown = core_.countdown();
+    const bool running = countdown.running();
+    const int64_t deadline_us = running ? countdown.deadline_us() : -1;
+    if (has_mirrored_ && mirrored_state_ == core_.state() && mirrored_setpoint_ == core_.setpoint_seconds() &&
+        mirrored_running_ == running && mirrored_deadline_us_ == deadline_us) {
+        return;
+    }
+    warm_restart::record(core_.state(), core_.setpoint_seconds(), countdown.remaining_us(clock_.now_us()), running);
+    mirrored_state_ = core_.state();
+    mirrored_setpoint_ = core_.setpoint_seconds();
+    mirrored_running_ = running;
+    mirrored_deadline_us_ = deadline_us;
+    has_mirrored_ = true;
+}
+
+bool TimerEngine::apply(const TimeDeltaEvent& event) {
+    ++events_applied_;
+    return core_.handle(event).persist;
+}
+
 void TimerEngine::timer_callback(void* arg) {
     auto* self = static_cast<TimerEngine*>(arg);
     self->on_tick();
 }
 
 void TimerEngine::on_tick() {
-    if (state_ != TimerState::Counting) {
+    ++timer_wakeups_;
+    armed_wakeup_us_.store(-1, std::memory_order_relaxed);
+
+    TimeDeltaEvent event{};
+    event.type = TimeEventType::Boundary;
+    event.total_seconds = 0;
+    event.delta_seconds = 0;
+    event.timestamp_us = static_cast<uint32_t>(esp_timer_get_time());
+    event.multiplier = 0;
+    event.control = ControlCommand::None;
+    // A full queue means the engine is about to run anyway and re-arms after
+    // every event, so dropping the boundary is harmless.
+    if (xQueueSendToFront(delta_queue_, &event, 0) == pdTRUE) {
+        wake();
+    }
+}
+
+void TimerEngine::arm_next_boundary() {
+    const int64_t wakeup_us = core_.next_wakeup_us();
+    if (wakeup_us == armed_wakeup_us_.load(std::memory_order_relaxed)) {
         return;
     }
 
-    remaining_ms_ -= 1;
-    if (remaining_ms_ <= 0) {
-        remaining_ms_ = 0;
-        state_ = TimerState::Finished;
-        setpoint_seconds_ = 0;
-        if (esp_timer_is_active(esp_timer_)) {
-            esp_timer_stop(esp_timer_);
-        }
-        TimerSnapshot snapshot{
-            .state = state_,
-            .setpoint_seconds = setpoint_seconds_,
-            .remaining_seconds = 0,
-            .remaining_ms = 0,
-            .monotonic_us = static_cast<uint64_t>(esp_timer_get_time()),
-        };
-        persistence::save(snapshot);
-        publish_snapshot();
+    if (esp_timer_is_active(esp_timer_)) {
+        esp_timer_stop(esp_timer_);
     }
+    armed_wakeup_us_.store(wakeup_us, std::memory_order_relaxed);
+    if (wakeup_us < 0) {
+        return;
+    }
+    const int64_t delay_us = std::max(kMinArmDelayUs, wakeup_us - esp_timer_get_time());
+    esp_timer_start_once(esp_timer_, static_cast<uint64_t>(delay_us));
 }
 
 void TimerEngine::publish_snapshot() {
-    if (snapshot_queue_ == nullptr) {
+    TimerSnapshot snapshot{};
+    if (!core_.take_visible_change(&snapshot)) {
         return;
     }
-
-    const int64_t remaining_ms_clamped = remaining_ms_ < 0 ? 0 : remaining_ms_;
-    const TimerSnapshot snapshot{
-        .state = state_,
-        .setpoint_seconds = setpoint_seconds_,
-        .remaining_seconds = static_cast<uint32_t>(remaining_ms_clamped / 1000),
-        .remaining_ms = static_cast<uint32_t>(remaining_ms_clamped),
-        .monotonic_us = static_cast<uint64_t>(esp_timer_get_time()),
-    };
-
-    xQueueOverwrite(snapshot_queue_, &snapshot);
+    snapshot_channel_.publish(snapshot);
+    ++snapshots_published_;
 }
 
 void TimerEngine::enqueue_time_delta(const TimeDeltaEvent& event) {
@@ -289,6 +314,7 @@ void TimerEngine::enqueue_time_delta(const TimeDeltaEvent& event) {
         return;
     }
     xQueueSend(delta_queue_, &event, portMAX_DELAY);
+    wake();
 }
 
 }  // namespace dial
@@ -116,9 +116,7 @@ void UiRoot::update_progress(const TimerSnapshot& snapshot) {
         return;
     }
 
-    const uint32_t total = snapshot.setpoint_seconds == 0 ? 1 : snapshot.setpoint_seconds;
-    const uint32_t remaining = snapshot.remaining_seconds;
-    const int16_t sweep = static_cast<int16_t>((360 * remaining) / total);
+    const int16_t sweep = static_cast<int16_t>(progress_arc_step(snapshot));
 
     lv_arc_set_value(arc_progress_, sweep);
     lv_obj_set_style_arc_color(arc_progress_, determine_color(snapshot), LV_PART_INDICATOR);
@@ -2,6 +2,8 @@
 #include "freertos/task.h"
 #include "esp_check.h"
 #include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "driver/i2c.h"
 
@@ -18,22 +20,80 @@
 
 namespace {
 constexpr const char* TAG = "app_main";
+// Streams touch samples and events to the console for tools/host-bench
+// gesture_replay; capture with `idf.py monitor | tee touch.log`.
+constexpr bool kRecordTouchTrace = false;
+constexpr size_t kTraceLinesPerLoop = 32;
 
-void time_event_dispatch(void* arg) {
-    (void)arg;
-    dial::TimeDeltaEvent event;
-    while (true) {
-        if (xQueueReceive(dial::g_time_selector.event_queue(), &event, portMAX_DELAY) == pdTRUE) {
-            dial::g_timer_engine.enqueue_time_delta(event);
-        }
+const char* restore_source_name(dial::RestoreSource source) {
+    switch (source) {
+        case dial::RestoreSource::Rtc:
+            return "rtc";
+        case dial::RestoreSource::Nvs:
+            return "nvs";
+        case dial::RestoreSource::Defaults:
+        default:
+            return "defaults";
+    }
+}
+
+void log_persistence_stats() {
+    const dial::persistence::PersistenceStats stats = dial::persistence::stats();
+    ESP_LOGI(TAG,
+             "persist: %lu saves (%lu coalesced, %lu unchanged), %lu commits, %lu NVS entries, %lu failures, "
+             "worst flush %lu us",
+             static_cast<unsigned long>(stats.requests), static_cast<unsigned long>(stats.coalesced),
+             static_cast<unsigned long>(stats.unchanged_skipped), static_cast<unsigned long>(stats.commits),
+             static_cast<unsigned long>(stats.entries_written), static_cast<unsigned long>(stats.failures),
+             static_cast<unsigned long>(stats.max_flush_us));
+}
+
+// Haptic cues derived from timer transitions. Posting never blocks; a cue
+// dropped on a full ring is counted in the motor stats.
+void post_haptic_cues(const dial::TimerSnapshot& prev, const dial::TimerSnapshot& next) {
+    constexpr uint32_t kFinalMinuteSeconds = 60;
+    const uint32_t max_total_seconds = dial::g_timer_engine.config().max_total_seconds;
+
+    // End stop while the setpoint sits at either limit, blocking whichever
+    // way the knob was turning when it got there. Turning down to zero moves
+    // Editing/Arming to Idle, so the lower stop is keyed on that transition.
+    auto at_upper = [&](const dial::TimerSnapshot& s) {
+        return s.state == dial::TimerState::Editing && s.setpoint_seconds >= max_total_seconds;
+    };
+    auto at_lower = [](const dial::TimerSnapshot& s) {
+        return s.state == dial::TimerState::Idle && s.setpoint_seconds == 0;
+    };
+    const bool turned_to_zero = at_lower(next) && (prev.state == dial::TimerState::Editing ||
+                                                   prev.state == dial::TimerState::Arming);
+    const bool pushed_to_max = at_upper(next) && (!at_upper(prev) || next.setpoint_seconds != prev.setpoint_seconds);
+    if (turned_to_zero || pushed_to_max) {
+        dial::g_motor_controller.post(dial::HapticCommand{.type = dial::HapticCommandType::EngageWall});
+    } else if ((at_upper(prev) || at_lower(prev)) && !at_upper(next) && !at_lower(next)) {
+        dial::g_motor_controller.post(dial::HapticCommand{.type = dial::HapticCommandType::ReleaseWall});
+    }
+
+    if (next.state == dial::TimerState::Counting && prev.state == dial::TimerState::Counting &&
+        prev.remaining_seconds > kFinalMinuteSeconds && next.remaining_seconds <= kFinalMinuteSeconds) {
+        dial::g_motor_controller.play(dial::HapticEffect::FinalMinute);
+    }
+    if (next.state == dial::TimerState::Finished && prev.state != dial::TimerState::Finished) {
+        dial::g_motor_controller.play(dial::HapticEffect::Buzz);
     }
 }
 
 void ui_dispatch_task(void* arg) {
     (void)arg;
+    dial::SnapshotChannel& snapshots = dial::g_timer_engine.snapshots();
+    ESP_ERROR_CHECK(snapshots.subscribe(xTaskGetCurrentTaskHandle()));
+
     dial::TimerSnapshot snapshot;
+    dial::TimerSnapshot previous;
+    snapshots.latest(&previous);
+    uint32_t generation = 0;
     while (true) {
-        if (xQueueReceive(dial::g_timer_engine.snapshot_queue(), &snapshot, portMAX_DELAY) == pdTRUE) {
+        if (snapshots.wait(&snapshot, &generation)) {
+            post_haptic_cues(previous, snapshot);
+            previous = snapshot;
             dial::lvgl_acquire();
             dial::g_ui_root.update(snapshot);
             dial::lvgl_release();
@@ -65,6 +125,7 @@ void touch_event_dispatch(void* arg) {
 
         switch (event.type) {
             case dial::TouchEventType::Tap:
+                dial::g_motor_controller.play(dial::HapticEffect::Click);
                 switch (event.zone) {
                     case dial::TapZone::TopEdge:
                         apply_delta(kEdgeAdjustSeconds);
@@ -128,11 +189,14 @@ extern "C" void app_main(void) {
     ESP_ERROR_CHECK(nvs_status);
 
     ESP_ERROR_CHECK(dial::persistence::init());
+    ESP_ERROR_CHECK(dial::persistence::start());
 
     const dial::DialBoardConfig board_cfg{};
     ESP_ERROR_CHECK(dial::g_board.init(board_cfg));
 
-    esp_err_t touch_status = dial::g_touch_input.init();
+    dial::TouchConfig touch_cfg{};
+    touch_cfg.record_trace = kRecordTouchTrace;
+    esp_err_t touch_status = dial::g_touch_input.init(touch_cfg);
     dial::HapticsConfig haptics_cfg{
         .gpio_u = dial::PinMap::MOTOR_IN1,
         .gpio_v = dial::PinMap::MOTOR_IN2,
@@ -148,12 +212,23 @@ extern "C" void app_main(void) {
         ESP_LOGW(TAG, "Touch input unavailable (%s)", esp_err_to_name(touch_status));
     }
 
+    // The reader runs the selector inline and posts straight to the engine,
+    // so both are ready before its task starts.
+    const dial::TimeSelectorConfig selector_cfg{};
+    ESP_ERROR_CHECK(dial::g_time_selector.init(selector_cfg));
+    dial::g_time_selector.set_sink([](const dial::TimeDeltaEvent& event) {
+        dial::g_timer_engine.post_selector_event(event);
+    });
+
+    const dial::TimerEngineConfig timer_cfg{};
+    ESP_ERROR_CHECK(dial::g_timer_engine.init(timer_cfg));
+    dial::g_timer_engine.start();
+
     const dial::EncoderConfig encoder_cfg{
         .sda_gpio = dial::PinMap::ENCODER_SDA,
         .scl_gpio = dial::PinMap::ENCODER_SCL,
         .i2c_port = I2C_NUM_1,
         .i2c_address = static_cast<uint8_t>(dial::PinMap::ENCODER_I2C_ADDRESS),
-        .sample_queue_depth = 128,
         .poll_interval_ms = 5,
         .ticks_per_revolution = 96,
         .i2c_clock_hz = 400000,
@@ -161,37 +236,53 @@ extern "C" void app_main(void) {
         .task_stack_size = 4096,
         .task_priority = 6,
         .task_core_id = 0,
+        .backend = dial::PinMap::ENCODER_A >= 0 ? dial::EncoderBackend::PcntAbz : dial::EncoderBackend::I2cPoll,
+        .abz_a_gpio = dial::PinMap::ENCODER_A,
+        .abz_b_gpio = dial::PinMap::ENCODER_B,
     };
     ESP_ERROR_CHECK(dial::g_encoder_reader.init(encoder_cfg));
 
-    const dial::TimeSelectorConfig selector_cfg{};
-    ESP_ERROR_CHECK(dial::g_time_selector.init(selector_cfg));
-    dial::g_time_selector.start();
-
-    const dial::TimerEngineConfig timer_cfg{};
-    ESP_ERROR_CHECK(dial::g_timer_engine.init(timer_cfg));
-    dial::g_timer_engine.start();
-
     ESP_ERROR_CHECK(dial::init_lvgl_display());
     dial::lvgl_acquire();
     ESP_ERROR_CHECK(dial::g_ui_root.init({}));
     dial::lvgl_release();
 
     dial::TimerSnapshot initial_snapshot{};
-    if (xQueuePeek(dial::g_timer_engine.snapshot_queue(), &initial_snapshot, 0) == pdTRUE) {
+    if (dial::g_timer_engine.snapshots().latest(&initial_snapshot)) {
         dial::lvgl_acquire();
         dial::g_ui_root.update(initial_snapshot);
+        lv_refr_now(nullptr);
         dial::lvgl_release();
     }
+    // Time-to-first-correct-frame: esp_timer starts early in app startup, so
+    // this excludes the ROM/bootloader stage, which is the same for every path.
+    ESP_LOGI(TAG, "First frame at %lld us (reset reason %d, restore=%s in %lu us)",
+             static_cast<long long>(esp_timer_get_time()), static_cast<int>(esp_reset_reason()),
+             restore_source_name(dial::g_timer_engine.restore_source()),
+             static_cast<unsigned long>(dial::g_timer_engine.restore_us()));
 
-    xTaskCreatePinnedToCore(&time_event_dispatch, "time_evt", 4096, nullptr, 5, nullptr, 0);
     xTaskCreatePinnedToCore(&ui_dispatch_task, "ui_evt", 4096, nullptr, 5, nullptr, 1);
     if (touch_status == ESP_OK && dial::g_touch_input.queue() != nullptr) {
         xTaskCreatePinnedToCore(&touch_event_dispatch, "touch_evt", 3072, nullptr, 5, nullptr, 1);
     }
 
+    constexpr int64_t kStatsIntervalUs = 60LL * 1000 * 1000;
+    int64_t next_stats_us = esp_timer_get_time() + kStatsIntervalUs;
     while (true) {
         dial::g_board.update();
+        if (touch_status == ESP_OK) {
+            dial::g_touch_input.dump_trace(kTraceLinesPerLoop);
+        }
+        if (esp_timer_get_time() >= next_stats_us) {
+            if (touch_status == ESP_OK) {
+                dial::g_touch_input.log_stats();
+            }
+            dial::g_encoder_reader.log_stats();
+            dial::g_time_selector.log_stats();
+            dial::g_motor_controller.log_stats();
+            log_persistence_stats();
+            next_stats_us += kStatsIntervalUs;
+        }
         vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+REPO_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BENCH_DIR="$REPO_ROOT/tools/host-bench"
+BUILD_DIR="$REPO_ROOT/build/host-bench"
+
+mkdir -p "$BUILD_DIR"
+
+cmake -S "$BENCH_DIR" -B "$BUILD_DIR"
+cmake --build "$BUILD_DIR"
+
+if [[ ${1:-} == "run" ]]; then
+  shift
+  HARNESS=${1:?usage: host_bench.sh run <harness> [args...]}
+  shift
+  "$BUILD_DIR/$HARNESS" "$@"
+fi
@@ -0,0 +1,218 @@
+// Replays simulated knob motion through the encoder sampling path
+// (SampleRateGovernor intervals, two-transaction I2C read, MotionTracker)
+// into a haptic loop running at a fixed rate, and compares the rotor angle
+// the loop commutates with against the true angle: holding the latest
+// sample, as MotorController did before, and extrapolating it with
+// dial::AnglePredictor.
+//
+// Errors are in MT6701 raw units (1/16384 turn) and in degrees of detent
+// phase at 96 detents per turn, which is what decides how crisp a detent
+// feels at speed.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "input/angle_predictor.h"
+#include "input/encoder_ticks.h"
+#include "input/motion_tracker.h"
+#include "input/sample_rate.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kRawPerTurn = dial::kMt6701AngleResolution;
+constexpr double kDetents = 96.0;
+constexpr uint32_t kReadUs = 180;  // two 400 kHz transactions plus driver overhead
+
+struct Profile {
+    const char* name;
+    double (*velocity_rps)(double t);
+};
+
+const Profile kProfiles[] = {
+    {"steady 1 rev/s", [](double) { return 1.0; }},
+    {"steady 5 rev/s", [](double) { return 5.0; }},
+    {"steady 15 rev/s", [](double) { return 15.0; }},
+    {"flick to 25 rev/s", [](double t) {
+         const double phase = std::fmod(t, 1.0);
+         return phase < 0.1 ? 250.0 * phase : std::max(0.0, 25.0 - 40.0 * (phase - 0.1));
+     }},
+    {"back and forth 3 Hz", [](double t) { return 4.0 * std::sin(2 * kPi * 3.0 * t); }},
+    {"ratcheting detents", [](double t) {
+         const double phase = std::fmod(t, 0.2);
+         return phase < 0.08 ? 1.5 * std::sin(kPi * phase / 0.08) : 0.0;
+     }},
+};
+
+struct ErrorStats {
+    std::vector<double> errors;
+
+    void add(double raw_error) { errors.push_back(std::abs(raw_error)); }
+    double mean() const {
+        double sum = 0.0;
+        for (double e : errors) {
+            sum += e;
+        }
+        return errors.empty() ? 0.0 : sum / errors.size();
+    }
+    double percentile(double p) {
+        if (errors.empty()) {
+            return 0.0;
+        }
+        std::sort(errors.begin(), errors.end());
+        return errors[std::min(errors.size() - 1, static_cast<size_t>(p * errors.size()))];
+    }
+};
+
+double to_detent_degrees(double raw) {
+    return raw * kDetents * 360.0 / kRawPerTurn;
+}
+
+struct Result {
+    ErrorStats hold;
+    ErrorStats predicted;
+    dial::AnglePredictionStats scored{};
+    uint32_t samples = 0;
+};
+
+// `fixed_interval_us` > 0 replaces the governor with a fixed poll interval.
+Result run(const Profile& profile, uint32_t loop_rate_hz, double duration_s, uint32_t fixed_interval_us,
+           uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise_raw(0.0, 1.5);
+    std::uniform_int_distribution<int> wake_jitter_us(0, 120);
+
+    Result result{};
+    dial::SampleRateGovernor governor{dial::SampleRateConfig{}};
+    dial::MotionTracker tracker;
+    dial::AnglePredictor predictor;
+
+    // True angle integrated at 10 us.
+    constexpr uint32_t kStepUs = 10;
+    const uint64_t end_us = static_cast<uint64_t>(duration_s * 1e6);
+    const uint32_t loop_period_us = 1000000 / loop_rate_hz;
+    double angle = 1234.0;  // raw units, unwrapped
+    std::vector<double> truth;
+    truth.reserve(end_us / kStepUs + 1);
+    for (uint64_t t = 0; t <= end_us; t += kStepUs) {
+        truth.push_back(angle);
+        angle += profile.velocity_rps(static_cast<double>(t) / 1e6) * kRawPerTurn * kStepUs / 1e6;
+    }
+    auto true_at = [&](uint64_t t_us) { return truth[std::min<size_t>(t_us / kStepUs, truth.size() - 1)]; };
+    auto wrap = [](double raw) {
+        return static_cast<uint16_t>(static_cast<int64_t>(std::floor(raw)) & (dial::kMt6701AngleResolution - 1));
+    };
+
+    // Reader state.
+    uint64_t next_read_us = 0;
+    uint64_t last_read_us = 0;
+    int32_t unwrapped = 0;
+    int32_t last_raw = -1;
+    // Published observation, visible to the loop once the read completes.
+    dial::AngleObservation published{};
+    bool has_published = false;
+    dial::AngleObservation pending{};
+    uint64_t pending_at_us = 0;
+    bool has_pending = false;
+    uint32_t generation = 0;
+    uint32_t loaded_generation = 0;
+
+    for (uint64_t loop_us = 0; loop_us < end_us; loop_us += loop_period_us) {
+        const uint64_t wake_us = loop_us + wake_jitter_us(rng);
+        // Run every read that started before this wake.
+        while (next_read_us <= wake_us) {
+            const uint64_t started_us = next_read_us;
+            const uint64_t sampled_us = started_us + kReadUs / 2;
+            const uint16_t raw = wrap(true_at(sampled_us) + noise_raw(rng));
+            const int32_t delta_raw = last_raw < 0 ? 0 : dial::mt6701_angle_delta(static_cast<uint16_t>(last_raw), raw);
+            unwrapped += delta_raw;
+            const dial::EncoderMotion motion = tracker.update(unwrapped, static_cast<uint32_t>(sampled_us));
+            const uint32_t governed_us = governor.update(delta_raw, static_cast<uint32_t>(started_us - last_read_us));
+            const uint32_t interval_us = fixed_interval_us > 0 ? fixed_interval_us : governed_us;
+            last_read_us = started_us;
+            last_raw = raw;
+            pending = dial::AngleObservation{static_cast<uint32_t>(sampled_us), motion.velocity, raw, true};
+            pending_at_us = started_us + kReadUs;
+            has_pending = true;
+            next_read_us = started_us + std::max<uint32_t>(interval_us, kReadUs + 50);
+            ++result.samples;
+            if (pending_at_us <= wake_us) {
+                published = pending;
+                has_published = true;
+                has_pending = false;
+                ++generation;
+            }
+        }
+        if (has_pending && pending_at_us <= wake_us) {
+            published = pending;
+            has_published = true;
+            has_pending = false;
+            ++generation;
+        }
+        if (!has_published) {
+            continue;
+        }
+        if (generation != loaded_generation) {
+            loaded_generation = generation;
+            predictor.observe(published);
+        }
+        const double truth_now = true_at(wake_us);
+        const double true_wrapped = std::fmod(std::fmod(truth_now, kRawPerTurn) + kRawPerTurn, kRawPerTurn);
+        auto error = [&](uint16_t angle_raw) {
+            double e = angle_raw - true_wrapped;
+            if (e > kRawPerTurn / 2) {
+                e -= kRawPerTurn;
+            } else if (e < -kRawPerTurn / 2) {
+                e += kRawPerTurn;
+            }
+            return e;
+        };
+        result.hold.add(error(published.raw_angle));
+        result.predicted.add(error(predictor.predict(static_cast<uint32_t>(wake_us))));
+    }
+    result.scored = predictor.stats();
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t loop_rate_hz = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 10000;
+    const double duration_s = argc > 2 ? std::atof(argv[2]) : 4.0;
+    const uint32_t fixed_interval_us = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 0;
+    if (loop_rate_hz == 0 || duration_s <= 0.0) {
+        std::fprintf(stderr, "usage: angle_predictor_bench [loop rate hz] [seconds] [fixed poll interval us]\n");
+        return 2;
+    }
+
+    std::printf("haptic loop at %u Hz, encoder %s, %.1f s per profile; errors in raw units (detent phase degrees)\n",
+                loop_rate_hz, fixed_interval_us > 0 ? "on a fixed interval" : "paced by SampleRateGovernor", duration_s);
+    std::printf("%-22s %7s %22s %22s %22s %22s\n", "profile", "samples", "hold mean", "hold p99", "predicted mean",
+                "predicted p99");
+    bool ok = true;
+    uint32_t seed = 1;
+    for (const Profile& profile : kProfiles) {
+        Result r = run(profile, loop_rate_hz, duration_s, fixed_interval_us, seed++);
+        const double hold_mean = r.hold.mean();
+        const double hold_p99 = r.hold.percentile(0.99);
+        const double pred_mean = r.predicted.mean();
+        const double pred_p99 = r.predicted.percentile(0.99);
+        std::printf("%-22s %7u %9.1f (%6.1f deg) %9.1f (%6.1f deg) %9.1f (%6.1f deg) %9.1f (%6.1f deg)\n",
+                    profile.name, r.samples, hold_mean, to_detent_degrees(hold_mean), hold_p99,
+                    to_detent_degrees(hold_p99), pred_mean, to_detent_degrees(pred_mean), pred_p99,
+                    to_detent_degrees(pred_p99));
+        const dial::AnglePredictionStats& s = r.scored;
+        const double scored = s.scored > 0 ? static_cast<double>(s.scored) : 1.0;
+        std::printf("%-22s %7s next-sample error: predicted mean %.1f max %u, held mean %.1f max %u raw "
+                    "(%u scored, %u past horizon)\n",
+                    "", "", s.error_total_raw / scored, s.error_max_raw, s.hold_error_total_raw / scored,
+                    s.hold_error_max_raw, s.scored, s.horizon_clamps);
+        ok = ok && pred_mean <= hold_mean + 0.5;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+// Averaged model of the haptic knob's gimbal BLDC and its MT6701 sensor, for
+// host harnesses that run the haptics control code in closed loop.
+//
+// Electrical: the three PWM duties are averaged into phase voltages over the
+// period (no switching ripple), transformed into the rotor's d/q frame, and
+// drive an R-L winding with back-EMF and speed-dependent cross coupling.
+// Each substep holds the voltages and speed constant and solves the R-L
+// response exactly, so substeps can be far longer than the electrical time
+// constant; time is in whole microseconds so the decay factors are a table,
+// and the electrical and cogging phases are carried as unit vectors rotated
+// each substep rather than angles fed to sin/cos. A duty change can be
+// scheduled a few microseconds ahead and lands inside the substep. Mechanical:
+// rotor plus knob inertia driven by the substep's mean torque, with viscous
+// and Coulomb friction (sticking at rest), cogging, and an external spring and
+// damper towards a target (the hand), integrated implicitly so a stiff finger
+// does not shorten the substep. Callers only need to step the plant at their
+// own events.
+//
+// Electrical angle convention: `electrical_offset_rad` is the
+// zero_electrical_offset a perfect calibration finds, i.e. with the same
+// offset and pole pairs dial::CommutationKernel puts its whole amplitude on
+// the q axis.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace host_bench {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTwoPi = 2.0 * kPi;
+
+struct BldcPlantParams {
+    int pole_pairs = 7;
+    double phase_resistance_ohm = 6.0;
+    double phase_inductance_h = 2.5e-3;
+    double torque_constant_nm_per_a = 0.05;  // per amp of q-axis (peak phase) current
+    double bus_voltage = 5.0;
+    double inertia_kg_m2 = 1.0e-5;  // rotor and knob ring
+    double viscous_nm_s_per_rad = 5.0e-6;
+    double coulomb_friction_nm = 0.8e-3;
+    double cogging_nm = 0.5e-3;
+    int cogging_periods = 84;  // per turn: LCM(12 slots, 14 poles)
+    double electrical_offset_rad = 0.0;
+    int sensor_direction = 1;  // -1: the MT6701 counts against the motor
+    uint32_t max_substep_us = 500;  // within 5% of a detent of a 5 us step
+};
+
+class BldcPlant {
+public:
+    explicit BldcPlant(const BldcPlantParams& params) : p_(params) {
+        p_.max_substep_us = std::max<uint32_t>(1, p_.max_substep_us);
+        flux_linkage_ = p_.torque_constant_nm_per_a / (1.5 * p_.pole_pairs);
+        inv_resistance_ = 1.0 / p_.phase_resistance_ohm;
+        inv_inertia_ = 1.0 / p_.inertia_kg_m2;
+        decay_.resize(p_.max_substep_us + 1);
+        mean_decay_.resize(p_.max_substep_us + 1);
+        const double tau_us = 1e6 * p_.phase_inductance_h / p_.phase_resistance_ohm;
+        for (uint32_t us = 0; us <= p_.max_substep_us; ++us) {
+            decay_[us] = std::exp(-(us / tau_us));
+            mean_decay_[us] = us > 0 ? (1.0 - decay_[us]) * tau_us / us : 1.0;
+        }
+        set_angle(0.0);
+    }
+
+    void set_angle(double angle_rad) {
+        angle_ = angle_rad;
+        velocity_ = 0.0;
+        // Rotor d axis sits half an electrical turn from the kernel's angle
+        // (its sin(angle) drive lands on -alpha); see the header comment.
+        const double theta_e = p_.pole_pairs * angle_ + p_.electrical_offset_rad + kPi;
+        const double theta_cog = p_.cogging_periods * angle_;
+        cos_e_ = std::cos(theta_e);
+        sin_e_ = std::sin(theta_e);
+        cos_cog_ = std::cos(theta_cog);
+        sin_cog_ = std::sin(theta_cog);
+    }
+
+    // Duties in counts of `max_duty`, taking effect `delay_us` from now (a
+    // PWM shadow-register load) and replacing any still pending. The switch
+    // lands inside a substep rather than splitting it.
+    void set_phase_duties(uint32_t u, uint32_t v, uint32_t w, uint32_t max_duty, uint32_t delay_us = 0) {
+        const double scale = p_.bus_voltage / max_duty;
+        const double va = u * scale;
+        const double vb = v * scale;
+        const double vc = w * scale;
+        // Clarke; the common mode drops out of a star winding.
+        pending_alpha_ = (2.0 * va - vb - vc) / 3.0;
+        pending_beta_ = (vb - vc) / std::sqrt(3.0);
+        pending_in_us_ = delay_us;
+        has_pending_ = true;
+        if (delay_us == 0) {
+            latch();
+        }
+    }
+
+    // Torque stiffness * (target - angle) + damping * (target_velocity -
+    // velocity); zero stiffness and damping let go.
+    void set_external_spring(double stiffness_nm_per_rad, double damping_nm_s_per_rad, double target_rad,
+                             double target_velocity_rad_s) {
+        spring_stiffness_ = stiffness_nm_per_rad;
+        spring_damping_ = damping_nm_s_per_rad;
+        spring_target_ = target_rad;
+        spring_target_velocity_ = target_velocity_rad_s;
+    }
+    double external_torque_nm() const {
+        return spring_stiffness_ * (spring_target_ - angle_) + spring_damping_ * (spring_target_velocity_ - velocity_);
+    }
+
+    void advance_us(uint64_t dt_us) {
+        while (dt_us > 0) {
+            const auto us = static_cast<uint32_t>(std::min<uint64_t>(dt_us, p_.max_substep_us));
+            substep(us);
+            dt_us -= us;
+        }
+    }
+
+    double angle_rad() const { return angle_; }  // unwrapped, motor direction
+    double velocity_rad_s() const { return velocity_; }
+    double motor_torque_nm() const { return p_.torque_constant_nm_per_a * i_q_; }
+    double current_q_a() const { return i_q_; }
+    const BldcPlantParams& params() const { return p_; }
+
+private:
+    // Turns the unit vector (c, s) by `delta` radians.
+    static void rotate(double* c, double* s, double delta) {
+        double cd;
+        double sd;
+        if (std::abs(delta) < 0.5) {
+            // Taylor terms; the next ones are below 1e-9 here.
+            const double d2 = delta * delta;
+            cd = 1.0 - d2 * (1.0 / 2 - d2 * (1.0 / 24 - d2 * (1.0 / 720 - d2 * (1.0 / 40320))));
+            sd = delta * (1.0 - d2 * (1.0 / 6 - d2 * (1.0 / 120 - d2 * (1.0 / 5040 - d2 * (1.0 / 362880)))));
+        } else {
+            cd = std::cos(delta);
+            sd = std::sin(delta);
+        }
+        const double nc = *c * cd - *s * sd;
+        const double ns = *s * cd + *c * sd;
+        // One Newton step back onto the unit circle keeps rounding from
+        // growing the vector.
+        const double fix = 1.5 - 0.5 * (nc * nc + ns * ns);
+        *c = nc * fix;
+        *s = ns * fix;
+    }
+
+    void latch() {
+        v_alpha_ = pending_alpha_;
+        v_beta_ = pending_beta_;
+        has_pending_ = false;
+    }
+
+    // Exact R-L response over `us` with the voltages, rotor frame, speed and
+    // cross terms held; returns the mean q current over it.
+    double electrical(uint32_t us, double omega_e) {
+        const double v_d = v_alpha_ * cos_e_ + v_beta_ * sin_e_;
+        const double v_q = -v_alpha_ * sin_e_ + v_beta_ * cos_e_;
+        const double l = p_.phase_inductance_h;
+        const double d_target = (v_d + omega_e * l * i_q_) * inv_resistance_;
+        const double q_target = (v_q - omega_e * l * i_d_ - omega_e * flux_linkage_) * inv_resistance_;
+        const double mean_i_q = q_target + (i_q_ - q_target) * mean_decay_[us];
+        i_d_ = d_target + (i_d_ - d_target) * decay_[us];
+        i_q_ = q_target + (i_q_ - q_target) * decay_[us];
+        return mean_i_q;
+    }
+
+    void substep(uint32_t us) {
+        const double h = us * 1e-6;
+        const double omega_e = p_.pole_pairs * velocity_;
+        // The mechanics see the mean torque over the substep, across a duty
+        // switch inside it.
+        double mean_i_q;
+        if (has_pending_ && pending_in_us_ < us) {
+            const uint32_t before = pending_in_us_;
+            const double first = electrical(before, omega_e);
+            latch();
+            const double second = electrical(us - before, omega_e);
+            mean_i_q = (first * before + second * (us - before)) / us;
+        } else {
+            mean_i_q = electrical(us, omega_e);
+            if (has_pending_) {
+                pending_in_us_ -= us;
+                if (pending_in_us_ == 0) {
+                    latch();
+                }
+            }
+        }
+
+        const double cogging = -p_.cogging_nm * sin_cog_;
+        const double external = external_torque_nm();
+        const double drive = p_.torque_constant_nm_per_a * mean_i_q + external + cogging - p_.viscous_nm_s_per_rad * velocity_;
+        const double friction = p_.coulomb_friction_nm;
+        const double start_velocity = velocity_;
+        if (velocity_ == 0.0 && std::abs(drive) <= friction) {
+            // Stuck.
+        } else {
+            const double direction = velocity_ != 0.0 ? (velocity_ > 0.0 ? 1.0 : -1.0) : (drive > 0.0 ? 1.0 : -1.0);
+            // The rest of the torque is explicit; the external spring and
+            // damper are trapezoidal, so a stiff finger does not bound the
+            // substep.
+            const double hj = h * inv_inertia_;
+            const double held = drive - external - friction * direction;
+            const double spring = spring_stiffness_ * (spring_target_ - angle_ - 0.25 * h * velocity_) +
+                                  spring_damping_ * (spring_target_velocity_ - 0.5 * velocity_);
+            const double next = (velocity_ + hj * (held + spring)) /
+                                (1.0 + hj * (0.25 * h * spring_stiffness_ + 0.5 * spring_damping_));
+            // Friction stops the rotor rather than reversing it.
+            velocity_ = (velocity_ != 0.0 && next * velocity_ < 0.0) ? 0.0 : next;
+        }
+        const double step = 0.5 * h * (start_velocity + velocity_);
+        angle_ += step;
+        if (step != 0.0) {
+            rotate(&cos_e_, &sin_e_, p_.pole_pairs * step);
+            rotate(&cos_cog_, &sin_cog_, p_.cogging_periods * step);
+        }
+    }
+
+    BldcPlantParams p_;
+    double flux_linkage_ = 0.0;
+    double inv_resistance_ = 0.0;
+    double inv_inertia_ = 0.0;
+    double v_alpha_ = 0.0;
+    double v_beta_ = 0.0;
+    double pending_alpha_ = 0.0;
+    double pending_beta_ = 0.0;
+    uint32_t pending_in_us_ = 0;
+    bool has_pending_ = false;
+    double i_d_ = 0.0;
+    double i_q_ = 0.0;
+    double angle_ = 0.0;
+    double velocity_ = 0.0;
+    double cos_e_ = 1.0;  // rotor d axis
+    double sin_e_ = 0.0;
+    double cos_cog_ = 1.0;  // cogging phase
+    double sin_cog_ = 0.0;
+    double spring_stiffness_ = 0.0;
+    double spring_damping_ = 0.0;
+    double spring_target_ = 0.0;
+    double spring_target_velocity_ = 0.0;
+    std::vector<double> decay_;       // R-L decay per whole-microsecond substep
+    std::vector<double> mean_decay_;  // its mean over the substep
+};
+
+struct Mt6701Params {
+    double noise_raw = 1.0;   // RMS, before quantisation
+    double latency_s = 5e-6;  // internal filter
+};
+
+// 14-bit absolute angle as the MT6701 reports it.
+class Mt6701Model {
+public:
+    Mt6701Model(const Mt6701Params& params, int direction, uint32_t seed)
+        : p_(params), direction_(direction), rng_(seed), noise_(0.0, params.noise_raw) {}
+
+    uint16_t read(double angle_rad, double velocity_rad_s) {
+        const double seen = (angle_rad - velocity_rad_s * p_.latency_s) * direction_;
+        const double raw = seen / kTwoPi * 16384.0 + (p_.noise_raw > 0.0 ? noise_(rng_) : 0.0);
+        return static_cast<uint16_t>(static_cast<int64_t>(std::floor(raw)) & 0x3FFF);
+    }
+
+private:
+    Mt6701Params p_;
+    int direction_;
+    std::mt19937 rng_;
+    std::normal_distribution<double> noise_;
+};
+
+}  // namespace host_bench
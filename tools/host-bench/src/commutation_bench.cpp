@@ -0,0 +1,228 @@
+// Checks dial::CommutationKernel and dial::sin_q15 against double-precision
+// references, then times one haptic step (detent torque plus three phase
+// duties) in the float form MotorController used before the kernel and in
+// the fixed-point form it uses now.
+//
+// Accuracy covers every 14-bit raw angle for both modulation schemes at
+// several amplitudes, directions and offsets; duty errors are in PWM counts
+// against an exactly rounded reference, line-to-line errors too since those
+// are what the motor sees.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DIAL_HAVE_RDTSC 1
+#endif
+
+#include "haptics/commutation.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint32_t kMaxDuty = 4095;  // 12-bit LEDC
+constexpr uint8_t kPolePairs = 7;
+constexpr uint16_t kDetentPositions = 96;
+constexpr uint32_t kMaxDutyErrorCounts = 2;
+
+struct DutyRef {
+    double u, v, w;
+};
+
+DutyRef reference_duty(uint16_t raw, double amplitude, const dial::CommutationConfig& cfg) {
+    double angle = 2.0 * kPi * raw / dial::kAngleTurn * cfg.pole_pairs * cfg.direction;
+    angle += 2.0 * kPi * cfg.offset / dial::kAngleTurn;
+    double u = amplitude * std::sin(angle);
+    double v = amplitude * std::sin(angle - 2.0 * kPi / 3.0);
+    double w = amplitude * std::sin(angle + 2.0 * kPi / 3.0);
+    if (cfg.modulation == dial::Modulation::SpaceVector) {
+        const double common = (std::max({u, v, w}) + std::min({u, v, w})) / 2.0;
+        u -= common;
+        v -= common;
+        w -= common;
+    }
+    auto duty = [&](double x) { return std::clamp(0.5 + x, 0.0, 1.0) * cfg.max_duty; };
+    return DutyRef{duty(u), duty(v), duty(w)};
+}
+
+struct Accuracy {
+    double max_duty_error = 0.0;
+    double max_line_error = 0.0;
+    double sum_duty_error = 0.0;
+    uint64_t samples = 0;
+};
+
+void check_kernel(const dial::CommutationConfig& cfg, double amplitude, Accuracy* acc) {
+    const dial::CommutationKernel kernel(cfg);
+    const int32_t amplitude_q15 = static_cast<int32_t>(std::lround(amplitude * 32768.0));
+    for (uint32_t raw = 0; raw < dial::kAngleTurn; ++raw) {
+        const dial::PhaseDuty d = kernel.update(static_cast<uint16_t>(raw), amplitude_q15);
+        const DutyRef r = reference_duty(static_cast<uint16_t>(raw), amplitude, cfg);
+        const double eu = std::abs(d.u - r.u);
+        const double ev = std::abs(d.v - r.v);
+        const double ew = std::abs(d.w - r.w);
+        acc->max_duty_error = std::max({acc->max_duty_error, eu, ev, ew});
+        acc->sum_duty_error += eu + ev + ew;
+        acc->samples += 3;
+        const double luv = std::abs((static_cast<double>(d.u) - d.v) - (r.u - r.v));
+        const double lvw = std::abs((static_cast<double>(d.v) - d.w) - (r.v - r.w));
+        acc->max_line_error = std::max({acc->max_line_error, luv, lvw});
+    }
+}
+
+bool check_accuracy() {
+    int32_t max_sin_error = 0;
+    double sum_sin_error = 0.0;
+    for (uint32_t angle = 0; angle < dial::kAngleTurn; ++angle) {
+        const double ref = std::sin(2.0 * kPi * angle / dial::kAngleTurn) * dial::kQ15One;
+        const int32_t err = static_cast<int32_t>(std::lround(std::abs(dial::sin_q15(angle) - ref)));
+        max_sin_error = std::max(max_sin_error, err);
+        sum_sin_error += std::abs(dial::sin_q15(angle) - ref);
+    }
+    std::printf("sin_q15: max error %d LSB, mean %.2f LSB over %u angles (Q15, %u-entry quarter table)\n",
+                max_sin_error, sum_sin_error / dial::kAngleTurn, dial::kAngleTurn, (1u << dial::kSineTableBits) + 1);
+
+    bool ok = max_sin_error <= 2;
+    const struct {
+        const char* name;
+        dial::Modulation modulation;
+        double amplitudes[4];
+    } schemes[] = {
+        {"sinusoidal", dial::Modulation::Sinusoidal, {0.05, 0.2, 0.4, 0.49}},
+        {"space vector", dial::Modulation::SpaceVector, {0.05, 0.2, 0.4, 0.565}},
+    };
+    std::printf("%-14s %9s %16s %16s %16s\n", "modulation", "amplitude", "max duty err", "mean duty err",
+                "max line err");
+    for (const auto& scheme : schemes) {
+        for (double amplitude : scheme.amplitudes) {
+            Accuracy acc{};
+            for (int8_t direction : {int8_t{1}, int8_t{-1}}) {
+                for (uint32_t offset : {0u, 1234u, 9000u}) {
+                    for (double sign : {1.0, -1.0}) {
+                        dial::CommutationConfig cfg{};
+                        cfg.pole_pairs = kPolePairs;
+                        cfg.direction = direction;
+                        cfg.offset = offset;
+                        cfg.max_duty = kMaxDuty;
+                        cfg.modulation = scheme.modulation;
+                        check_kernel(cfg, sign * amplitude, &acc);
+                    }
+                }
+            }
+            std::printf("%-14s %9.3f %11.2f cnt %11.3f cnt %11.2f cnt\n", scheme.name, amplitude,
+                        acc.max_duty_error, acc.sum_duty_error / acc.samples, acc.max_line_error);
+            ok = ok && acc.max_duty_error <= kMaxDutyErrorCounts && acc.max_line_error <= kMaxDutyErrorCounts;
+        }
+    }
+    return ok;
+}
+
+// MotorController::run() before the kernel: one sin for the detent, three
+// for the phases, float-to-duty per phase.
+struct FloatStep {
+    float max_ratio = 0.4f;
+    float detent_strength = 0.6f;
+    float detent_damping = 0.1f;
+    float strength_scale = 1.0f;
+    float electrical_offset = 0.3f;
+    float sensor_direction = 1.0f;
+
+    dial::PhaseDuty operator()(uint16_t raw_angle, int32_t velocity) const {
+        constexpr float kTwoPi = 6.28318530717958647692f;
+        constexpr float kPhaseShift = kTwoPi / 3.0f;
+        const float mech_angle = (static_cast<float>(raw_angle) / 16384.0f) * kTwoPi;
+        const float detent_angle = mech_angle * static_cast<float>(kDetentPositions);
+        const float speed_rps = static_cast<float>(velocity) / 16384.0f;
+        const float torque = -std::sin(detent_angle) - detent_damping * speed_rps;
+        const float gain = std::clamp(detent_strength * strength_scale, 0.0f, 1.0f);
+        const float torque_cmd = std::clamp(gain * torque, -1.0f, 1.0f);
+        const float electrical_angle =
+            mech_angle * static_cast<float>(kPolePairs) * sensor_direction + electrical_offset;
+        const float amplitude = max_ratio * torque_cmd;
+        auto duty = [&](float shift) {
+            const float value = std::clamp(0.5f + amplitude * std::sin(electrical_angle + shift), 0.0f, 1.0f);
+            return static_cast<uint32_t>(value * static_cast<float>(kMaxDuty));
+        };
+        return dial::PhaseDuty{duty(0.0f), duty(-kPhaseShift), duty(kPhaseShift)};
+    }
+};
+
+// MotorController::step() with the kernel.
+struct FixedStep {
+    dial::CommutationKernel kernel;
+    int32_t max_amplitude_q15 = 13107;  // 0.4
+    int32_t detent_strength_q15 = 19661;  // 0.6
+    int32_t damping_q16 = 6554;  // 0.1
+    int32_t strength_q15 = dial::kQ15One;
+
+    explicit FixedStep(dial::Modulation modulation)
+        : kernel(dial::CommutationConfig{kPolePairs, 1, dial::electrical_offset_from_radians(0.3f), kMaxDuty,
+                                         modulation}) {}
+
+    dial::PhaseDuty operator()(uint16_t raw_angle, int32_t velocity) const {
+        const int32_t damping = static_cast<int32_t>((static_cast<int64_t>(velocity) * damping_q16) >> 15);
+        const int32_t torque = -dial::sin_q15(static_cast<uint32_t>(raw_angle) * kDetentPositions) - damping;
+        const int32_t gain = (detent_strength_q15 * strength_q15) >> 15;
+        const int32_t torque_cmd = static_cast<int32_t>(
+            std::clamp<int64_t>((static_cast<int64_t>(gain) * torque) >> 15, -dial::kQ15One, dial::kQ15One));
+        return kernel.update(raw_angle, (max_amplitude_q15 * torque_cmd) >> 15);
+    }
+};
+
+template <typename Step>
+void time_step(const char* name, const Step& step, const std::vector<uint16_t>& angles,
+               const std::vector<int32_t>& velocities, int iterations) {
+    uint64_t sink = 0;
+#ifdef DIAL_HAVE_RDTSC
+    const uint64_t c0 = __rdtsc();
+#endif
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        const size_t idx = static_cast<size_t>(i) & (angles.size() - 1);
+        const dial::PhaseDuty d = step(angles[idx], velocities[idx]);
+        sink += d.u ^ (d.v << 1) ^ (d.w << 2);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+#ifdef DIAL_HAVE_RDTSC
+    const double cycles = static_cast<double>(__rdtsc() - c0) / iterations;
+#else
+    const double cycles = 0.0;
+#endif
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+    std::printf("%-26s %7.1f ns %7.0f TSC cycles per step (sink %llu)\n", name, ns, cycles,
+                static_cast<unsigned long long>(sink & 0xF));
+}
+
+void bench(int iterations) {
+    std::mt19937 rng(11);
+    std::vector<uint16_t> angles(4096);
+    std::vector<int32_t> velocities(angles.size());
+    uint32_t raw = 0;
+    for (size_t i = 0; i < angles.size(); ++i) {
+        raw = (raw + rng() % 64) & dial::kAngleMask;
+        angles[i] = static_cast<uint16_t>(raw);
+        velocities[i] = static_cast<int32_t>(rng() % 65536) - 32768;
+    }
+    time_step("float (pre-kernel)", FloatStep{}, angles, velocities, iterations);
+    time_step("fixed, sinusoidal", FixedStep(dial::Modulation::Sinusoidal), angles, velocities, iterations);
+    time_step("fixed, space vector", FixedStep(dial::Modulation::SpaceVector), angles, velocities, iterations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 4'000'000;
+    const bool ok = check_accuracy();
+    bench(iterations > 0 ? iterations : 4'000'000);
+    if (!ok) {
+        std::printf("FAIL: error above %u counts\n", kMaxDutyErrorCounts);
+    }
+    return ok ? 0 : 1;
+}
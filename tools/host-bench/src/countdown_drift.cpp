@@ -0,0 +1,122 @@
+// Simulated-clock drift harness for the countdown engine.
+//
+// Runs the same countdown twice against a virtual esp_timer with randomised
+// dispatch latency and occasional long stalls (flash commits, LVGL flushes):
+//   - legacy: 1 ms periodic tick decrementing a counter, skip_unhandled_events
+//   - deadline: one-shot at the next visible boundary, remaining from deadline
+// and reports wakeups and end-of-run drift for each.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "timer/countdown.h"
+
+namespace {
+
+constexpr int64_t kUsPerMs = 1000;
+constexpr int64_t kUsPerSecond = 1'000'000;
+
+struct LatencyModel {
+    explicit LatencyModel(uint32_t seed) : rng(seed) {}
+
+    // Typical esp_timer task dispatch jitter plus rare multi-ms stalls.
+    int64_t next() {
+        int64_t latency = std::uniform_int_distribution<int64_t>(20, 400)(rng);
+        if (std::uniform_int_distribution<int>(0, 999)(rng) < 2) {
+            latency += std::uniform_int_distribution<int64_t>(5'000, 40'000)(rng);
+        }
+        return latency;
+    }
+
+    std::mt19937 rng;
+};
+
+struct RunResult {
+    uint64_t wakeups = 0;
+    int64_t drift_us = 0;
+    int64_t max_display_lag_us = 0;
+};
+
+RunResult run_legacy(int64_t duration_ms, uint32_t seed) {
+    LatencyModel latency(seed);
+    RunResult result{};
+
+    int64_t remaining_ms = duration_ms;
+    int64_t busy_until_us = 0;
+    int64_t scheduled_us = kUsPerMs;
+    while (remaining_ms > 0) {
+        if (scheduled_us < busy_until_us) {
+            // Callback still pending when the next period elapsed: skipped.
+            scheduled_us += kUsPerMs;
+            continue;
+        }
+        const int64_t fire_us = scheduled_us + latency.next();
+        busy_until_us = fire_us;
+        ++result.wakeups;
+        remaining_ms -= 1;
+        if (remaining_ms == 0) {
+            result.drift_us = fire_us - duration_ms * kUsPerMs;
+        }
+        scheduled_us += kUsPerMs;
+    }
+    return result;
+}
+
+RunResult run_deadline(int64_t duration_ms, uint32_t seed) {
+    LatencyModel latency(seed);
+    RunResult result{};
+
+    dial::Countdown countdown;
+    int64_t now_us = 0;
+    countdown.start(now_us, duration_ms);
+
+    int64_t shown_seconds = countdown.remaining_us(now_us) / kUsPerSecond;
+    while (true) {
+        const int64_t boundary_us = countdown.next_boundary_us(now_us);
+        now_us = boundary_us + latency.next();
+        ++result.wakeups;
+
+        if (countdown.expired(now_us)) {
+            result.drift_us = now_us - duration_ms * kUsPerMs;
+            break;
+        }
+
+        const int64_t seconds = countdown.remaining_us(now_us) / kUsPerSecond;
+        if (seconds >= shown_seconds) {
+            std::fprintf(stderr, "display did not advance at t=%lld us\n", static_cast<long long>(now_us));
+            std::exit(1);
+        }
+        shown_seconds = seconds;
+        if (now_us - boundary_us > result.max_display_lag_us) {
+            result.max_display_lag_us = now_us - boundary_us;
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const double hours = argc > 1 ? std::atof(argv[1]) : 6.0;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    const int64_t duration_ms = static_cast<int64_t>(hours * 3600.0 * 1000.0);
+
+    const RunResult legacy = run_legacy(duration_ms, seed);
+    const RunResult deadline = run_deadline(duration_ms, seed);
+
+    std::printf("countdown: %.2f h, seed %u\n", hours, seed);
+    std::printf("  legacy   1 ms periodic : wakeups=%llu drift=%+.3f s\n",
+                static_cast<unsigned long long>(legacy.wakeups),
+                static_cast<double>(legacy.drift_us) / kUsPerSecond);
+    std::printf("  deadline one-shot      : wakeups=%llu drift=%+.3f ms (expiry latency only), max display lag=%.3f ms\n",
+                static_cast<unsigned long long>(deadline.wakeups),
+                static_cast<double>(deadline.drift_us) / kUsPerMs,
+                static_cast<double>(deadline.max_display_lag_us) / kUsPerMs);
+    if (deadline.wakeups > 0) {
+        std::printf("  wakeup reduction       : %.0fx\n",
+                    static_cast<double>(legacy.wakeups) / static_cast<double>(deadline.wakeups));
+    }
+    return 0;
+}
@@ -0,0 +1,519 @@
+// Compares the two MT6701 encoder backends of dial::EncoderReader on a
+// simulated knob: the I2C angle poller (AngleTickAccumulator fed by two
+// single-register reads per sample, fixed or SampleRateGovernor-paced) and the ABZ quadrature path (a fake ESP32-S3
+// PCNT unit with glitch filter and +/- limit watch points, decoded with
+// abz_watch_delta and resynced through AbzResync). Both are measured
+// against an ideal counter running the same limit logic on the clean signal.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "input/encoder_ticks.h"
+#include "input/sample_rate.h"
+
+namespace {
+
+constexpr uint32_t kTicksPerRevolution = 96;
+constexpr uint32_t kPulsesPerRevolution = 960;
+constexpr uint32_t kCountsPerRevolution = kPulsesPerRevolution * 4;
+constexpr uint32_t kGlitchFilterNs = 1000;
+constexpr uint64_t kRtosTickUs = 10000;  // CONFIG_FREERTOS_HZ=100
+
+// Cost model. Bus time is ~39 bit times at 400 kHz plus driver turnaround;
+// CPU figures are estimates for the legacy I2C driver, a task switch and the
+// PCNT ISR with xQueueSendFromISR.
+constexpr uint64_t kI2cTransactionUs = 118;
+constexpr double kI2cCpuUs = 45.0;
+constexpr double kTaskWakeCpuUs = 8.0;
+constexpr double kIsrCpuUs = 4.0;
+constexpr uint64_t kYieldUs = 10;
+
+struct Segment {
+    double duration_s;
+    double velocity_rps;  // constant velocity; 0 with wiggle for dithering
+    double wiggle_ticks;  // sinusoidal amplitude around the start position
+    double wiggle_hz;
+    const char* name;
+};
+
+constexpr Segment kProfile[] = {
+    {2.0, 0.0, 0.0, 0.0, "rest"},
+    {2.0, 0.5, 0.0, 0.0, "slow turn"},
+    {0.7, -3.0, 0.0, 0.0, "brisk turn back"},
+    {1.0, 10.0, 0.0, 0.0, "fast spin"},
+    {2.0, 0.0, 0.6, 8.0, "detent dither"},
+    {0.2, -25.0, 0.0, 0.0, "flick"},
+    {1.5, 0.0, 1.4, 3.0, "back-and-forth"},
+    {20.0, 0.0, 0.0, 0.0, "idle"},
+};
+
+struct TickEvent {
+    uint64_t time_us;
+    int32_t delta;
+};
+
+// Behavioural model of one ESP32-S3 PCNT unit as EncoderReader::init_pcnt()
+// configures it: 4x decode from two channels, per-input glitch filter, limits
+// at +/- counts_per_tick with a watch point on each.
+class FakePcnt {
+public:
+    using WatchCallback = std::function<void(int watch_value, uint64_t t_ns)>;
+
+    FakePcnt(int32_t limit, uint32_t glitch_ns, bool a, bool b, WatchCallback callback)
+        : limit_(limit), glitch_ns_(glitch_ns), callback_(std::move(callback)) {
+        inputs_[0].stable = a;
+        inputs_[1].stable = b;
+    }
+
+    void set_input(int line, bool level, uint64_t t_ns) {
+        advance(t_ns);
+        Input& in = inputs_[line];
+        if (glitch_ns_ == 0) {
+            if (level != in.stable) {
+                accept(line, level, t_ns);
+            }
+            return;
+        }
+        if (in.has_pending) {
+            if (level == in.stable) {
+                in.has_pending = false;  // returned before the filter expired
+                ++filtered_;
+            }
+            return;
+        }
+        if (level != in.stable) {
+            in.has_pending = true;
+            in.pending_level = level;
+            in.pending_since_ns = t_ns;
+        }
+    }
+
+    void advance(uint64_t t_ns) {
+        for (int line = 0; line < 2; ++line) {
+            Input& in = inputs_[line];
+            if (in.has_pending && t_ns >= in.pending_since_ns + glitch_ns_) {
+                in.has_pending = false;
+                accept(line, in.pending_level, in.pending_since_ns + glitch_ns_);
+            }
+        }
+    }
+
+    uint64_t filtered() const { return filtered_; }
+
+private:
+    struct Input {
+        bool stable = false;
+        bool has_pending = false;
+        bool pending_level = false;
+        uint64_t pending_since_ns = 0;
+    };
+
+    void accept(int line, bool level, uint64_t t_ns) {
+        const bool other = inputs_[line ^ 1].stable;
+        inputs_[line].stable = level;
+        // Channel A: pos edge DECREASE, neg edge INCREASE, inverted while B is low.
+        // Channel B: pos edge INCREASE, neg edge DECREASE, inverted while A is low.
+        int32_t step = 0;
+        if (line == 0) {
+            step = level ? -1 : 1;
+        } else {
+            step = level ? 1 : -1;
+        }
+        if (!other) {
+            step = -step;
+        }
+        count_ += step;
+        if (count_ >= limit_ || count_ <= -limit_) {
+            const int watch = count_;
+            count_ = 0;
+            callback_(watch, t_ns);
+        }
+    }
+
+    int32_t limit_;
+    uint32_t glitch_ns_;
+    WatchCallback callback_;
+    Input inputs_[2];
+    int32_t count_ = 0;
+    uint64_t filtered_ = 0;
+};
+
+bool quad_a(int64_t q) {
+    const int64_t phase = ((q % 4) + 4) % 4;
+    return phase == 1 || phase == 2;
+}
+
+bool quad_b(int64_t q) {
+    const int64_t phase = ((q % 4) + 4) % 4;
+    return phase == 2 || phase == 3;
+}
+
+uint16_t raw_angle(double revolutions) {
+    double frac = revolutions - std::floor(revolutions);
+    return static_cast<uint16_t>(static_cast<uint32_t>(frac * dial::kMt6701AngleResolution) &
+                                 (dial::kMt6701AngleResolution - 1));
+}
+
+// The firmware's read_raw_angle(): MSB and LSB come from separate transactions.
+// Reads repeat every `period_ticks` RTOS ticks (vTaskDelay), or every
+// `interval_us` from the start of the previous read (esp_timer) when non-zero,
+// with the interval picked by `governor` when one is given.
+class I2cReader {
+public:
+    explicit I2cReader(uint64_t period_ticks, uint64_t interval_us = 0, dial::SampleRateGovernor* governor = nullptr)
+        : period_ticks_(period_ticks), interval_us_(interval_us), governor_(governor) {}
+
+    // Returns true with the assembled raw angle when a read completes at `t_us`.
+    bool step(uint64_t t_us, double revolutions, uint16_t* out) {
+        if (t_us == msb_at_) {
+            msb_ = raw_angle(revolutions) >> 6;
+        }
+        if (t_us == lsb_at_) {
+            lsb_ = raw_angle(revolutions) & 0x3F;
+        }
+        if (t_us != done_at_) {
+            return false;
+        }
+        *out = static_cast<uint16_t>((msb_ << 6) | lsb_);
+        ++reads_;
+        if (governor_ != nullptr) {
+            const int32_t delta_raw = reads_ > 1 ? dial::mt6701_angle_delta(last_raw_, *out) : 0;
+            interval_us_ = governor_->update(delta_raw, static_cast<uint32_t>(start_at_ - last_start_at_));
+        }
+        last_raw_ = *out;
+        schedule(next_start(t_us));
+        return true;
+    }
+
+    void start(uint64_t t_us) { schedule(t_us); }
+    uint64_t reads() const { return reads_; }
+
+private:
+    uint64_t next_start(uint64_t t_us) const {
+        if (interval_us_ != 0) {
+            // EncoderReader::wait_until(): the previous start plus the interval, at least 100 us out.
+            return std::max(start_at_ + interval_us_, t_us + 100);
+        }
+        if (period_ticks_ == 0) {
+            return t_us + kYieldUs;  // vTaskDelay(0) only yields
+        }
+        return (t_us / kRtosTickUs + period_ticks_) * kRtosTickUs;
+    }
+
+    void schedule(uint64_t start_us) {
+        last_start_at_ = start_at_;
+        start_at_ = start_us;
+        msb_at_ = start_us + kI2cTransactionUs / 2;
+        lsb_at_ = msb_at_ + kI2cTransactionUs;
+        done_at_ = start_us + 2 * kI2cTransactionUs;
+    }
+
+    uint64_t period_ticks_;
+    uint64_t interval_us_;
+    dial::SampleRateGovernor* governor_;
+    uint64_t start_at_ = 0;
+    uint64_t last_start_at_ = 0;
+    uint16_t last_raw_ = 0;
+    uint64_t msb_at_ = UINT64_MAX;
+    uint64_t lsb_at_ = UINT64_MAX;
+    uint64_t done_at_ = UINT64_MAX;
+    uint16_t msb_ = 0;
+    uint16_t lsb_ = 0;
+    uint64_t reads_ = 0;
+};
+
+// Latency of each emitted tick against the most recent ideal tick that moved
+// the ideal position to the same value in the same direction.
+class LatencyTracker {
+public:
+    void on_truth(const TickEvent& e) {
+        truth_pos_ += e.delta;
+        (e.delta > 0 ? up_ : down_)[truth_pos_] = e.time_us;
+        ++truth_ticks_;
+    }
+
+    void on_emit(const TickEvent& e) {
+        const int32_t unit = e.delta > 0 ? 1 : -1;
+        for (int32_t i = 0; i < std::abs(e.delta); ++i) {
+            pos_ += unit;
+            ++ticks_;
+            const auto& seen = unit > 0 ? up_ : down_;
+            const auto it = seen.find(pos_);
+            if (it == seen.end() || it->second > e.time_us || e.time_us - it->second > kMatchWindowUs) {
+                ++unmatched_;
+                continue;
+            }
+            latencies_.push_back(e.time_us - it->second);
+        }
+    }
+
+    int32_t position() const { return pos_; }
+    int32_t truth_position() const { return truth_pos_; }
+    uint64_t ticks() const { return ticks_; }
+    uint64_t truth_ticks() const { return truth_ticks_; }
+    uint64_t unmatched() const { return unmatched_; }
+
+    uint64_t percentile(double p) {
+        if (latencies_.empty()) {
+            return 0;
+        }
+        std::sort(latencies_.begin(), latencies_.end());
+        const size_t idx = std::min(latencies_.size() - 1, static_cast<size_t>(p * latencies_.size()));
+        return latencies_[idx];
+    }
+
+private:
+    static constexpr uint64_t kMatchWindowUs = 100000;
+
+    std::unordered_map<int32_t, uint64_t> up_;
+    std::unordered_map<int32_t, uint64_t> down_;
+    std::vector<uint64_t> latencies_;
+    int32_t truth_pos_ = 0;
+    int32_t pos_ = 0;
+    uint64_t truth_ticks_ = 0;
+    uint64_t ticks_ = 0;
+    uint64_t unmatched_ = 0;
+};
+
+struct BackendResult {
+    explicit BackendResult(const char* result_name) : name(result_name) {}
+
+    const char* name;
+    LatencyTracker latency;
+    std::vector<TickEvent> pending;  // emitted, not yet matched (truth may trail by a step)
+    uint64_t i2c_reads = 0;
+    uint64_t isr_events = 0;
+    uint64_t idle_i2c_reads = 0;
+    uint64_t idle_isr_events = 0;
+    uint64_t resync_corrections = 0;
+    uint64_t glitches_filtered = 0;
+    int32_t position = 0;  // EncoderReader::pcnt_position_
+    dial::AbzResync resync{kTicksPerRevolution};
+};
+
+void print_result(BackendResult& r, double total_s, double idle_s) {
+    const double cpu_us = static_cast<double>(r.i2c_reads) * (2 * kI2cCpuUs + kTaskWakeCpuUs) +
+                          static_cast<double>(r.isr_events) * kIsrCpuUs;
+    const double idle_cpu_us = static_cast<double>(r.idle_i2c_reads) * (2 * kI2cCpuUs + kTaskWakeCpuUs) +
+                               static_cast<double>(r.idle_isr_events) * kIsrCpuUs;
+    const double bus_us = static_cast<double>(r.i2c_reads) * 2 * kI2cTransactionUs;
+    std::printf("%-24s ticks %6llu/%-6llu pos %+5d/%+5d unmatched %4llu  latency p50 %6llu p99 %6llu max %6llu us\n",
+                r.name, static_cast<unsigned long long>(r.latency.ticks()),
+                static_cast<unsigned long long>(r.latency.truth_ticks()), r.latency.position(),
+                r.latency.truth_position(), static_cast<unsigned long long>(r.latency.unmatched()),
+                static_cast<unsigned long long>(r.latency.percentile(0.50)),
+                static_cast<unsigned long long>(r.latency.percentile(0.99)),
+                static_cast<unsigned long long>(r.latency.percentile(1.0)));
+    std::printf("%-24s wakeups %8.1f/s (idle %8.1f/s)  I2C bus %5.2f%%  est. CPU %5.2f%% (idle %5.2f%%)"
+                "  resyncs %llu  glitches filtered %llu\n",
+                "", static_cast<double>(r.i2c_reads + r.isr_events) / total_s,
+                static_cast<double>(r.idle_i2c_reads + r.idle_isr_events) / idle_s, bus_us / (total_s * 1e4),
+                cpu_us / (total_s * 1e4), idle_cpu_us / (idle_s * 1e4),
+                static_cast<unsigned long long>(r.resync_corrections),
+                static_cast<unsigned long long>(r.glitches_filtered));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const double glitch_rate_hz = argc > 1 ? std::atof(argv[1]) : 200.0;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    // Whole A/B cycles the filtered unit misses during the fast spin, to give
+    // the I2C resync something to correct.
+    uint32_t lost_cycles = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 0;
+    const uint32_t lost_total = lost_cycles;
+
+    const int32_t counts_per_tick = dial::abz_counts_per_tick(kPulsesPerRevolution, kTicksPerRevolution);
+    if (counts_per_tick == 0) {
+        std::fprintf(stderr, "PPR %u does not divide into %u ticks\n", kPulsesPerRevolution, kTicksPerRevolution);
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> glitch_gap_us(glitch_rate_hz / 1e6);
+    std::uniform_int_distribution<uint32_t> glitch_width_ns(50, kGlitchFilterNs - 50);
+    std::uniform_int_distribution<uint64_t> isr_latency_us(2, 6);
+
+    // Start mid-detent so every path agrees on the initial position.
+    double revolutions = 0.5 / kTicksPerRevolution;
+    int64_t q = static_cast<int64_t>(std::floor(revolutions * kCountsPerRevolution));
+
+    // I2C poller variants: the old vTaskDelay(pdMS_TO_TICKS(5)) loop, which is
+    // zero ticks at 100 Hz; a fixed 5 ms esp_timer; and SampleRateGovernor.
+    dial::SampleRateGovernor governor{dial::SampleRateConfig{}};
+    struct PollPath {
+        BackendResult result;
+        I2cReader reader;
+        dial::AngleTickAccumulator ticks;
+    };
+    PollPath polls[] = {
+        {BackendResult{"i2c vTaskDelay(0)"}, I2cReader(0), dial::AngleTickAccumulator(kTicksPerRevolution)},
+        {BackendResult{"i2c fixed 5 ms"}, I2cReader(0, 5000), dial::AngleTickAccumulator(kTicksPerRevolution)},
+        {BackendResult{"i2c adaptive"}, I2cReader(0, governor.interval_us(), &governor),
+         dial::AngleTickAccumulator(kTicksPerRevolution)},
+    };
+    BackendResult abz{"pcnt abz + filter"};
+    BackendResult abz_unfiltered{"pcnt abz, no filter"};
+    BackendResult* all[] = {&polls[0].result, &polls[1].result, &polls[2].result, &abz, &abz_unfiltered};
+
+    bool idle = false;
+    std::vector<TickEvent> truth_events;
+    FakePcnt truth(counts_per_tick, 0, quad_a(q), quad_b(q), [&](int watch, uint64_t t_ns) {
+        truth_events.push_back(TickEvent{t_ns / 1000, dial::abz_watch_delta(watch)});
+    });
+    auto pcnt_callback = [&](BackendResult& r) {
+        return [&r, &rng, &isr_latency_us, &idle](int watch, uint64_t t_ns) {
+            const int32_t delta = dial::abz_watch_delta(watch);
+            ++r.isr_events;
+            r.idle_isr_events += idle ? 1 : 0;
+            r.position += delta;
+            r.pending.push_back(TickEvent{t_ns / 1000 + isr_latency_us(rng), delta});
+        };
+    };
+    FakePcnt pcnt(counts_per_tick, kGlitchFilterNs, quad_a(q), quad_b(q), pcnt_callback(abz));
+    FakePcnt pcnt_raw(counts_per_tick, 0, quad_a(q), quad_b(q), pcnt_callback(abz_unfiltered));
+
+    I2cReader resync_reader(0, 500000);
+    I2cReader resync_raw_reader(0, 500000);
+    for (PollPath& p : polls) {
+        p.reader.start(0);
+    }
+    resync_reader.start(0);
+    resync_raw_reader.start(0);
+
+    double next_glitch_us = glitch_rate_hz > 0.0 ? glitch_gap_us(rng) : 1e300;
+    uint64_t t_us = 0;
+    double idle_s = 0.0;
+    double total_s = 0.0;
+
+    for (const Segment& seg : kProfile) {
+        idle = seg.velocity_rps == 0.0 && seg.wiggle_ticks == 0.0;
+        const bool lossy = seg.velocity_rps > 5.0;
+        uint32_t skip_edges = 0;
+        const uint64_t seg_start = t_us;
+        const uint64_t seg_end = t_us + static_cast<uint64_t>(seg.duration_s * 1e6);
+        const double base = revolutions;
+        for (; t_us < seg_end; ++t_us) {
+            const double t_s = static_cast<double>(t_us - seg_start) / 1e6;
+            revolutions = base + seg.velocity_rps * t_s +
+                          seg.wiggle_ticks / kTicksPerRevolution * std::sin(2.0 * M_PI * seg.wiggle_hz * t_s);
+            const uint64_t t_ns = t_us * 1000;
+            const int64_t target = static_cast<int64_t>(std::floor(revolutions * kCountsPerRevolution));
+            while (q != target) {
+                const int64_t prev = q;
+                q += target > q ? 1 : -1;
+                const int line = quad_a(prev) != quad_a(q) ? 0 : 1;
+                const bool level = line == 0 ? quad_a(q) : quad_b(q);
+                truth.set_input(line, level, t_ns);
+                if (lossy && skip_edges == 0 && lost_cycles > 0 && q % (4 * counts_per_tick) == 0) {
+                    skip_edges = 4;
+                    --lost_cycles;
+                }
+                if (skip_edges > 0) {
+                    --skip_edges;
+                } else {
+                    pcnt.set_input(line, level, t_ns);
+                }
+                pcnt_raw.set_input(line, level, t_ns);
+            }
+            while (next_glitch_us < static_cast<double>(t_us + 1)) {
+                const int line = static_cast<int>(rng() & 1u);
+                const bool level = line == 0 ? quad_a(q) : quad_b(q);
+                const uint64_t start_ns = static_cast<uint64_t>(next_glitch_us * 1000.0);
+                const uint64_t end_ns = start_ns + glitch_width_ns(rng);
+                for (FakePcnt* unit : {&pcnt, &pcnt_raw}) {
+                    unit->set_input(line, !level, start_ns);
+                    unit->set_input(line, level, end_ns);
+                }
+                next_glitch_us += glitch_gap_us(rng);
+            }
+            truth.advance(t_ns);
+            pcnt.advance(t_ns);
+            pcnt_raw.advance(t_ns);
+
+            uint16_t raw = 0;
+            for (PollPath& p : polls) {
+                if (!p.reader.step(t_us, revolutions, &raw)) {
+                    continue;
+                }
+                const int32_t ticks = p.ticks.update(raw);
+                if (ticks != 0) {
+                    p.result.pending.push_back(TickEvent{t_us, ticks});
+                }
+                p.result.idle_i2c_reads += idle ? 1 : 0;
+            }
+
+            for (const TickEvent& e : truth_events) {
+                for (BackendResult* r : all) {
+                    r->latency.on_truth(e);
+                }
+            }
+            truth_events.clear();
+
+            // EncoderReader::run_abz() resync for both ABZ variants.
+            struct Resync {
+                I2cReader& reader;
+                BackendResult& result;
+            };
+            for (Resync rs : {Resync{resync_reader, abz}, Resync{resync_raw_reader, abz_unfiltered}}) {
+                if (!rs.reader.step(t_us, revolutions, &raw)) {
+                    continue;
+                }
+                BackendResult& r = rs.result;
+                const int32_t correction = r.resync.correction(raw, r.position);
+                if (correction != 0) {
+                    r.position += correction;
+                    ++r.resync_corrections;
+                    r.pending.push_back(TickEvent{t_us, correction});
+                }
+                r.idle_i2c_reads += idle ? 1 : 0;
+            }
+
+            for (BackendResult* r : all) {
+                // ISR events carry a latency past the current step; hold them until due.
+                auto due = std::stable_partition(r->pending.begin(), r->pending.end(),
+                                                 [t_us](const TickEvent& e) { return e.time_us <= t_us; });
+                for (auto it = r->pending.begin(); it != due; ++it) {
+                    r->latency.on_emit(*it);
+                }
+                r->pending.erase(r->pending.begin(), due);
+            }
+        }
+        const double seg_s = seg.duration_s;
+        total_s += seg_s;
+        idle_s += idle ? seg_s : 0.0;
+    }
+
+    for (PollPath& p : polls) {
+        p.result.i2c_reads = p.reader.reads();
+    }
+    abz.i2c_reads = resync_reader.reads();
+    abz_unfiltered.i2c_reads = resync_raw_reader.reads();
+    abz.glitches_filtered = pcnt.filtered();
+
+    std::printf("MT6701 encoder backends: %.1f s profile, %u PPR (%d counts/tick), %.0f glitches/s < %u ns, "
+                "%u A/B cycles lost by the filtered unit, seed %u\n",
+                total_s, kPulsesPerRevolution, counts_per_tick, glitch_rate_hz, kGlitchFilterNs, lost_total, seed);
+    for (BackendResult* r : all) {
+        print_result(*r, total_s, idle_s);
+    }
+
+    // Lost cycles are made good by the resync only to within its one-tick
+    // slack; without them the filtered path must match tick for tick.
+    const int32_t position_error = abz.latency.position() - abz.latency.truth_position();
+    const bool abz_ok = lost_total > 0 ? std::abs(position_error) <= 1
+                                       : position_error == 0 && abz.latency.unmatched() == 0 &&
+                                             abz.latency.ticks() == abz.latency.truth_ticks();
+    if (!abz_ok) {
+        std::printf("FAIL: filtered ABZ path diverged from the ideal counter\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+// POSIX stand-in for a FreeRTOS queue: fixed-size item storage copied in and
+// out under a mutex (the host analogue of the kernel critical section), with a
+// condition variable for blocking receives, plus a task-notification stand-in.
+// Only what the benchmarks need.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace host_bench {
+
+class PosixQueue {
+public:
+    PosixQueue(size_t length, size_t item_size)
+        : storage_(length * item_size), length_(length), item_size_(item_size) {}
+
+    bool send(const void* item, std::chrono::microseconds timeout = std::chrono::microseconds::zero()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (count_ == length_ && !space_.wait_for(lock, timeout, [this] { return count_ < length_; })) {
+            return false;
+        }
+        std::memcpy(&storage_[tail_ * item_size_], item, item_size_);
+        tail_ = (tail_ + 1) % length_;
+        ++count_;
+        lock.unlock();
+        items_.notify_one();
+        return true;
+    }
+
+    // xQueueOverwrite: only meaningful for length-1 queues.
+    void overwrite(const void* item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::memcpy(storage_.data(), item, item_size_);
+            head_ = 0;
+            tail_ = 0;
+            count_ = 1;
+        }
+        items_.notify_all();
+    }
+
+    bool receive(void* item, std::chrono::microseconds timeout = std::chrono::microseconds::zero()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (count_ == 0 && !items_.wait_for(lock, timeout, [this] { return count_ > 0; })) {
+            return false;
+        }
+        std::memcpy(item, &storage_[head_ * item_size_], item_size_);
+        head_ = (head_ + 1) % length_;
+        --count_;
+        lock.unlock();
+        space_.notify_one();
+        return true;
+    }
+
+    bool peek(void* item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0) {
+            return false;
+        }
+        std::memcpy(item, &storage_[head_ * item_size_], item_size_);
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable items_;
+    std::condition_variable space_;
+    std::vector<uint8_t> storage_;
+    size_t length_;
+    size_t item_size_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+    size_t count_ = 0;
+};
+
+// Stand-in for a direct-to-task notification used as a counting semaphore
+// (xTaskNotifyGive / ulTaskNotifyTake(pdTRUE, ...)).
+class PosixTaskNotify {
+public:
+    void give() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++count_;
+        }
+        cond_.notify_one();
+    }
+
+    // Returns the pending count and clears it; 0 on timeout.
+    uint32_t take(std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (count_ == 0 && !cond_.wait_for(lock, timeout, [this] { return count_ > 0; })) {
+            return 0;
+        }
+        const uint32_t count = count_;
+        count_ = 0;
+        return count;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    uint32_t count_ = 0;
+};
+
+}  // namespace host_bench
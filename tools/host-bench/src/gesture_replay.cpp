@@ -0,0 +1,631 @@
+// Replays touch traces through dial::GestureRecognizer, the engine the touch
+// task runs, and through a copy of the inline recognizer it replaced
+// (TouchInput::run_hardware() before the extraction), so GestureConfig
+// thresholds can be tuned without flashing.
+//
+// Traces are the console lines TouchTraceRecorder prints (`trace,S,...` for
+// samples, `trace,E,...` for the events the device reported, which serve as
+// the labels; edit them to relabel). Other lines are ignored, so a whole
+// `idf.py monitor` log can be passed. Without trace arguments, labelled
+// sessions are synthesised for both gesture sources: taps, double taps, long
+// presses, swipes and two-finger taps with human-scale spread around the
+// default thresholds, sampled on the firmware's schedule (INT wake, then
+// vTaskDelay at a 100 Hz tick; 10 ms 5-byte reads for Software, 30 ms
+// 12-byte bursts with the controller's gesture ID for Hardware).
+//
+// Arguments of the form `field=value` override GestureConfig fields, e.g.
+// `gesture_replay double_tap_max_interval_ms=400 swipe_min_distance=50`.
+//
+// Reports per-trace and per-gesture accuracy and the update() cost per
+// sample for both recognizers.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DIAL_HAVE_RDTSC 1
+#endif
+
+#include "input/gesture_recognizer.h"
+
+namespace {
+
+using dial::GestureConfig;
+using dial::TouchEvent;
+using dial::TouchEventType;
+using dial::TouchGesture;
+using dial::TouchSample;
+
+constexpr int64_t kTickUs = 10'000;  // CONFIG_FREERTOS_HZ=100
+constexpr int64_t kLabelSlackUs = 50'000;
+constexpr size_t kTypeCount = 8;
+
+const char* const kTypeNames[kTypeCount] = {"tap",        "double tap", "long press",  "swipe up",
+                                            "swipe down", "swipe left", "swipe right", "two-finger"};
+
+const char* type_name(TouchEventType type) {
+    const size_t i = static_cast<size_t>(type);
+    return i < kTypeCount ? kTypeNames[i] : "?";
+}
+
+// An event of `type` is expected in [from_us, to_us).
+struct Label {
+    int64_t from_us;
+    int64_t to_us;
+    TouchEventType type;
+};
+
+struct Trace {
+    std::string name;
+    std::vector<TouchSample> samples;  // contact samples only; idle wakes are added on replay
+    std::vector<Label> labels;
+};
+
+struct Emitted {
+    int64_t timestamp_us;
+    TouchEventType type;
+};
+
+// --- TouchInput::run_hardware() before the recognizer was extracted --------
+
+class LegacyRecognizer {
+public:
+    explicit LegacyRecognizer(const GestureConfig& config) : config_(config) {}
+
+    bool contact_active() const { return last_active_ || multi_active_; }
+    bool tap_pending() const { return pending_tap_; }
+    int64_t tap_deadline_us() const { return pending_tap_deadline_us_; }
+
+    size_t update(const TouchSample& sample, TouchEvent* out) {
+        size_t count = 0;
+        const int64_t now_us = sample.timestamp_us;
+        if (pending_tap_ && !last_active_ && !multi_active_ && now_us >= pending_tap_deadline_us_) {
+            out[count++] = pending_tap_event_;
+            pending_tap_ = false;
+        }
+
+        const dial::TouchReport& report = sample.report;
+        const uint8_t touches = report.touch_count;
+        if (report.gesture != TouchGesture::None) {
+            contact_gesture_ = report.gesture;
+        }
+        int64_t contact_start_us = now_us;
+        if (touches > 0 && !last_active_ && !multi_active_ && sample.contact_start_us >= 0) {
+            contact_start_us = sample.contact_start_us;
+        }
+
+        if (touches >= 2 && !multi_active_) {
+            multi_active_ = true;
+            multi_start_us_ = contact_start_us;
+            last_active_ = false;
+        }
+
+        if (touches == 1 && !multi_active_) {
+            last_x_ = report.x[0];
+            last_y_ = report.y[0];
+            if (!last_active_) {
+                start_x_ = report.x[0];
+                start_y_ = report.y[0];
+                start_us_ = contact_start_us;
+                long_press_reported_ = false;
+            } else if (!long_press_reported_ &&
+                       (now_us - start_us_) / 1000 >= static_cast<int64_t>(config_.long_press_min_duration_ms)) {
+                out[count++] = event(TouchEventType::LongPress, start_us_, now_us);
+                long_press_reported_ = true;
+            }
+            last_active_ = true;
+        } else if (touches == 0) {
+            if (multi_active_) {
+                out[count++] = event(TouchEventType::TwoFingerTap, multi_start_us_, now_us);
+                multi_active_ = false;
+                last_active_ = false;
+                pending_tap_ = false;
+            } else if (last_active_) {
+                const int64_t duration_ms = (now_us - start_us_) / 1000;
+                const int32_t dx = static_cast<int32_t>(last_x_) - static_cast<int32_t>(start_x_);
+                const int32_t dy = static_cast<int32_t>(last_y_) - static_cast<int32_t>(start_y_);
+                const int32_t movement = std::max(std::abs(dx), std::abs(dy));
+                const bool is_swipe = movement >= config_.swipe_min_distance &&
+                                      duration_ms <= static_cast<int64_t>(config_.swipe_max_duration_ms);
+                const bool is_tap = movement <= config_.tap_max_movement &&
+                                    duration_ms <= static_cast<int64_t>(config_.tap_max_duration_ms);
+                int32_t hx = 0;
+                int32_t hy = 0;
+                switch (contact_gesture_) {
+                    case TouchGesture::MoveUp: hy = -1; break;
+                    case TouchGesture::MoveDown: hy = 1; break;
+                    case TouchGesture::MoveLeft: hx = -1; break;
+                    case TouchGesture::MoveRight: hx = 1; break;
+                    default: break;
+                }
+                if (hx != 0 || hy != 0) {
+                    out[count++] = swipe(hx, hy, now_us);
+                    pending_tap_ = false;
+                } else if (is_swipe) {
+                    out[count++] = swipe(dx, dy, now_us);
+                    pending_tap_ = false;
+                } else if (!long_press_reported_ && is_tap) {
+                    const int64_t interval_us = static_cast<int64_t>(config_.double_tap_max_interval_ms) * 1000;
+                    if (pending_tap_ && now_us - pending_tap_timestamp_us_ <= interval_us) {
+                        out[count++] = event(TouchEventType::DoubleTap, start_us_, now_us);
+                        pending_tap_ = false;
+                    } else {
+                        pending_tap_event_ = event(TouchEventType::Tap, start_us_, now_us);
+                        pending_tap_timestamp_us_ = now_us;
+                        pending_tap_deadline_us_ = now_us + interval_us;
+                        pending_tap_ = true;
+                    }
+                }
+            }
+            last_active_ = false;
+            contact_gesture_ = TouchGesture::None;
+        }
+        return count;
+    }
+
+private:
+    TouchEvent event(TouchEventType type, int64_t since_us, int64_t now_us) const {
+        TouchEvent e{};
+        e.type = type;
+        e.x = start_x_;
+        e.y = start_y_;
+        e.duration_ms = static_cast<uint32_t>((now_us - since_us) / 1000);
+        return e;
+    }
+
+    TouchEvent swipe(int32_t dx, int32_t dy, int64_t now_us) const {
+        const TouchEventType type = std::abs(dy) >= std::abs(dx)
+                                        ? (dy < 0 ? TouchEventType::SwipeUp : TouchEventType::SwipeDown)
+                                        : (dx < 0 ? TouchEventType::SwipeLeft : TouchEventType::SwipeRight);
+        return event(type, start_us_, now_us);
+    }
+
+    GestureConfig config_;
+    bool last_active_ = false;
+    bool multi_active_ = false;
+    bool long_press_reported_ = false;
+    uint16_t start_x_ = 0;
+    uint16_t start_y_ = 0;
+    uint16_t last_x_ = 0;
+    uint16_t last_y_ = 0;
+    int64_t start_us_ = 0;
+    int64_t multi_start_us_ = 0;
+    TouchGesture contact_gesture_ = TouchGesture::None;
+    bool pending_tap_ = false;
+    TouchEvent pending_tap_event_{};
+    int64_t pending_tap_timestamp_us_ = 0;
+    int64_t pending_tap_deadline_us_ = 0;
+};
+
+// --- Synthetic sessions ----------------------------------------------------
+
+struct Stroke {
+    int64_t t0_us;
+    int64_t t1_us;
+    double x0, y0, x1, y1;           // finger path, linear in time
+    int64_t second_from_us = -1;     // second finger down over [second_from_us, second_to_us)
+    int64_t second_to_us = -1;
+    TouchGesture gesture = TouchGesture::None;  // reported from gesture_from_us on
+    int64_t gesture_from_us = 0;
+};
+
+class SessionBuilder {
+public:
+    SessionBuilder(const char* name, bool hardware, uint32_t seed)
+        : hardware_(hardware), rng_(seed) {
+        trace_.name = name;
+    }
+
+    double normal(double mean, double sd, double lo, double hi) {
+        return std::clamp(std::normal_distribution<double>(mean, sd)(rng_), lo, hi);
+    }
+    double uniform(double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng_); }
+
+    // Samples one contact the way the touch task would: the INT edge wakes
+    // it, then it reads every poll interval (vTaskDelay, tick aligned) until a
+    // read sees no contact.
+    void add_stroke(const Stroke& s) {
+        const int64_t period_ticks = hardware_ ? 3 : 1;
+        std::normal_distribution<double> noise(0.0, 1.5);
+        int64_t t_us = s.t0_us + static_cast<int64_t>(uniform(300, 1500));
+        bool first = true;
+        while (true) {
+            TouchSample sample{};
+            sample.timestamp_us = t_us;
+            const bool down = t_us < s.t1_us;
+            if (down) {
+                const double f = static_cast<double>(t_us - s.t0_us) / static_cast<double>(s.t1_us - s.t0_us);
+                const auto px = static_cast<uint16_t>(std::clamp(s.x0 + (s.x1 - s.x0) * f + noise(rng_), 0.0, 239.0));
+                const auto py = static_cast<uint16_t>(std::clamp(s.y0 + (s.y1 - s.y0) * f + noise(rng_), 0.0, 239.0));
+                const bool second = t_us >= s.second_from_us && t_us < s.second_to_us;
+                sample.report.touch_count = second ? 2 : 1;
+                sample.report.x[0] = sample.report.x[1] = px;
+                sample.report.y[0] = sample.report.y[1] = py;
+                if (second && hardware_) {
+                    sample.report.x[1] = static_cast<uint16_t>(std::min(239, px + 30));
+                }
+            }
+            if (hardware_ && s.gesture != TouchGesture::None && t_us >= s.gesture_from_us) {
+                sample.report.gesture = s.gesture;
+            }
+            if (first) {
+                sample.contact_start_us = s.t0_us;
+                first = false;
+            }
+            trace_.samples.push_back(sample);
+            if (!down) {
+                break;
+            }
+            const int64_t exec_us = static_cast<int64_t>(uniform(20, 200));
+            t_us = (t_us / kTickUs + period_ticks) * kTickUs + exec_us;
+        }
+    }
+
+    void add_label(int64_t from_us, TouchEventType type) { trace_.labels.push_back(Label{from_us, 0, type}); }
+
+    Trace finish(int64_t end_us) {
+        for (size_t i = 0; i < trace_.labels.size(); ++i) {
+            trace_.labels[i].to_us = i + 1 < trace_.labels.size() ? trace_.labels[i + 1].from_us : end_us;
+        }
+        return std::move(trace_);
+    }
+
+    bool hardware() const { return hardware_; }
+    std::mt19937& rng() { return rng_; }
+
+private:
+    bool hardware_;
+    std::mt19937 rng_;
+    Trace trace_;
+};
+
+Stroke tap_stroke(SessionBuilder& b, int64_t t0_us, double mean_ms) {
+    const double x = b.uniform(30, 210);
+    const double y = b.uniform(30, 210);
+    const int64_t duration_us = static_cast<int64_t>(b.normal(mean_ms, mean_ms * 0.4, 30, 700) * 1000);
+    return Stroke{t0_us, t0_us + duration_us, x, y, x + b.normal(0, 8, -50, 50), y + b.normal(0, 8, -50, 50)};
+}
+
+Trace synthesize(const char* name, bool hardware, int gestures, uint32_t seed) {
+    SessionBuilder b(name, hardware, seed);
+    std::bernoulli_distribution hw_reports(0.85);
+    int64_t t_us = 500'000;
+    for (int i = 0; i < gestures; ++i) {
+        const int kind = static_cast<int>(b.rng()() % 5);
+        switch (kind) {
+            case 0: {
+                b.add_label(t_us, TouchEventType::Tap);
+                const Stroke s = tap_stroke(b, t_us, 150);
+                b.add_stroke(s);
+                t_us = s.t1_us;
+                break;
+            }
+            case 1: {
+                b.add_label(t_us, TouchEventType::DoubleTap);
+                const Stroke first = tap_stroke(b, t_us, 110);
+                b.add_stroke(first);
+                Stroke second = tap_stroke(b, first.t1_us + static_cast<int64_t>(b.normal(170, 70, 40, 500) * 1000), 110);
+                second.x0 = first.x0 + b.normal(0, 6, -30, 30);
+                second.y0 = first.y0 + b.normal(0, 6, -30, 30);
+                second.x1 = second.x0 + b.normal(0, 5, -30, 30);
+                second.y1 = second.y0 + b.normal(0, 5, -30, 30);
+                b.add_stroke(second);
+                t_us = second.t1_us;
+                break;
+            }
+            case 2: {
+                b.add_label(t_us, TouchEventType::LongPress);
+                const double x = b.uniform(40, 200);
+                const double y = b.uniform(40, 200);
+                const int64_t hold_us = static_cast<int64_t>(b.normal(950, 250, 450, 2500) * 1000);
+                const Stroke s{t_us, t_us + hold_us, x, y, x + b.normal(0, 6, -40, 40), y + b.normal(0, 6, -40, 40)};
+                b.add_stroke(s);
+                t_us = s.t1_us;
+                break;
+            }
+            case 3: {
+                const int dir = static_cast<int>(b.rng()() % 4);
+                const TouchEventType types[] = {TouchEventType::SwipeUp, TouchEventType::SwipeDown,
+                                                TouchEventType::SwipeLeft, TouchEventType::SwipeRight};
+                const TouchGesture ids[] = {TouchGesture::MoveUp, TouchGesture::MoveDown, TouchGesture::MoveLeft,
+                                            TouchGesture::MoveRight};
+                const double dirs[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+                b.add_label(t_us, types[dir]);
+                const double distance = b.normal(115, 30, 30, 200);
+                const double wobble = b.normal(0, 12, -40, 40);
+                const double x0 = 120 - dirs[dir][0] * distance / 2 + dirs[dir][1] * wobble;
+                const double y0 = 120 - dirs[dir][1] * distance / 2 + dirs[dir][0] * wobble;
+                const int64_t duration_us = static_cast<int64_t>(b.normal(260, 110, 70, 1000) * 1000);
+                Stroke s{t_us, t_us + duration_us, x0, y0, x0 + dirs[dir][0] * distance, y0 + dirs[dir][1] * distance};
+                if (b.hardware() && distance >= 50 && hw_reports(b.rng())) {
+                    s.gesture = ids[dir];
+                    s.gesture_from_us = t_us + duration_us * 6 / 10;
+                }
+                b.add_stroke(s);
+                t_us = s.t1_us;
+                break;
+            }
+            default: {
+                b.add_label(t_us, TouchEventType::TwoFingerTap);
+                Stroke s = tap_stroke(b, t_us, 170);
+                s.second_from_us = t_us + static_cast<int64_t>(b.uniform(0, 40'000));
+                s.second_to_us = s.t1_us;
+                s.t1_us += static_cast<int64_t>(b.uniform(0, 30'000));
+                b.add_stroke(s);
+                t_us = s.t1_us;
+                break;
+            }
+        }
+        t_us += static_cast<int64_t>(b.uniform(700, 1500) * 1000);
+    }
+    return b.finish(t_us);
+}
+
+// --- Recorded traces -------------------------------------------------------
+
+bool load_trace(const char* path, Trace* out) {
+    FILE* f = std::fopen(path, "r");
+    if (f == nullptr) {
+        return false;
+    }
+    out->name = path;
+    char line[256];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        const char* p = std::strstr(line, "trace,");
+        if (p == nullptr) {
+            continue;
+        }
+        long long ts = 0;
+        long long start = 0;
+        unsigned v[6] = {};
+        if (std::sscanf(p, "trace,S,%lld,%lld,%u,%u,%u,%u,%u,%u", &ts, &start, &v[0], &v[1], &v[2], &v[3], &v[4],
+                        &v[5]) == 8) {
+            TouchSample sample{};
+            sample.timestamp_us = ts;
+            sample.contact_start_us = start;
+            sample.report.touch_count = static_cast<uint8_t>(v[0]);
+            sample.report.gesture = static_cast<TouchGesture>(v[1]);
+            sample.report.x[0] = static_cast<uint16_t>(v[2]);
+            sample.report.y[0] = static_cast<uint16_t>(v[3]);
+            sample.report.x[1] = static_cast<uint16_t>(v[4]);
+            sample.report.y[1] = static_cast<uint16_t>(v[5]);
+            out->samples.push_back(sample);
+        } else if (std::sscanf(p, "trace,E,%lld,%u", &ts, &v[0]) == 2 && v[0] < kTypeCount) {
+            out->labels.push_back(Label{ts - kLabelSlackUs, ts + kLabelSlackUs, static_cast<TouchEventType>(v[0])});
+        }
+    }
+    std::fclose(f);
+    return !out->samples.empty();
+}
+
+// --- Replay and scoring ----------------------------------------------------
+
+// Feeds a trace the way the touch task would see it: the recorded samples,
+// plus the wakeups its idle wait takes for a pending tap (ulTaskNotifyTake
+// with pdMS_TO_TICKS(due) + 1 ticks between contacts, repeated until the tap
+// is reported).
+// Returns the emitted events and, in `fed`, every sample actually fed.
+template <typename Recognizer>
+std::vector<Emitted> replay(Recognizer& recognizer, const Trace& trace, std::vector<TouchSample>* fed) {
+    std::vector<Emitted> emitted;
+    TouchEvent events[dial::kMaxGestureEvents];
+    auto feed = [&](const TouchSample& sample) {
+        if (fed != nullptr) {
+            fed->push_back(sample);
+        }
+        const size_t n = recognizer.update(sample, events);
+        for (size_t i = 0; i < n; ++i) {
+            emitted.push_back(Emitted{sample.timestamp_us, events[i].type});
+        }
+    };
+    auto idle_until = [&](int64_t last_us, int64_t next_us) {
+        while (!recognizer.contact_active() && recognizer.tap_pending()) {
+            const int64_t due_us = std::max<int64_t>(0, recognizer.tap_deadline_us() - last_us);
+            const int64_t wake_us = (last_us / kTickUs + due_us / kTickUs + 1) * kTickUs + 50;
+            if (wake_us >= next_us) {
+                return;
+            }
+            TouchSample idle{};
+            idle.timestamp_us = wake_us;
+            feed(idle);
+            last_us = wake_us;
+        }
+    };
+
+    int64_t last_us = 0;
+    for (const TouchSample& sample : trace.samples) {
+        idle_until(last_us, sample.timestamp_us);
+        feed(sample);
+        last_us = sample.timestamp_us;
+    }
+    idle_until(last_us, INT64_MAX);
+    return emitted;
+}
+
+struct Score {
+    uint32_t labels = 0;
+    uint32_t correct = 0;
+    uint32_t extra = 0;  // events outside every label window
+    uint32_t per_type[kTypeCount][2] = {};  // {labels, correct}
+};
+
+// A label is correct when its window holds exactly one event, of its type.
+Score score(const Trace& trace, const std::vector<Emitted>& emitted) {
+    Score s{};
+    std::vector<bool> used(emitted.size(), false);
+    for (const Label& label : trace.labels) {
+        uint32_t in_window = 0;
+        bool match = false;
+        for (size_t i = 0; i < emitted.size(); ++i) {
+            if (!used[i] && emitted[i].timestamp_us >= label.from_us && emitted[i].timestamp_us < label.to_us) {
+                ++in_window;
+                used[i] = true;
+                match = match || emitted[i].type == label.type;
+            }
+        }
+        const bool correct = match && in_window == 1;
+        ++s.labels;
+        s.correct += correct ? 1 : 0;
+        ++s.per_type[static_cast<size_t>(label.type)][0];
+        s.per_type[static_cast<size_t>(label.type)][1] += correct ? 1 : 0;
+    }
+    for (bool u : used) {
+        s.extra += u ? 0 : 1;
+    }
+    return s;
+}
+
+void accumulate(Score* total, const Score& s) {
+    total->labels += s.labels;
+    total->correct += s.correct;
+    total->extra += s.extra;
+    for (size_t t = 0; t < kTypeCount; ++t) {
+        total->per_type[t][0] += s.per_type[t][0];
+        total->per_type[t][1] += s.per_type[t][1];
+    }
+}
+
+double percent(uint32_t part, uint32_t whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+struct Cost {
+    double ns = 0.0;
+    double cycles = 0.0;
+};
+
+template <typename Make>
+Cost update_cost(const std::vector<TouchSample>& samples, Make make) {
+    constexpr size_t kTarget = 4'000'000;
+    const size_t passes = std::max<size_t>(1, kTarget / std::max<size_t>(1, samples.size()));
+    TouchEvent events[dial::kMaxGestureEvents];
+    size_t sink = 0;
+#ifdef DIAL_HAVE_RDTSC
+    const uint64_t c0 = __rdtsc();
+#endif
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < passes; ++pass) {
+        auto recognizer = make();
+        for (const TouchSample& sample : samples) {
+            sink += recognizer.update(sample, events);
+        }
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double updates = static_cast<double>(passes * samples.size());
+    Cost cost{};
+#ifdef DIAL_HAVE_RDTSC
+    cost.cycles = static_cast<double>(__rdtsc() - c0) / updates;
+#endif
+    cost.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / updates;
+    if (sink == 0) {
+        std::printf("?");
+    }
+    return cost;
+}
+
+struct Field {
+    const char* name;
+    void (*set)(GestureConfig&, unsigned long);
+    unsigned long (*get)(const GestureConfig&);
+};
+
+#define DIAL_GESTURE_FIELD(f)                                                                          \
+    Field {                                                                                            \
+        #f, [](GestureConfig& c, unsigned long v) { c.f = static_cast<decltype(c.f)>(v); },            \
+            [](const GestureConfig& c) { return static_cast<unsigned long>(c.f); }                     \
+    }
+
+const Field kFields[] = {
+    DIAL_GESTURE_FIELD(tap_max_duration_ms),   DIAL_GESTURE_FIELD(double_tap_max_interval_ms),
+    DIAL_GESTURE_FIELD(long_press_min_duration_ms), DIAL_GESTURE_FIELD(tap_max_movement),
+    DIAL_GESTURE_FIELD(swipe_min_distance),    DIAL_GESTURE_FIELD(swipe_max_duration_ms),
+    DIAL_GESTURE_FIELD(edge_zone_percent),     DIAL_GESTURE_FIELD(screen_width),
+    DIAL_GESTURE_FIELD(screen_height),
+};
+
+bool parse_override(const char* arg, GestureConfig* config) {
+    const char* eq = std::strchr(arg, '=');
+    if (eq == nullptr) {
+        return false;
+    }
+    for (const Field& field : kFields) {
+        if (std::strlen(field.name) == static_cast<size_t>(eq - arg) && std::strncmp(arg, field.name, eq - arg) == 0) {
+            field.set(*config, std::strtoul(eq + 1, nullptr, 10));
+            return true;
+        }
+    }
+    std::fprintf(stderr, "unknown GestureConfig field in %s\n", arg);
+    std::exit(1);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    GestureConfig config{};
+    std::vector<Trace> traces;
+    for (int i = 1; i < argc; ++i) {
+        if (parse_override(argv[i], &config)) {
+            continue;
+        }
+        Trace trace;
+        if (!load_trace(argv[i], &trace)) {
+            std::fprintf(stderr, "cannot read trace %s\n", argv[i]);
+            return 1;
+        }
+        traces.push_back(std::move(trace));
+    }
+    if (traces.empty()) {
+        traces.push_back(synthesize("software, 10 ms reads", false, 400, 1));
+        traces.push_back(synthesize("hardware, 30 ms bursts", true, 400, 2));
+    }
+
+    std::printf("GestureConfig:");
+    for (const Field& field : kFields) {
+        std::printf(" %s=%lu", field.name, field.get(config));
+    }
+    std::printf("\n\n%-26s %7s %8s %16s %16s\n", "trace", "labels", "samples", "table correct", "legacy correct");
+
+    Score table_total{};
+    Score legacy_total{};
+    std::vector<TouchSample> fed;
+    for (const Trace& trace : traces) {
+        dial::GestureRecognizer table(config);
+        LegacyRecognizer legacy(config);
+        const size_t before = fed.size();
+        const Score t = score(trace, replay(table, trace, &fed));
+        const Score l = score(trace, replay(legacy, trace, nullptr));
+        accumulate(&table_total, t);
+        accumulate(&legacy_total, l);
+        std::printf("%-26s %7u %8zu %9u %5.1f%% %9u %5.1f%%\n", trace.name.c_str(), t.labels, fed.size() - before,
+                    t.correct, percent(t.correct, t.labels), l.correct, percent(l.correct, l.labels));
+        if (t.extra != 0 || l.extra != 0) {
+            std::printf("%-26s unlabelled events: table %u, legacy %u\n", "", t.extra, l.extra);
+        }
+    }
+
+    std::printf("\n%-12s %7s %14s %14s\n", "gesture", "labels", "table", "legacy");
+    for (size_t type = 0; type < kTypeCount; ++type) {
+        const uint32_t n = table_total.per_type[type][0];
+        if (n == 0) {
+            continue;
+        }
+        std::printf("%-12s %7u %7u %5.1f%% %7u %5.1f%%\n", type_name(static_cast<TouchEventType>(type)), n,
+                    table_total.per_type[type][1], percent(table_total.per_type[type][1], n),
+                    legacy_total.per_type[type][1], percent(legacy_total.per_type[type][1], n));
+    }
+
+    const Cost table_cost = update_cost(fed, [&] { return dial::GestureRecognizer(config); });
+    const Cost legacy_cost = update_cost(fed, [&] { return LegacyRecognizer(config); });
+    std::printf("\nupdate() per sample: table %.1f ns (%.0f TSC cycles), legacy %.1f ns (%.0f TSC cycles)\n",
+                table_cost.ns, table_cost.cycles, legacy_cost.ns, legacy_cost.cycles);
+    return 0;
+}
@@ -0,0 +1,288 @@
+// Renders dial::HapticEffectEngine torque traces the way MotorController's
+// loop calls it (one render() per alarm at 2 kHz) for each effect alone, a
+// detent sweep, a push into an end-stop wall and a mix of everything, and
+// checks the properties the loop relies on: torque stays within Q15 full
+// scale, every voice ends at duration_us(), a flood of commands is dropped at
+// the ring instead of blocking, and a render drains a bounded number of them.
+// Then times render() with the detent field alone and fully loaded.
+//
+// With a file argument the traces are written as CSV
+// (`scenario,t_us,raw,velocity,torque_q15`) for plotting.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DIAL_HAVE_RDTSC 1
+#endif
+
+#include "haptics/commutation.h"
+#include "haptics/haptic_effects.h"
+#include "input/encoder_ticks.h"
+
+namespace {
+
+constexpr uint32_t kLoopPeriodUs = 500;  // MotorController default, 2 kHz
+constexpr uint32_t kStartUs = 1000000;
+constexpr double kRawPerTurn = dial::kMt6701AngleResolution;
+
+struct Sample {
+    uint32_t t_us;
+    uint16_t raw;
+    int32_t velocity;
+    int32_t torque;
+};
+
+struct Trace {
+    std::string name;
+    std::vector<Sample> samples;
+};
+
+// Knob motion for a scenario: raw angle (unwrapped) and velocity in raw/s.
+struct Motion {
+    double angle;
+    double velocity;
+};
+
+template <typename MotionFn, typename EventFn>
+Trace render_trace(const char* name, dial::HapticEffectEngine& engine, uint32_t duration_us, MotionFn motion,
+                   EventFn on_step) {
+    Trace trace{name, {}};
+    for (uint32_t t = 0; t < duration_us; t += kLoopPeriodUs) {
+        on_step(t);
+        const Motion m = motion(t);
+        const auto raw = static_cast<uint16_t>(static_cast<int64_t>(std::floor(m.angle)) &
+                                               (dial::kMt6701AngleResolution - 1));
+        const auto velocity = static_cast<int32_t>(m.velocity);
+        trace.samples.push_back(Sample{t, raw, velocity, engine.render(raw, velocity, kStartUs + t)});
+    }
+    return trace;
+}
+
+dial::HapticEffectConfig no_detents() {
+    dial::HapticEffectConfig config{};
+    config.detent_strength_q15 = 0;
+    return config;
+}
+
+int32_t peak(const Trace& trace) {
+    int32_t out = 0;
+    for (const Sample& s : trace.samples) {
+        out = std::max(out, std::abs(s.torque));
+    }
+    return out;
+}
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", what);
+    }
+    return condition;
+}
+
+const char* effect_name(dial::HapticEffect effect) {
+    switch (effect) {
+        case dial::HapticEffect::Click:
+            return "click";
+        case dial::HapticEffect::Buzz:
+            return "buzz";
+        case dial::HapticEffect::FinalMinute:
+            return "final_minute";
+        default:
+            return "?";
+    }
+}
+
+void bench_render(const char* label, dial::HapticEffectEngine& engine, bool loaded) {
+    constexpr int kRenders = 2000000;
+    int64_t sink = 0;
+    uint32_t now_us = kStartUs;
+    double angle = 0.0;
+#ifdef DIAL_HAVE_RDTSC
+    const uint64_t c0 = __rdtsc();
+#endif
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRenders; ++i) {
+        // Keep every voice busy: re-trigger before the shortest one ends.
+        if (loaded && (i & 7) == 0) {
+            engine.play(static_cast<dial::HapticEffect>((i >> 3) % 3));
+        }
+        angle += 8.0;
+        sink += engine.render(static_cast<uint16_t>(static_cast<uint32_t>(angle) & 0x3FFF), 16384, now_us);
+        now_us += kLoopPeriodUs;
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+#ifdef DIAL_HAVE_RDTSC
+    const uint64_t c1 = __rdtsc();
+    const double cycles = static_cast<double>(c1 - c0) / kRenders;
+#else
+    const double cycles = 0.0;
+#endif
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / kRenders;
+    std::printf("render(), %-34s %.1f ns, %.0f TSC cycles (%zu voices active at end, sink %lld)\n", label, ns, cycles,
+                engine.active_voices(), static_cast<long long>(sink & 0xF));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<Trace> traces;
+    bool ok = true;
+
+    // Each effect alone, knob still, no detents.
+    for (auto effect : {dial::HapticEffect::Click, dial::HapticEffect::Buzz, dial::HapticEffect::FinalMinute}) {
+        dial::HapticEffectEngine engine(no_detents());
+        const uint32_t duration_us = engine.duration_us(effect);
+        Trace trace = render_trace(
+            effect_name(effect), engine, duration_us + 20000, [](uint32_t) { return Motion{100.0, 0.0}; },
+            [&](uint32_t t) {
+                if (t == 0) {
+                    engine.play(effect);
+                }
+            });
+        uint32_t last_nonzero_us = 0;
+        for (const Sample& s : trace.samples) {
+            if (s.torque != 0) {
+                last_nonzero_us = s.t_us;
+            }
+        }
+        std::printf("%-14s duration %6u us, last torque at %6u us, peak %5d Q15\n", effect_name(effect), duration_us,
+                    last_nonzero_us, peak(trace));
+        ok &= check(last_nonzero_us < duration_us, "effect outlives duration_us()");
+        ok &= check(engine.active_voices() == 0, "voice still active after its duration");
+        ok &= check(peak(trace) > 0, "effect rendered nothing");
+        traces.push_back(std::move(trace));
+    }
+
+    // Detent field over one turn at 1 rev/s: one torque cycle per detent.
+    {
+        dial::HapticEffectEngine engine;
+        Trace trace = render_trace(
+            "detent_sweep", engine, 1000000,
+            [](uint32_t t) { return Motion{kRawPerTurn * t / 1e6, kRawPerTurn}; }, [](uint32_t) {});
+        int crossings = 0;
+        for (size_t i = 1; i < trace.samples.size(); ++i) {
+            crossings += (trace.samples[i - 1].torque < 0) != (trace.samples[i].torque < 0) ? 1 : 0;
+        }
+        std::printf("%-14s %d sign changes over one turn (96 detents), peak %5d Q15\n", "detent_sweep", crossings,
+                    peak(trace));
+        ok &= check(std::abs(crossings - 2 * 96) <= 4, "detent count");
+        traces.push_back(std::move(trace));
+    }
+
+    // End stop: engaged while turning forward, pushed 512 raw past, released.
+    {
+        dial::HapticEffectEngine engine;
+        constexpr double kWall = 4000.0;
+        auto motion = [&](uint32_t t) {
+            // 0.25 rev/s up to the wall and 0.125 turn past it, then back out.
+            const double s = t / 1e6;
+            const double v = 4096.0;
+            const double turn_at = (kWall + 512.0 - 3500.0) / v;
+            return s < turn_at ? Motion{3500.0 + v * s, v} : Motion{kWall + 512.0 - v * (s - turn_at), -v};
+        };
+        int32_t worst_wrong_way = 0;
+        int32_t deepest_push = 0;
+        Trace trace = render_trace("wall", engine, 400000, motion, [&](uint32_t t) {
+            if (t == static_cast<uint32_t>((kWall - 3500.0) / 4096.0 * 1e6) / kLoopPeriodUs * kLoopPeriodUs) {
+                engine.post(dial::HapticCommand{.type = dial::HapticCommandType::EngageWall});
+            }
+            if (t == 390000) {
+                engine.post(dial::HapticCommand{.type = dial::HapticCommandType::ReleaseWall});
+            }
+        });
+        for (const Sample& s : trace.samples) {
+            const double penetration = motion(s.t_us).angle - kWall;
+            if (penetration > 4.0 && s.t_us < 390000) {
+                worst_wrong_way = std::max(worst_wrong_way, s.torque);
+                deepest_push = std::min(deepest_push, s.torque);
+            }
+        }
+        std::printf("%-14s inside: strongest push back %6d Q15, worst push inward %6d Q15, %s after release\n",
+                    "wall", deepest_push, worst_wrong_way, engine.wall_engaged() ? "still engaged" : "clear");
+        ok &= check(worst_wrong_way <= 0, "wall pushes the knob inward");
+        ok &= check(deepest_push == -dial::kQ15One, "wall never saturates");
+        ok &= check(!engine.wall_engaged(), "wall not released");
+        traces.push_back(std::move(trace));
+    }
+
+    // Everything at once: sweep into a wall with all effects playing.
+    {
+        dial::HapticEffectEngine engine;
+        Trace trace = render_trace(
+            "mix", engine, 1200000, [](uint32_t t) { return Motion{kRawPerTurn * t / 1e6, kRawPerTurn}; },
+            [&](uint32_t t) {
+                if (t == 0) {
+                    engine.play(dial::HapticEffect::Buzz);
+                    engine.play(dial::HapticEffect::FinalMinute);
+                }
+                if (t % 50000 == 0) {
+                    engine.play(dial::HapticEffect::Click);
+                }
+                if (t == 600000) {
+                    engine.post(dial::HapticCommand{.type = dial::HapticCommandType::EngageWall, .direction = 1});
+                }
+            });
+        const dial::HapticEffectStats stats = engine.stats();
+        std::printf("%-14s peak %5d Q15, %u played, %u voices stolen, %u dropped\n", "mix", peak(trace), stats.played,
+                    stats.voices_stolen, stats.dropped);
+        ok &= check(peak(trace) <= dial::kQ15One, "torque exceeds full scale");
+        ok &= check(stats.dropped == 0, "commands dropped at a sane rate");
+        traces.push_back(std::move(trace));
+    }
+
+    // Flood: a burst larger than the ring is dropped, never blocks, and
+    // drains a few commands per render.
+    {
+        dial::HapticEffectEngine engine;
+        constexpr int kBurst = 100;
+        int accepted = 0;
+        for (int i = 0; i < kBurst; ++i) {
+            accepted += engine.play(dial::HapticEffect::Click) ? 1 : 0;
+        }
+        int renders = 0;
+        while (engine.stats().commands < static_cast<uint32_t>(accepted) && renders < 100) {
+            engine.render(0, 0, kStartUs + renders * kLoopPeriodUs);
+            ++renders;
+        }
+        const dial::HapticEffectStats stats = engine.stats();
+        std::printf("%-14s %d posted, %d accepted, %u dropped, drained in %d renders\n", "flood", kBurst, accepted,
+                    stats.dropped, renders);
+        ok &= check(accepted == static_cast<int>(dial::kHapticCommandRingSize), "ring accepted more than capacity");
+        ok &= check(stats.dropped == static_cast<uint32_t>(kBurst - accepted), "drop count");
+        ok &= check(renders == 4, "drain rate");
+    }
+
+    {
+        dial::HapticEffectEngine engine;
+        bench_render("detent field only:", engine, false);
+    }
+    {
+        dial::HapticEffectEngine engine;
+        engine.post(dial::HapticCommand{.type = dial::HapticCommandType::EngageWall, .direction = -1});
+        bench_render("detents, wall and four voices:", engine, true);
+    }
+
+    if (argc > 1) {
+        FILE* out = std::fopen(argv[1], "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", argv[1]);
+            return 2;
+        }
+        std::fprintf(out, "scenario,t_us,raw,velocity,torque_q15\n");
+        for (const Trace& trace : traces) {
+            for (const Sample& s : trace.samples) {
+                std::fprintf(out, "%s,%u,%u,%d,%d\n", trace.name.c_str(), s.t_us, s.raw, s.velocity, s.torque);
+            }
+        }
+        std::fclose(out);
+        std::printf("traces written to %s\n", argv[1]);
+    }
+    return ok ? 0 : 1;
+}
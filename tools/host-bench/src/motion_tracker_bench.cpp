@@ -0,0 +1,251 @@
+// Measures dial::MotionTracker update cost and replays encoder traces through
+// the reader's tick conversion to compare the legacy speed tier (x1/x2/x4)
+// picked from the old one-sample estimate (|delta| / gap between queued
+// samples) against the tracker's filtered velocity.
+//
+// Traces are CSV lines of `timestamp_us,raw_angle`; without arguments a set of
+// synthetic sessions is generated, sampled at SampleRateGovernor intervals with
+// sensor noise and scheduling jitter.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DIAL_HAVE_RDTSC 1
+#endif
+
+#include "input/encoder_ticks.h"
+#include "input/motion_tracker.h"
+#include "input/sample_rate.h"
+
+namespace {
+
+constexpr uint32_t kTicksPerRevolution = 96;
+constexpr float kMediumThresholdTps = 20.0f;  // ballistic::kLegacyTiers knots
+constexpr float kFastThresholdTps = 40.0f;
+constexpr double kRawPerTick = static_cast<double>(dial::kMt6701AngleResolution) / kTicksPerRevolution;
+
+struct TraceSample {
+    uint32_t timestamp_us;
+    uint16_t raw;
+    double true_tps;  // NaN for recorded traces
+};
+
+struct Trace {
+    std::string name;
+    std::vector<TraceSample> samples;
+};
+
+uint32_t tier(float tps) {
+    return tps >= kFastThresholdTps ? 2 : (tps >= kMediumThresholdTps ? 1 : 0);
+}
+
+// Velocity profile in ticks/s as a function of time.
+template <typename Profile>
+Trace synthesize(const char* name, double duration_s, Profile profile, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise_raw(0.0, 2.0);
+    std::uniform_int_distribution<int> jitter_us(-150, 150);
+
+    Trace trace{name, {}};
+    dial::SampleRateGovernor governor{dial::SampleRateConfig{}};
+    double position_ticks = 0.5;
+    uint64_t t_us = 0;
+    uint64_t last_us = 0;
+    int32_t last_raw = -1;
+    uint32_t interval_us = governor.interval_us();
+    const uint64_t end_us = static_cast<uint64_t>(duration_s * 1e6);
+    while (t_us < end_us) {
+        const uint64_t step_us = interval_us;
+        // Integrate the profile at 100 us resolution.
+        for (uint64_t s = 0; s < step_us; s += 100) {
+            position_ticks += profile(static_cast<double>(t_us + s) / 1e6) * 100e-6;
+        }
+        t_us += step_us;
+        const int64_t sample_us = static_cast<int64_t>(t_us) + jitter_us(rng);
+        double raw_pos = position_ticks * kRawPerTick + noise_raw(rng);
+        raw_pos -= std::floor(raw_pos / dial::kMt6701AngleResolution) * dial::kMt6701AngleResolution;
+        const uint16_t raw = static_cast<uint16_t>(static_cast<uint32_t>(raw_pos) % dial::kMt6701AngleResolution);
+        trace.samples.push_back(TraceSample{static_cast<uint32_t>(sample_us), raw,
+                                            std::abs(profile(static_cast<double>(t_us) / 1e6))});
+        const int32_t delta_raw = last_raw < 0 ? 0 : dial::mt6701_angle_delta(static_cast<uint16_t>(last_raw), raw);
+        interval_us = governor.update(delta_raw, static_cast<uint32_t>(t_us - last_us));
+        last_us = t_us;
+        last_raw = raw;
+    }
+    return trace;
+}
+
+bool load_trace(const char* path, Trace* out) {
+    FILE* f = std::fopen(path, "r");
+    if (f == nullptr) {
+        return false;
+    }
+    out->name = path;
+    unsigned long ts = 0;
+    unsigned raw = 0;
+    char line[128];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        if (std::sscanf(line, "%lu,%u", &ts, &raw) == 2) {
+            out->samples.push_back(TraceSample{static_cast<uint32_t>(ts), static_cast<uint16_t>(raw & 0x3FFF), NAN});
+        }
+    }
+    std::fclose(f);
+    return !out->samples.empty();
+}
+
+struct ReplayResult {
+    uint32_t ticks = 0;
+    uint32_t legacy_flips = 0;
+    uint32_t tracker_flips = 0;
+    uint32_t legacy_wrong = 0;
+    uint32_t tracker_wrong = 0;
+    bool has_truth = false;
+};
+
+ReplayResult replay(const Trace& trace) {
+    ReplayResult result{};
+    dial::AngleTickAccumulator ticks(kTicksPerRevolution);
+    dial::MotionTracker tracker;
+    int32_t unwrapped = 0;
+    bool has_last = false;
+    uint16_t last_raw = 0;
+    uint32_t last_emit_us = 0;
+    int legacy_tier = -1;
+    int tracker_tier = -1;
+
+    for (const TraceSample& s : trace.samples) {
+        if (has_last) {
+            unwrapped += dial::mt6701_angle_delta(last_raw, s.raw);
+        }
+        has_last = true;
+        last_raw = s.raw;
+        const dial::EncoderMotion motion = tracker.update(unwrapped, s.timestamp_us);
+        const int32_t delta = ticks.update(s.raw);
+        if (delta == 0) {
+            continue;
+        }
+        ++result.ticks;
+
+        // The pre-tracker TimeSelector::process_sample estimate.
+        const uint32_t dt_us = last_emit_us == 0 ? 0 : s.timestamp_us - last_emit_us;
+        last_emit_us = s.timestamp_us;
+        const float legacy_tps = dt_us > 0 ? std::abs(static_cast<float>(delta)) / (static_cast<float>(dt_us) / 1e6f) : 0.0f;
+        const float tracker_tps = static_cast<float>(std::abs(motion.velocity)) / static_cast<float>(kRawPerTick);
+
+        const int lt = static_cast<int>(tier(legacy_tps));
+        const int tt = static_cast<int>(tier(tracker_tps));
+        result.legacy_flips += legacy_tier >= 0 && lt != legacy_tier ? 1 : 0;
+        result.tracker_flips += tracker_tier >= 0 && tt != tracker_tier ? 1 : 0;
+        legacy_tier = lt;
+        tracker_tier = tt;
+        if (!std::isnan(s.true_tps)) {
+            result.has_truth = true;
+            const int truth = static_cast<int>(tier(static_cast<float>(s.true_tps)));
+            result.legacy_wrong += lt != truth ? 1 : 0;
+            result.tracker_wrong += tt != truth ? 1 : 0;
+        }
+    }
+    return result;
+}
+
+void bench_update_cost() {
+    constexpr int kUpdates = 4'000'000;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> step(-40, 40);
+    const uint32_t intervals[] = {1000, 1000, 1000, 5000, 5000, 50000};
+    std::vector<int32_t> positions(4096);
+    std::vector<uint32_t> times(4096);
+    int32_t p = 0;
+    uint32_t t = 0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        p += step(rng);
+        t += intervals[(i / 256) % 6] + (rng() % 64);
+        positions[i] = p;
+        times[i] = t;
+    }
+
+    dial::MotionTracker tracker;
+    int64_t sink = 0;
+    uint32_t base = 0;
+#ifdef DIAL_HAVE_RDTSC
+    const uint64_t c0 = __rdtsc();
+#endif
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kUpdates; ++i) {
+        const size_t idx = static_cast<size_t>(i) & (positions.size() - 1);
+        if (idx == 0) {
+            base += times.back();
+        }
+        sink += tracker.update(positions[idx], base + times[idx]).velocity;
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+#ifdef DIAL_HAVE_RDTSC
+    const uint64_t c1 = __rdtsc();
+    const double cycles = static_cast<double>(c1 - c0) / kUpdates;
+#else
+    const double cycles = 0.0;
+#endif
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / kUpdates;
+    std::printf("MotionTracker::update: %.1f ns, %.0f TSC cycles per update over %d updates (sink %lld)\n", ns,
+                cycles, kUpdates, static_cast<long long>(sink & 0xF));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bench_update_cost();
+
+    std::vector<Trace> traces;
+    for (int i = 1; i < argc; ++i) {
+        Trace trace;
+        if (!load_trace(argv[i], &trace)) {
+            std::fprintf(stderr, "cannot read trace %s\n", argv[i]);
+            return 1;
+        }
+        traces.push_back(std::move(trace));
+    }
+    if (traces.empty()) {
+        const double kPi = 3.14159265358979323846;
+        traces.push_back(synthesize("steady 30 tps, tremor", 4.0,
+                                    [&](double t) { return 30.0 + 6.0 * std::sin(2 * kPi * 7.0 * t); }, 1));
+        traces.push_back(synthesize("near fast threshold", 4.0,
+                                    [&](double t) { return 40.0 + 4.0 * std::sin(2 * kPi * 3.0 * t); }, 2));
+        traces.push_back(synthesize("spin up and down", 4.0,
+                                    [&](double t) { return t < 2.0 ? 45.0 * t : 45.0 * (4.0 - t); }, 3));
+        traces.push_back(synthesize("ratcheting turns", 4.0, [&](double t) {
+            const double phase = std::fmod(t, 0.25);
+            return phase < 0.12 ? 60.0 * std::sin(kPi * phase / 0.12) : 0.0;
+        }, 4));
+        traces.push_back(synthesize("back and forth", 4.0,
+                                    [&](double t) { return 50.0 * std::sin(2 * kPi * 1.5 * t); }, 5));
+    }
+
+    uint32_t legacy_total = 0;
+    uint32_t tracker_total = 0;
+    std::printf("%-24s %6s %14s %14s %16s %16s\n", "trace", "ticks", "legacy flips", "tracker flips",
+                "legacy wrong", "tracker wrong");
+    for (const Trace& trace : traces) {
+        const ReplayResult r = replay(trace);
+        legacy_total += r.legacy_flips;
+        tracker_total += r.tracker_flips;
+        if (r.has_truth) {
+            std::printf("%-24s %6u %14u %14u %10u (%3.0f%%) %10u (%3.0f%%)\n", trace.name.c_str(), r.ticks,
+                        r.legacy_flips, r.tracker_flips, r.legacy_wrong,
+                        r.ticks ? 100.0 * r.legacy_wrong / r.ticks : 0.0, r.tracker_wrong,
+                        r.ticks ? 100.0 * r.tracker_wrong / r.ticks : 0.0);
+        } else {
+            std::printf("%-24s %6u %14u %14u %16s %16s\n", trace.name.c_str(), r.ticks, r.legacy_flips,
+                        r.tracker_flips, "-", "-");
+        }
+    }
+    std::printf("multiplier flips: legacy %u, tracker %u\n", legacy_total, tracker_total);
+    return tracker_total <= legacy_total ? 0 : 1;
+}
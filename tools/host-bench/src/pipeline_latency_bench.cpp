@@ -0,0 +1,343 @@
+// Tick-to-snapshot latency of the knob input path, before and after the
+// single-hop pipeline.
+//
+// "queue chain" is the old topology: reader -> sample queue -> TimeSelector
+// task (10 ms receive timeout for commit polling) -> event queue ->
+// time_event_dispatch relay -> engine queue -> engine. "single hop" runs the
+// selector inline in the reader and posts to the engine over dial::SpscRing
+// plus a task notification. Queues and notifications come from the POSIX shim
+// in src/freertos_queue_shim.h; the engine is dial::TimerCore with the
+// firmware's batch fold and a SeqlockCell publish.
+//
+// Each topology runs with every thread pinned to one CPU (the firmware runs
+// the whole chain on core 0) and unpinned. Reports latency percentiles and
+// consumer-thread wakeups per tick.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "freertos_queue_shim.h"
+#include "input/time_event.h"
+#include "ringbuf/seqlock.h"
+#include "ringbuf/spsc_ring.h"
+#include "timer/timer_core.h"
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+constexpr int32_t kBaseStepSeconds = 60;
+constexpr int32_t kMaxTotalSeconds = 6 * 3600;
+constexpr size_t kSampleQueueDepth = 128;  // old EncoderConfig::sample_queue_depth in app_main
+constexpr size_t kEventQueueDepth = 16;    // TimeSelectorConfig::queue_depth, TimerEngine kQueueLength
+constexpr int kMaxBatch = 16;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now().time_since_epoch()).count();
+}
+
+class WallClock : public dial::Clock {
+public:
+    int64_t now_us() const override { return now_ns() / 1000; }
+};
+
+struct TickPlan {
+    int64_t offset_us;
+    int32_t delta;
+    uint32_t multiplier;
+};
+
+struct Sample {
+    int32_t delta_ticks;
+    uint32_t multiplier;
+    int64_t tick_ns;  // -1 stops the pipeline
+};
+
+struct Stamped {
+    dial::TimeDeltaEvent event;
+    int64_t tick_ns;  // -1 stops the pipeline
+};
+
+// Bursts of ticks at 1-10 ms spacing with short pauses, alternating direction
+// so the setpoint stays clear of the clamps.
+std::vector<TickPlan> make_session(int ticks, uint32_t seed) {
+    std::mt19937 rng(seed);
+    const int spacing_ms[] = {1, 2, 5, 10};
+    std::vector<TickPlan> plan;
+    int64_t t_us = 10'000;
+    int32_t direction = 1;
+    while (static_cast<int>(plan.size()) < ticks) {
+        const int spacing = spacing_ms[rng() % 4];
+        const int count = 10 + static_cast<int>(rng() % 30);
+        const uint32_t multiplier = spacing <= 2 ? 4 : (spacing <= 5 ? 2 : 1);
+        for (int i = 0; i < count && static_cast<int>(plan.size()) < ticks; ++i) {
+            t_us += spacing * 1000 + static_cast<int64_t>(rng() % 200);
+            plan.push_back(TickPlan{t_us, direction, multiplier});
+        }
+        t_us += 20'000 + static_cast<int64_t>(rng() % 60'000);
+        direction = -direction;
+    }
+    return plan;
+}
+
+// TimeSelector::handle_sample without the tracker: clamp, then emit the
+// applied delta.
+class SelectorModel {
+public:
+    bool handle(const Sample& sample, dial::TimeDeltaEvent* out) {
+        const int32_t previous = accumulated_;
+        accumulated_ = std::clamp(previous + sample.delta_ticks * kBaseStepSeconds * static_cast<int32_t>(sample.multiplier),
+                                  0, kMaxTotalSeconds);
+        if (accumulated_ == previous) {
+            return false;
+        }
+        *out = dial::TimeDeltaEvent{};
+        out->type = dial::TimeEventType::Delta;
+        out->total_seconds = accumulated_;
+        out->delta_seconds = accumulated_ - previous;
+        out->timestamp_us = static_cast<uint32_t>(sample.tick_ns / 1000);
+        out->multiplier = sample.multiplier;
+        return true;
+    }
+
+private:
+    int32_t accumulated_ = 3 * 3600;
+};
+
+// TimerEngine::apply_batch over an arbitrary source, recording the latency of
+// every tick in the batch at publish time.
+class EngineModel {
+public:
+    EngineModel() {
+        dial::TimerEngineConfig config{};
+        config.max_total_seconds = kMaxTotalSeconds;
+        core_.init(config, clock_);
+        core_.restore(dial::TimerState::Editing, 3 * 3600, 0);
+    }
+
+    template <typename Next>
+    void apply_batch(const Stamped& first, Next next) {
+        batch_ticks_.clear();
+        batch_ticks_.push_back(first.tick_ns);
+        dial::TimeDeltaEvent pending = first.event;
+        Stamped item{};
+        for (int drained = 1; drained < kMaxBatch && next(&item); ++drained) {
+            if (item.tick_ns < 0) {
+                stopped_ = true;
+                break;
+            }
+            batch_ticks_.push_back(item.tick_ns);
+            if (core_.fold_delta(&pending, item.event)) {
+                continue;
+            }
+            core_.handle(pending);
+            pending = item.event;
+        }
+        core_.handle(pending);
+        dial::TimerSnapshot snapshot{};
+        if (core_.take_visible_change(&snapshot)) {
+            published_.store(snapshot);
+        }
+        const int64_t done_ns = now_ns();
+        for (int64_t tick_ns : batch_ticks_) {
+            latencies_us_.push_back(static_cast<double>(done_ns - tick_ns) / 1000.0);
+        }
+    }
+
+    bool stopped() const { return stopped_; }
+    void stop() { stopped_ = true; }
+    std::vector<double>& latencies() { return latencies_us_; }
+
+private:
+    WallClock clock_{};
+    dial::TimerCore core_{};
+    dial::SeqlockCell<dial::TimerSnapshot> published_{};
+    std::vector<int64_t> batch_ticks_;
+    std::vector<double> latencies_us_;
+    bool stopped_ = false;
+};
+
+void pin_to_cpu0(bool pin) {
+#ifdef __linux__
+    if (pin) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(0, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#else
+    (void)pin;
+#endif
+}
+
+struct Result {
+    std::vector<double> latencies_us;
+    uint64_t wakeups = 0;
+};
+
+template <typename Produce>
+void drive(const std::vector<TickPlan>& plan, Produce produce) {
+    const auto start = SteadyClock::now();
+    for (const TickPlan& tick : plan) {
+        std::this_thread::sleep_until(start + std::chrono::microseconds(tick.offset_us));
+        produce(Sample{tick.delta, tick.multiplier, now_ns()});
+    }
+}
+
+Result run_queue_chain(const std::vector<TickPlan>& plan, bool pin) {
+    using host_bench::PosixQueue;
+    PosixQueue samples(kSampleQueueDepth, sizeof(Sample));
+    PosixQueue selector_events(kEventQueueDepth, sizeof(Stamped));
+    PosixQueue engine_queue(kEventQueueDepth, sizeof(Stamped));
+    std::atomic<uint64_t> wakeups{0};
+    constexpr auto kForever = std::chrono::hours(1);
+    EngineModel engine;
+
+    std::thread selector([&] {
+        pin_to_cpu0(pin);
+        SelectorModel model;
+        Sample sample{};
+        while (true) {
+            ++wakeups;
+            if (!samples.receive(&sample, std::chrono::milliseconds(10))) {
+                continue;  // commit-timeout poll
+            }
+            Stamped out{{}, sample.tick_ns};
+            if (sample.tick_ns < 0) {
+                selector_events.send(&out, kForever);
+                return;
+            }
+            if (model.handle(sample, &out.event)) {
+                selector_events.send(&out, kForever);
+            }
+        }
+    });
+    std::thread relay([&] {
+        pin_to_cpu0(pin);
+        Stamped item{};
+        while (selector_events.receive(&item, kForever)) {
+            ++wakeups;
+            engine_queue.send(&item, kForever);
+            if (item.tick_ns < 0) {
+                return;
+            }
+        }
+    });
+    std::thread engine_task([&] {
+        pin_to_cpu0(pin);
+        Stamped first{};
+        while (!engine.stopped() && engine_queue.receive(&first, kForever)) {
+            ++wakeups;
+            if (first.tick_ns < 0) {
+                engine.stop();
+                break;
+            }
+            engine.apply_batch(first, [&](Stamped* out) { return engine_queue.receive(out); });
+        }
+    });
+
+    pin_to_cpu0(pin);
+    drive(plan, [&](const Sample& sample) { samples.send(&sample); });
+    const Sample stop{0, 0, -1};
+    samples.send(&stop, kForever);
+    selector.join();
+    relay.join();
+    engine_task.join();
+    return Result{std::move(engine.latencies()), wakeups.load()};
+}
+
+Result run_single_hop(const std::vector<TickPlan>& plan, bool pin) {
+    dial::SpscRing<Stamped, 32> ring;
+    host_bench::PosixTaskNotify notify;
+    std::atomic<uint64_t> wakeups{0};
+    EngineModel engine;
+
+    std::thread engine_task([&] {
+        pin_to_cpu0(pin);
+        Stamped first{};
+        while (!engine.stopped()) {
+            while (!engine.stopped() && ring.pop(&first)) {
+                if (first.tick_ns < 0) {
+                    engine.stop();
+                    break;
+                }
+                engine.apply_batch(first, [&](Stamped* out) { return ring.pop(out); });
+            }
+            if (!engine.stopped()) {
+                notify.take(std::chrono::hours(1));
+                ++wakeups;
+            }
+        }
+    });
+
+    auto post = [&](const Stamped& item) {
+        while (!ring.push(item)) {
+            std::this_thread::yield();
+        }
+        notify.give();
+    };
+
+    pin_to_cpu0(pin);
+    SelectorModel model;
+    drive(plan, [&](const Sample& sample) {
+        Stamped out{{}, sample.tick_ns};
+        if (model.handle(sample, &out.event)) {
+            post(out);
+        }
+    });
+    post(Stamped{{}, -1});
+    engine_task.join();
+    return Result{std::move(engine.latencies()), wakeups.load()};
+}
+
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) {
+        return 0.0;
+    }
+    const size_t idx = std::min(v.size() - 1, static_cast<size_t>(p * static_cast<double>(v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+    return v[idx];
+}
+
+void report(const char* name, Result result, size_t ticks) {
+    std::vector<double>& v = result.latencies_us;
+    double sum = 0.0;
+    for (double x : v) {
+        sum += x;
+    }
+    const double mean = v.empty() ? 0.0 : sum / static_cast<double>(v.size());
+    const double p50 = percentile(v, 0.50);
+    const double p99 = percentile(v, 0.99);
+    const double max = v.empty() ? 0.0 : *std::max_element(v.begin(), v.end());
+    std::printf("%-26s %6zu %9.1f %9.1f %9.1f %9.1f %12.2f\n", name, v.size(), mean, p50, p99, max,
+                ticks ? static_cast<double>(result.wakeups) / static_cast<double>(ticks) : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int ticks = argc > 1 ? std::max(1, std::atoi(argv[1])) : 400;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    const std::vector<TickPlan> plan = make_session(ticks, seed);
+    std::printf("%d ticks over %.1f s, latency in us from tick to snapshot publish\n", ticks,
+                static_cast<double>(plan.back().offset_us) / 1e6);
+    std::printf("%-26s %6s %9s %9s %9s %9s %12s\n", "pipeline", "ticks", "mean", "p50", "p99", "max", "wakeups/tick");
+
+    for (bool pin : {true, false}) {
+        report(pin ? "queue chain, one core" : "queue chain, unpinned", run_queue_chain(plan, pin), plan.size());
+        report(pin ? "single hop, one core" : "single hop, unpinned", run_single_hop(plan, pin), plan.size());
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+// dial::SpscRing / dial::MpscRing against a FreeRTOS-style queue (the POSIX
+// shim in src/freertos_queue_shim.h: memcpy in and out under a mutex).
+//
+// Three measurements per channel, all on a 24-byte item the size of a
+// TimeDeltaEvent or EncoderSample:
+//   - uncontended push+pop pair cost on one thread;
+//   - throughput with 1/2/4 producers flooding one consumer, both ends
+//     polling with a yield on full/empty, so the numbers reflect the channel
+//     rather than the host scheduler's wakeup policy;
+//   - latency from push to pop with producers pacing one item every period,
+//     the consumer sleeping on a task-notification stand-in (rings, through
+//     dial::NotifiedRing) or in a blocking receive (queue).
+// Every run checks that each producer's items arrive complete and in order
+// and exits non-zero otherwise.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "freertos_queue_shim.h"
+#include "ringbuf/mpsc_ring.h"
+#include "ringbuf/notified_ring.h"
+#include "ringbuf/spsc_ring.h"
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+constexpr size_t kDepth = 64;
+
+struct Item {
+    uint32_t producer;
+    uint32_t seq;
+    int64_t t_ns;
+    uint32_t payload[2];
+};
+static_assert(sizeof(Item) == 24, "bench item should match the firmware event size");
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now().time_since_epoch()).count();
+}
+
+class PosixWaker {
+public:
+    void wake() { notify_.give(); }
+    void wake_from_isr(bool*) { notify_.give(); }
+    bool wait(std::chrono::microseconds timeout) { return notify_.take(timeout) > 0; }
+
+private:
+    host_bench::PosixTaskNotify notify_;
+};
+
+// Uniform face over the channels: producer push (retry or block until
+// stored), consumer pop (block up to a timeout), and a non-blocking pair for
+// the single-thread cost.
+template <typename Ring>
+class RingChannel {
+public:
+    void push(const Item& item) {
+        while (!ring_.push(item)) {
+            std::this_thread::yield();
+        }
+    }
+    bool pop(Item* out, std::chrono::microseconds timeout) { return ring_.pop_wait(out, timeout); }
+    bool try_push(const Item& item) { return ring_.ring().push(item); }
+    bool try_pop(Item* out) { return ring_.ring().pop(out); }
+
+private:
+    dial::NotifiedRing<Ring, PosixWaker> ring_;
+};
+
+class QueueChannel {
+public:
+    void push(const Item& item) { queue_.send(&item, std::chrono::hours(1)); }
+    bool pop(Item* out, std::chrono::microseconds timeout) { return queue_.receive(out, timeout); }
+    bool try_push(const Item& item) { return queue_.send(&item); }
+    bool try_pop(Item* out) { return queue_.receive(out); }
+
+private:
+    host_bench::PosixQueue queue_{kDepth, sizeof(Item)};
+};
+
+using Spsc = RingChannel<dial::SpscRing<Item, kDepth>>;
+using Mpsc = RingChannel<dial::MpscRing<Item, kDepth>>;
+
+bool g_failed = false;
+
+template <typename Channel>
+double pair_cost_ns() {
+    constexpr int kPairs = 4'000'000;
+    auto channel = std::make_unique<Channel>();
+    Item item{};
+    uint64_t sink = 0;
+    const auto t0 = SteadyClock::now();
+    for (int i = 0; i < kPairs; ++i) {
+        item.seq = static_cast<uint32_t>(i);
+        channel->try_push(item);
+        channel->try_pop(&item);
+        sink += item.seq;
+    }
+    const auto t1 = SteadyClock::now();
+    if (sink == 0) {
+        std::printf("?");
+    }
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / kPairs;
+}
+
+struct Run {
+    double seconds = 0.0;
+    uint64_t items = 0;
+    std::vector<double> latencies_us;
+};
+
+// period_us == 0 floods; otherwise each producer paces one item per period.
+template <typename Channel>
+Run run_channel(int producers, uint32_t per_producer, uint32_t period_us) {
+    auto channel = std::make_unique<Channel>();
+    Run run;
+    run.latencies_us.reserve(period_us > 0 ? static_cast<size_t>(producers) * per_producer : 0);
+    std::vector<uint32_t> next_seq(static_cast<size_t>(producers), 0);
+    const uint64_t expected = static_cast<uint64_t>(producers) * per_producer;
+
+    std::thread consumer([&] {
+        Item item{};
+        uint64_t received = 0;
+        while (received < expected) {
+            if (period_us == 0 ? !channel->try_pop(&item) : !channel->pop(&item, std::chrono::milliseconds(100))) {
+                if (period_us == 0) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            if (period_us > 0) {
+                run.latencies_us.push_back(static_cast<double>(now_ns() - item.t_ns) / 1000.0);
+            }
+            if (item.producer >= next_seq.size() || item.seq != next_seq[item.producer]) {
+                g_failed = true;
+            } else {
+                ++next_seq[item.producer];
+            }
+            ++received;
+        }
+        run.items = received;
+    });
+
+    const auto start = SteadyClock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            Item item{static_cast<uint32_t>(p), 0, 0, {0, 0}};
+            // Stagger paced producers so they do not fire in lockstep.
+            auto due = start + std::chrono::microseconds(period_us * static_cast<uint32_t>(p) / std::max(1, producers));
+            for (uint32_t i = 0; i < per_producer; ++i) {
+                if (period_us > 0) {
+                    due += std::chrono::microseconds(period_us);
+                    while (SteadyClock::now() < due) {
+                        std::this_thread::yield();
+                    }
+                }
+                item.seq = i;
+                item.t_ns = now_ns();
+                if (period_us > 0) {
+                    channel->push(item);
+                } else {
+                    while (!channel->try_push(item)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    consumer.join();
+    run.seconds = std::chrono::duration<double>(SteadyClock::now() - start).count();
+    if (run.items != expected) {
+        g_failed = true;
+    }
+    return run;
+}
+
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) {
+        return 0.0;
+    }
+    const size_t idx = std::min(v.size() - 1, static_cast<size_t>(p * static_cast<double>(v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(idx), v.end());
+    return v[idx];
+}
+
+template <typename Channel>
+void throughput_row(const char* name, int producers, uint32_t items) {
+    const Run run = run_channel<Channel>(producers, items / static_cast<uint32_t>(producers), 0);
+    std::printf("%-10s %9d %12.2f\n", name, producers, static_cast<double>(run.items) / run.seconds / 1e6);
+}
+
+template <typename Channel>
+void latency_row(const char* name, int producers, uint32_t items, uint32_t period_us) {
+    Run run = run_channel<Channel>(producers, items / static_cast<uint32_t>(producers), period_us);
+    std::vector<double>& v = run.latencies_us;
+    std::printf("%-10s %9d %9.1f %9.1f %9.1f %9.1f\n", name, producers, percentile(v, 0.50), percentile(v, 0.99),
+                percentile(v, 0.999), v.empty() ? 0.0 : *std::max_element(v.begin(), v.end()));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t flood_items = argc > 1 ? static_cast<uint32_t>(std::max(4, std::atoi(argv[1]))) : 1'000'000;
+    const uint32_t paced_items = argc > 2 ? static_cast<uint32_t>(std::max(4, std::atoi(argv[2]))) : 20'000;
+    const uint32_t period_us = argc > 3 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[3]))) : 50;
+
+    std::printf("push+pop pair, one thread (ns): spsc %.1f, mpsc %.1f, queue %.1f\n", pair_cost_ns<Spsc>(),
+                pair_cost_ns<Mpsc>(), pair_cost_ns<QueueChannel>());
+
+    std::printf("\nthroughput, %u items, depth %zu\n%-10s %9s %12s\n", flood_items, kDepth, "channel", "producers",
+                "Mitems/s");
+    throughput_row<Spsc>("spsc", 1, flood_items);
+    for (int producers : {1, 2, 4}) {
+        throughput_row<Mpsc>("mpsc", producers, flood_items);
+        throughput_row<QueueChannel>("queue", producers, flood_items);
+    }
+
+    std::printf("\nlatency push->pop (us), %u items, one per %u us per producer\n%-10s %9s %9s %9s %9s %9s\n",
+                paced_items, period_us, "channel", "producers", "p50", "p99", "p99.9", "max");
+    latency_row<Spsc>("spsc", 1, paced_items, period_us);
+    for (int producers : {1, 2, 4}) {
+        latency_row<Mpsc>("mpsc", producers, paced_items, period_us);
+        latency_row<QueueChannel>("queue", producers, paced_items, period_us);
+    }
+
+    if (g_failed) {
+        std::printf("\nFAIL: items lost or reordered\n");
+        return 1;
+    }
+    return 0;
+}
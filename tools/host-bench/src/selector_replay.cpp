@@ -0,0 +1,383 @@
+// Replays knob motion through the reader's tick conversion, MotionTracker and
+// TimeSelector's step logic once per ballistic curve, to tune how quickly an
+// operator can dial in a setpoint.
+//
+// Without arguments a simulated operator sets a range of targets: they see
+// the display after a reaction delay, spin at whatever speed the curve says
+// will get there quickly, and finish with single detent clicks, reversing
+// after an overshoot. Reports time-to-target, overshoot, reversals and turns per
+// curve, averaged over several seeds; targets a curve cannot land on time out.
+//
+// With arguments, each file is a recorded trace of `timestamp_us,raw_angle`
+// lines, optionally with `# target=<seconds>` and `# start=<seconds>` lines.
+// The same motion is replayed open-loop through every curve, reporting the
+// first time the setpoint reaches the target, the overshoot and the final
+// setpoint.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "input/ballistic_curve.h"
+#include "input/encoder_ticks.h"
+#include "input/motion_tracker.h"
+#include "input/sample_rate.h"
+
+namespace {
+
+constexpr uint32_t kTicksPerRevolution = 96;
+constexpr int32_t kMaxTotalSeconds = 6 * 3600;
+constexpr int32_t kInitialSeconds = 15 * 60;
+constexpr double kRawPerTick = static_cast<double>(dial::kMt6701AngleResolution) / kTicksPerRevolution;
+
+struct NamedCurve {
+    const char* name;
+    dial::BallisticCurve curve;
+};
+
+const NamedCurve kCurves[] = {
+    {"legacy tiers", dial::ballistic::kLegacyTiers},
+    {"smooth", dial::ballistic::kSmooth},
+    {"quick", dial::ballistic::kQuick},
+};
+
+// EncoderReader::run() tick path plus TimeSelector::handle_sample().
+class SelectorPipeline {
+public:
+    SelectorPipeline(const dial::BallisticCurve& curve, int32_t initial_seconds)
+        : ticks_(kTicksPerRevolution), total_(initial_seconds) {
+        table_.build(curve, kTicksPerRevolution);
+    }
+
+    // Returns true when the setpoint changed.
+    bool sample(uint16_t raw, uint32_t timestamp_us) {
+        if (has_last_) {
+            unwrapped_ += dial::mt6701_angle_delta(last_raw_, raw);
+        }
+        has_last_ = true;
+        last_raw_ = raw;
+        const dial::EncoderMotion motion = tracker_.update(unwrapped_, timestamp_us);
+        const int32_t delta = ticks_.update(raw);
+        if (delta == 0) {
+            return false;
+        }
+        const uint32_t step = table_.seconds_per_tick(motion.velocity);
+        const int32_t next = std::clamp(table_.advance(total_, delta, step), 0, kMaxTotalSeconds);
+        if (next == total_) {
+            return false;
+        }
+        total_ = next;
+        return true;
+    }
+
+    int32_t total() const { return total_; }
+
+private:
+    dial::AngleTickAccumulator ticks_;
+    dial::MotionTracker tracker_{};
+    dial::BallisticTable table_{};
+    int32_t unwrapped_ = 0;
+    uint16_t last_raw_ = 0;
+    bool has_last_ = false;
+    int32_t total_;
+};
+
+uint16_t raw_at(double position_ticks, double noise_raw) {
+    double raw = position_ticks * kRawPerTick + noise_raw;
+    raw -= std::floor(raw / dial::kMt6701AngleResolution) * dial::kMt6701AngleResolution;
+    return static_cast<uint16_t>(static_cast<uint32_t>(raw) % dial::kMt6701AngleResolution);
+}
+
+struct OperatorResult {
+    bool reached = false;
+    double time_s = 0.0;        // last setpoint change before settling on the target
+    double overshoot_s = 0.0;   // setpoint seconds beyond the target
+    uint32_t reversals = 0;
+    double turns = 0.0;         // revolutions of the knob, both directions
+};
+
+// Closed loop: the operator acts on what the display showed kReactionS ago.
+// They know the curve, as a practised user would: far from the target they
+// pick the speed that would arrive in about kApproachS, allowing for how far
+// the display has moved since what they saw, and let go when nothing is left.
+// Within a couple of display steps they click one detent at a time, waiting
+// to see each result. The knob's detents pull a stopped knob to a detent
+// center.
+OperatorResult operate(const dial::BallisticCurve& curve, int32_t target, uint32_t seed) {
+    enum class Mode { Slew, Click, Wait };
+    constexpr double kDtS = 100e-6;
+    constexpr double kReactionS = 0.18;
+    constexpr double kAccel = 600.0;     // ticks/s^2 while speeding up
+    constexpr double kDecel = 3000.0;    // stopping is quicker than spinning up
+    constexpr double kClickTps = 8.0;
+    constexpr double kMaxTps = 60.0;
+    constexpr double kApproachS = 0.6;
+    constexpr double kTimeoutS = 30.0;
+    constexpr double kSettleS = 0.6;
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise_raw(0.0, 2.0);
+    std::uniform_int_distribution<int> jitter_us(-150, 150);
+    std::uniform_real_distribution<double> hesitation(0.0, 0.08);
+
+    SelectorPipeline pipeline(curve, kInitialSeconds);
+    dial::SampleRateGovernor governor{dial::SampleRateConfig{}};
+    std::deque<std::pair<double, int32_t>> seen;  // (time, displayed total)
+    seen.emplace_back(0.0, pipeline.total());
+
+    OperatorResult result{};
+    const double origin = 0.5 + static_cast<double>(rng() % 100) / 1000.0;
+    double t = 0.0;
+    double position = origin;
+    double velocity = 0.0;
+    double travel = 0.0;
+    double next_sample_s = 0.0;
+    double last_sample_s = 0.0;
+    int32_t last_raw = -1;
+    double last_change_s = 0.0;
+    double on_target_since = -1.0;
+    int last_direction = 0;
+    int32_t observed_step = 60;
+    dial::BallisticTable learned{};
+    learned.build(curve, kTicksPerRevolution);
+    auto rate_at = [&](double tps) {
+        return tps * learned.seconds_per_tick(static_cast<int32_t>(tps * kRawPerTick));
+    };
+    Mode mode = Mode::Slew;
+    double wait_until = 0.0;
+    double click_to = origin;
+    const int approach = target > pipeline.total() ? 1 : -1;
+
+    auto note_direction = [&](int direction) {
+        if (last_direction != 0 && direction != last_direction) {
+            ++result.reversals;
+        }
+        last_direction = direction;
+    };
+
+    while (t < kTimeoutS) {
+        while (seen.size() > 1 && seen[1].first <= t - kReactionS) {
+            observed_step = std::max(1, std::abs(seen[1].second - seen[0].second));
+            seen.pop_front();
+        }
+        const int32_t error = target - seen.front().second;
+        const bool close = std::abs(error) <= 2 * observed_step;
+
+        double desired = 0.0;
+        switch (mode) {
+            case Mode::Slew: {
+                const double remaining = std::abs(error) - rate_at(std::abs(velocity)) * kReactionS;
+                if (error != 0 && !close && remaining > observed_step) {
+                    double magnitude = kClickTps;
+                    for (double tps = kClickTps; tps <= kMaxTps; tps += 1.0) {
+                        if (rate_at(tps) * kApproachS <= remaining) {
+                            magnitude = tps;
+                        }
+                    }
+                    desired = error > 0 ? magnitude : -magnitude;
+                    note_direction(error > 0 ? 1 : -1);
+                } else if (velocity == 0.0) {
+                    position = origin + std::round(position - origin);
+                    mode = Mode::Wait;
+                    wait_until = t + kReactionS + hesitation(rng);
+                }
+                break;
+            }
+            case Mode::Wait:
+                if (t >= wait_until && error != 0) {
+                    if (!close && std::abs(error) > 4 * observed_step) {
+                        mode = Mode::Slew;
+                    } else {
+                        const int direction = error > 0 ? 1 : -1;
+                        note_direction(direction);
+                        click_to = origin + std::round(position - origin) + direction;
+                        mode = Mode::Click;
+                    }
+                }
+                break;
+            case Mode::Click:
+                desired = click_to > position ? kClickTps : -kClickTps;
+                if (std::abs(click_to - position) <= kClickTps * kDtS) {
+                    position = click_to;
+                    velocity = 0.0;
+                    desired = 0.0;
+                    mode = Mode::Wait;
+                    wait_until = t + kReactionS + hesitation(rng);
+                }
+                break;
+        }
+        if (mode == Mode::Click) {
+            velocity = desired;
+        } else {
+            const bool speeding_up = std::abs(desired) > std::abs(velocity) && desired * velocity >= 0.0;
+            const double limit = (speeding_up ? kAccel : kDecel) * kDtS;
+            velocity += std::clamp(desired - velocity, -limit, limit);
+        }
+        position += velocity * kDtS;
+        travel += std::abs(velocity) * kDtS;
+        t += kDtS;
+
+        if (t >= next_sample_s) {
+            const double sample_s = t + jitter_us(rng) * 1e-6;
+            const uint16_t raw = raw_at(position, noise_raw(rng));
+            if (pipeline.sample(raw, static_cast<uint32_t>(sample_s * 1e6))) {
+                seen.emplace_back(t, pipeline.total());
+                last_change_s = t;
+                const int32_t beyond = (pipeline.total() - target) * approach;
+                result.overshoot_s = std::max(result.overshoot_s, static_cast<double>(beyond));
+            }
+            const int32_t delta_raw = last_raw < 0 ? 0 : dial::mt6701_angle_delta(static_cast<uint16_t>(last_raw), raw);
+            const uint32_t interval_us =
+                governor.update(delta_raw, static_cast<uint32_t>((t - last_sample_s) * 1e6));
+            last_raw = raw;
+            last_sample_s = t;
+            next_sample_s = t + interval_us * 1e-6;
+        }
+
+        if (pipeline.total() == target && velocity == 0.0) {
+            if (on_target_since < 0.0) {
+                on_target_since = t;
+            } else if (t - on_target_since >= kSettleS) {
+                result.reached = true;
+                result.time_s = last_change_s;
+                break;
+            }
+        } else {
+            on_target_since = -1.0;
+        }
+    }
+    result.turns = travel / kTicksPerRevolution;
+    return result;
+}
+
+void run_operator_matrix() {
+    const int32_t targets[] = {7 * 60, 25 * 60, 45 * 60, 70 * 60, 2 * 3600 + 15 * 60, 4 * 3600 + 5 * 60, 6 * 3600};
+    constexpr uint32_t kSeeds = 5;
+
+    std::printf("simulated operator from %d min, %u seeds per target\n", kInitialSeconds / 60, kSeeds);
+    std::printf("%-14s %9s %8s %10s %11s %9s %7s\n", "curve", "target", "reached", "time s", "overshoot", "reversals",
+                "turns");
+    for (const NamedCurve& named : kCurves) {
+        double curve_time = 0.0;
+        uint32_t curve_reached = 0;
+        uint32_t curve_runs = 0;
+        for (int32_t target : targets) {
+            double time_sum = 0.0;
+            double overshoot_max = 0.0;
+            double turns_sum = 0.0;
+            uint32_t reversals = 0;
+            uint32_t reached = 0;
+            for (uint32_t seed = 1; seed <= kSeeds; ++seed) {
+                const OperatorResult r = operate(named.curve, target, seed * 7919 + static_cast<uint32_t>(target));
+                if (r.reached) {
+                    ++reached;
+                    time_sum += r.time_s;
+                }
+                overshoot_max = std::max(overshoot_max, r.overshoot_s);
+                turns_sum += r.turns;
+                reversals += r.reversals;
+            }
+            curve_time += time_sum;
+            curve_reached += reached;
+            curve_runs += kSeeds;
+            char target_text[16];
+            std::snprintf(target_text, sizeof(target_text), "%d:%02d", target / 3600, (target / 60) % 60);
+            char time_text[16];
+            if (reached > 0) {
+                std::snprintf(time_text, sizeof(time_text), "%.2f", time_sum / reached);
+            } else {
+                std::snprintf(time_text, sizeof(time_text), "-");
+            }
+            std::printf("%-14s %9s %5u/%-2u %10s %8.0f min %9.1f %7.1f\n", named.name, target_text, reached, kSeeds,
+                        time_text, overshoot_max / 60.0, static_cast<double>(reversals) / kSeeds, turns_sum / kSeeds);
+        }
+        std::printf("%-14s %9s %5u/%-2u %10.2f\n\n", named.name, "all", curve_reached, curve_runs,
+                    curve_reached ? curve_time / curve_reached : 0.0);
+    }
+}
+
+struct Trace {
+    std::string name;
+    std::vector<std::pair<uint32_t, uint16_t>> samples;
+    int32_t target = -1;
+    int32_t start = kInitialSeconds;
+};
+
+bool load_trace(const char* path, Trace* out) {
+    FILE* f = std::fopen(path, "r");
+    if (f == nullptr) {
+        return false;
+    }
+    out->name = path;
+    char line[128];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        long value = 0;
+        unsigned long ts = 0;
+        unsigned raw = 0;
+        if (std::sscanf(line, "# target=%ld", &value) == 1) {
+            out->target = static_cast<int32_t>(value);
+        } else if (std::sscanf(line, "# start=%ld", &value) == 1) {
+            out->start = static_cast<int32_t>(value);
+        } else if (std::sscanf(line, "%lu,%u", &ts, &raw) == 2) {
+            out->samples.emplace_back(static_cast<uint32_t>(ts), static_cast<uint16_t>(raw & 0x3FFF));
+        }
+    }
+    std::fclose(f);
+    return !out->samples.empty();
+}
+
+void replay_trace(const Trace& trace) {
+    std::printf("%s: %zu samples, start %d s, target %s\n", trace.name.c_str(), trace.samples.size(), trace.start,
+                trace.target >= 0 ? std::to_string(trace.target).c_str() : "-");
+    std::printf("  %-14s %14s %11s %10s\n", "curve", "time-to-target", "overshoot", "final");
+    const uint32_t t0 = trace.samples.front().first;
+    for (const NamedCurve& named : kCurves) {
+        SelectorPipeline pipeline(named.curve, trace.start);
+        const int approach = trace.target >= trace.start ? 1 : -1;
+        double reached_s = -1.0;
+        int32_t overshoot = 0;
+        for (const auto& [ts, raw] : trace.samples) {
+            if (!pipeline.sample(raw, ts) || trace.target < 0) {
+                continue;
+            }
+            const int32_t beyond = (pipeline.total() - trace.target) * approach;
+            if (beyond >= 0 && reached_s < 0.0) {
+                reached_s = static_cast<double>(ts - t0) / 1e6;
+            }
+            overshoot = std::max(overshoot, beyond);
+        }
+        char reached_text[24];
+        if (reached_s >= 0.0) {
+            std::snprintf(reached_text, sizeof(reached_text), "%.2f s", reached_s);
+        } else {
+            std::snprintf(reached_text, sizeof(reached_text), "-");
+        }
+        std::printf("  %-14s %14s %7.0f min %6d:%02d\n", named.name, reached_text, overshoot / 60.0,
+                    pipeline.total() / 3600, (pipeline.total() / 60) % 60);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc <= 1) {
+        run_operator_matrix();
+        return 0;
+    }
+    for (int i = 1; i < argc; ++i) {
+        Trace trace;
+        if (!load_trace(argv[i], &trace)) {
+            std::fprintf(stderr, "cannot read trace %s\n", argv[i]);
+            return 1;
+        }
+        replay_trace(trace);
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Concurrent reader/writer benchmark: SeqlockCell<TimerSnapshot> versus the
+// single-slot queue path (xQueueOverwrite / xQueuePeek via a POSIX shim).
+//
+// One writer publishes snapshots in bursts (yielding between them) while N
+// readers poll for the latest value. Readers that hit an in-flight store back
+// off to the scheduler, as SnapshotChannel::latest() does on target. Every
+// snapshot is self-consistent (all fields derived from one counter), so
+// readers also count torn reads.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "freertos_queue_shim.h"
+#include "ringbuf/seqlock.h"
+#include "timer/timer_types.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+dial::TimerSnapshot make_snapshot(uint32_t counter) {
+    return dial::TimerSnapshot{
+        .state = dial::TimerState::Counting,
+        .setpoint_seconds = counter,
+        .remaining_seconds = counter / 1000,
+        .remaining_ms = counter,
+        .monotonic_us = static_cast<uint64_t>(counter) * 3,
+    };
+}
+
+bool consistent(const dial::TimerSnapshot& s) {
+    return s.setpoint_seconds == s.remaining_ms &&
+           s.remaining_seconds == s.remaining_ms / 1000 &&
+           s.monotonic_us == static_cast<uint64_t>(s.remaining_ms) * 3;
+}
+
+struct Result {
+    uint64_t writes = 0;
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    double seconds = 0.0;
+    double write_seconds = 0.0;
+};
+
+template <typename Publish, typename Read>
+Result run(int readers, std::chrono::milliseconds duration, Publish publish, Read read) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> torn{0};
+    uint64_t writes = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; ++i) {
+        threads.emplace_back([&] {
+            uint64_t local_reads = 0;
+            uint64_t local_torn = 0;
+            dial::TimerSnapshot snapshot{};
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (read(&snapshot)) {
+                    ++local_reads;
+                    if (!consistent(snapshot)) {
+                        ++local_torn;
+                    }
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            reads += local_reads;
+            torn += local_torn;
+        });
+    }
+
+    const auto start = Clock::now();
+    const auto end = start + duration;
+    uint32_t counter = 1;
+    Clock::duration write_time{};
+    while (Clock::now() < end) {
+        const auto burst_start = Clock::now();
+        for (int i = 0; i < 64; ++i) {
+            publish(make_snapshot(counter++));
+            ++writes;
+        }
+        write_time += Clock::now() - burst_start;
+        std::this_thread::yield();
+    }
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Result result{};
+    result.writes = writes;
+    result.reads = reads.load();
+    result.torn = torn.load();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.write_seconds = std::chrono::duration<double>(write_time).count();
+    return result;
+}
+
+void report(const char* name, int readers, const Result& r) {
+    std::printf("  %-8s readers=%d  writes=%6.2f M/s  reads=%6.2f M/s  ns/write=%6.1f  torn=%llu\n",
+                name, readers,
+                static_cast<double>(r.writes) / r.seconds / 1e6,
+                static_cast<double>(r.reads) / r.seconds / 1e6,
+                r.write_seconds * 1e9 / static_cast<double>(r.writes),
+                static_cast<unsigned long long>(r.torn));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const auto duration = std::chrono::milliseconds(argc > 1 ? std::atoi(argv[1]) : 500);
+
+    std::printf("snapshot channel: %lld ms per run, sizeof(TimerSnapshot)=%zu\n",
+                static_cast<long long>(duration.count()), sizeof(dial::TimerSnapshot));
+    for (int readers : {1, 2, 4}) {
+        dial::SeqlockCell<dial::TimerSnapshot> cell;
+        cell.store(make_snapshot(0));
+        const Result seqlock = run(
+            readers, duration,
+            [&](const dial::TimerSnapshot& s) { cell.store(s); },
+            [&](dial::TimerSnapshot* out) { return cell.try_load(out); });
+        report("seqlock", readers, seqlock);
+
+        host_bench::PosixQueue queue(1, sizeof(dial::TimerSnapshot));
+        const dial::TimerSnapshot initial = make_snapshot(0);
+        queue.overwrite(&initial);
+        const Result queued = run(
+            readers, duration,
+            [&](const dial::TimerSnapshot& s) { queue.overwrite(&s); },
+            [&](dial::TimerSnapshot* out) { return queue.peek(out); });
+        report("queue", readers, queued);
+
+        if (seqlock.torn != 0 || queued.torn != 0) {
+            std::fprintf(stderr, "torn snapshot observed\n");
+            return 1;
+        }
+    }
+    return 0;
+}
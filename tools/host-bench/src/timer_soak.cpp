@@ -0,0 +1,311 @@
+// Accelerated soak/drift harness for the platform-free timer core.
+//
+// Drives dial::TimerCore with a simulated clock through a multi-hour session of
+// randomised input storms: fast encoder spins with commits, touch quick-deltas,
+// start/stop/reset spam, and quiet stretches where countdowns run (often to
+// expiry). Boundary wakeups are delivered with esp_timer-like dispatch latency.
+// Reports drift against an independent reference, events/sec of wall time and
+// the worst-case host processing time per event.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "input/time_event.h"
+#include "timer/timer_core.h"
+
+namespace {
+
+using WallClock = std::chrono::steady_clock;
+
+constexpr int64_t kUsPerMs = 1000;
+constexpr int64_t kUsPerSecond = 1'000'000;
+constexpr int32_t kBaseStepSeconds = 60;  // TimeSelector's finest step
+constexpr uint32_t kMaxTotalSeconds = 6 * 3600;
+
+class SimClock : public dial::Clock {
+public:
+    int64_t now_us() const override { return now_us_; }
+    void advance_to(int64_t t_us) { now_us_ = std::max(now_us_, t_us); }
+
+private:
+    int64_t now_us_ = 0;
+};
+
+// Randomised encoder/touch/control event source. Tracks the selector's
+// accumulated setpoint the way TimeSelector does so totals stay realistic.
+class StormEventSource {
+public:
+    explicit StormEventSource(uint32_t seed) : rng_(seed) { schedule_phase(0); }
+
+    int64_t next_time_us() const { return next_us_; }
+
+    dial::TimeDeltaEvent take(int64_t now_us, int32_t engine_setpoint, bool engine_counting) {
+        dial::TimeDeltaEvent event = pending_;
+        event.timestamp_us = static_cast<uint32_t>(now_us);
+        if (event.type == dial::TimeEventType::Delta && event.multiplier == 1 && quick_delta_) {
+            // Touch quick-deltas are projected from the engine's setpoint.
+            const int64_t projected = std::clamp<int64_t>(static_cast<int64_t>(engine_setpoint) + event.delta_seconds, 0, kMaxTotalSeconds);
+            event.total_seconds = static_cast<int32_t>(projected);
+        }
+        if (quiet_control_) {
+            quiet_control_ = false;
+            if (engine_counting && event.control == dial::ControlCommand::ToggleRun) {
+                // Walking away from a countdown the commit already started.
+                event.control = dial::ControlCommand::None;
+            }
+            // Mostly wait out whatever countdown is running; sometimes come
+            // back early and interrupt it.
+            quiet_us_ = uniform(0, 3) != 0 ? (static_cast<int64_t>(engine_setpoint) + uniform64(1, 30)) * kUsPerSecond
+                                           : uniform64(1, 120) * kUsPerSecond;
+        }
+        advance(now_us);
+        return event;
+    }
+
+private:
+    enum class Phase { Spin, Touch, Quiet };
+
+    void schedule_phase(int64_t now_us) {
+        const int pick = uniform(0, 99);
+        phase_ = pick < 35 ? Phase::Spin : (pick < 50 ? Phase::Touch : Phase::Quiet);
+        remaining_in_phase_ = phase_ == Phase::Spin ? 1000 : uniform(2, 40);
+        // Fidget for a while, then dial a target: mostly minutes, now and
+        // then hours.
+        wander_ = phase_ == Phase::Spin ? uniform(0, 300) : 0;
+        spin_direction_ = uniform(0, 1) ? 1 : -1;
+        spin_target_ = uniform(0, 19) == 0 ? uniform(1, 3) * 3600 : uniform(1, 30) * kBaseStepSeconds;
+        if (spin_target_ == accumulated_) {
+            spin_target_ += kBaseStepSeconds;
+        }
+        if (phase_ == Phase::Quiet) {
+            // One control press, then hands off; take() sizes the quiet
+            // stretch from the setpoint so countdowns often run to expiry.
+            quiet_control_ = true;
+            remaining_in_phase_ = 0;
+            phase_done_ = true;
+            next_us_ = now_us + uniform64(100, 800) * kUsPerMs;
+            make_control(uniform(0, 4) == 0 ? dial::ControlCommand::Reset : dial::ControlCommand::ToggleRun);
+            return;
+        }
+        advance(now_us);
+    }
+
+    void advance(int64_t now_us) {
+        if (commit_pending_) {
+            commit_pending_ = false;
+            pending_ = {};
+            pending_.type = dial::TimeEventType::Commit;
+            pending_.total_seconds = accumulated_;
+            pending_.delta_seconds = 0;
+            pending_.multiplier = 0;
+            next_us_ = now_us + 1000 * kUsPerMs;  // selector commit timeout
+            phase_done_ = true;
+            return;
+        }
+        if (phase_done_ || remaining_in_phase_ <= 0) {
+            phase_done_ = false;
+            schedule_phase(now_us + quiet_us_);
+            quiet_us_ = 0;
+            return;
+        }
+        --remaining_in_phase_;
+
+        if (phase_ == Phase::Spin) {
+            uint32_t multiplier = 1;
+            int32_t direction = spin_direction_;
+            if (wander_ > 0) {
+                --wander_;
+                if (uniform(0, 49) == 0) {
+                    spin_direction_ = -spin_direction_;
+                }
+                static constexpr uint32_t kMultipliers[] = {1, 5, 15};
+                multiplier = kMultipliers[uniform(0, 2)];
+            } else {
+                // Brisk detents while far off, minutes near the target, and
+                // the odd detent the wrong way.
+                const int32_t distance = spin_target_ - accumulated_;
+                const int32_t steps = std::abs(distance) / kBaseStepSeconds;
+                multiplier = steps >= 15 ? 15 : (steps >= 5 ? 5 : 1);
+                direction = (distance >= 0) == (uniform(0, 49) != 0) ? 1 : -1;
+            }
+            const int32_t previous = accumulated_;
+            accumulated_ = std::clamp<int32_t>(accumulated_ + direction * kBaseStepSeconds * static_cast<int32_t>(multiplier),
+                                               0, kMaxTotalSeconds);
+            pending_ = {};
+            pending_.type = dial::TimeEventType::Delta;
+            pending_.total_seconds = accumulated_;
+            pending_.delta_seconds = accumulated_ - previous;
+            pending_.multiplier = multiplier;
+            quick_delta_ = false;
+            next_us_ = now_us + uniform64(1, 5) * kUsPerMs;
+            if ((wander_ == 0 && accumulated_ == spin_target_) || remaining_in_phase_ == 0) {
+                commit_pending_ = true;
+            }
+            return;
+        }
+
+        // Touch storm: quick deltas interleaved with start/stop/reset spam.
+        const int pick = uniform(0, 9);
+        if (pick < 5) {
+            static constexpr int32_t kQuick[] = {60, -60, 300, -300};
+            pending_ = {};
+            pending_.type = dial::TimeEventType::Delta;
+            pending_.delta_seconds = kQuick[uniform(0, 3)];
+            pending_.multiplier = 1;
+            quick_delta_ = true;
+        } else {
+            make_control(pick < 8 ? dial::ControlCommand::ToggleRun : dial::ControlCommand::Reset);
+        }
+        next_us_ = now_us + uniform64(40, 600) * kUsPerMs;
+    }
+
+    void make_control(dial::ControlCommand command) {
+        pending_ = {};
+        pending_.type = dial::TimeEventType::Control;
+        pending_.total_seconds = 0;
+        pending_.delta_seconds = 0;
+        pending_.multiplier = 0;
+        pending_.control = command;
+        quick_delta_ = false;
+    }
+
+    int uniform(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng_); }
+    int64_t uniform64(int64_t lo, int64_t hi) { return std::uniform_int_distribution<int64_t>(lo, hi)(rng_); }
+
+    std::mt19937 rng_;
+    Phase phase_ = Phase::Quiet;
+    int remaining_in_phase_ = 0;
+    int32_t spin_direction_ = 1;
+    int32_t spin_target_ = kBaseStepSeconds;
+    int wander_ = 0;
+    int32_t accumulated_ = kBaseStepSeconds;
+    bool commit_pending_ = false;
+    bool phase_done_ = false;
+    bool quick_delta_ = false;
+    bool quiet_control_ = false;
+    int64_t quiet_us_ = 0;
+    dial::TimeDeltaEvent pending_{};
+    int64_t next_us_ = 0;
+};
+
+struct SoakStats {
+    uint64_t inputs = 0;
+    uint64_t boundaries = 0;
+    uint64_t publishes = 0;
+    uint64_t persists = 0;
+    uint64_t countdowns_started = 0;
+    uint64_t countdowns_expired = 0;
+    int64_t max_remaining_error_us = 0;
+    int64_t max_expiry_latency_us = 0;
+    std::chrono::nanoseconds worst_event{0};
+    std::chrono::nanoseconds total_event{0};
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const double hours = argc > 1 ? std::atof(argv[1]) : 8.0;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    const int64_t session_us = static_cast<int64_t>(hours * 3600.0 * kUsPerSecond);
+
+    SimClock clock;
+    dial::TimerCore core;
+    core.init(dial::TimerEngineConfig{}, clock);
+
+    StormEventSource source(seed);
+    std::mt19937 latency_rng(seed ^ 0x5eedu);
+    std::uniform_int_distribution<int64_t> latency(20, 400);
+
+    SoakStats stats{};
+    int64_t reference_deadline_us = -1;
+    int64_t armed_for_us = -1;
+    int64_t fire_at_us = -1;
+
+    const auto wall_start = WallClock::now();
+    while (clock.now_us() < session_us) {
+        const int64_t wakeup_us = core.next_wakeup_us();
+        if (wakeup_us != armed_for_us) {
+            armed_for_us = wakeup_us;
+            fire_at_us = wakeup_us < 0 ? -1 : wakeup_us + latency(latency_rng);
+        }
+
+        dial::TimeDeltaEvent event{};
+        const bool boundary = fire_at_us >= 0 && fire_at_us <= source.next_time_us();
+        if (boundary) {
+            clock.advance_to(fire_at_us);
+            armed_for_us = -1;
+            fire_at_us = -1;
+            event.type = dial::TimeEventType::Boundary;
+            event.total_seconds = 0;
+            event.delta_seconds = 0;
+            event.multiplier = 0;
+            ++stats.boundaries;
+        } else {
+            clock.advance_to(source.next_time_us());
+            event = source.take(clock.now_us(), static_cast<int32_t>(core.setpoint_seconds()),
+                                core.state() == dial::TimerState::Counting);
+            ++stats.inputs;
+        }
+
+        const dial::TimerState before = core.state();
+        const auto t0 = WallClock::now();
+        const dial::TimerEffects effects = core.handle(event);
+        dial::TimerSnapshot snapshot{};
+        const bool published = core.take_visible_change(&snapshot);
+        const auto elapsed = WallClock::now() - t0;
+
+        stats.worst_event = std::max(stats.worst_event, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        stats.total_event += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+        stats.publishes += published ? 1 : 0;
+        stats.persists += effects.persist ? 1 : 0;
+
+        const int64_t now_us = clock.now_us();
+        if (core.state() == dial::TimerState::Counting) {
+            if (before != dial::TimerState::Counting || event.type == dial::TimeEventType::Commit) {
+                // Only a start or a commit (re)arms the deadline.
+                reference_deadline_us = now_us + static_cast<int64_t>(core.setpoint_seconds()) * kUsPerSecond;
+                ++stats.countdowns_started;
+            }
+            // A countdown at zero shows zero until its boundary wakeup lands,
+            // and one committed at a zero setpoint never runs.
+            const int64_t reference_remaining_us = std::max<int64_t>(0, reference_deadline_us - now_us);
+            const int64_t error_us = std::llabs(static_cast<int64_t>(core.snapshot().remaining_ms) * kUsPerMs - reference_remaining_us);
+            // remaining_ms truncates, so anything under 1 ms is quantisation.
+            if (error_us >= kUsPerMs) {
+                stats.max_remaining_error_us = std::max(stats.max_remaining_error_us, error_us);
+            }
+        } else if (before == dial::TimerState::Counting && boundary && core.state() == dial::TimerState::Finished) {
+            ++stats.countdowns_expired;
+            stats.max_expiry_latency_us = std::max(stats.max_expiry_latency_us, now_us - reference_deadline_us);
+        }
+    }
+    const double wall_seconds = std::chrono::duration<double>(WallClock::now() - wall_start).count();
+    const uint64_t events = stats.inputs + stats.boundaries;
+
+    std::printf("timer soak: %.2f simulated h in %.3f s wall (seed %u, %.0fx real time)\n",
+                hours, wall_seconds, seed, static_cast<double>(session_us) / kUsPerSecond / wall_seconds);
+    std::printf("  events      : %llu inputs + %llu boundary wakeups, %.2f M events/s\n",
+                static_cast<unsigned long long>(stats.inputs),
+                static_cast<unsigned long long>(stats.boundaries),
+                static_cast<double>(events) / wall_seconds / 1e6);
+    std::printf("  per event   : mean %.0f ns, worst %lld ns\n",
+                static_cast<double>(stats.total_event.count()) / static_cast<double>(events),
+                static_cast<long long>(stats.worst_event.count()));
+    std::printf("  outputs     : %llu snapshots published, %llu persistence writes\n",
+                static_cast<unsigned long long>(stats.publishes),
+                static_cast<unsigned long long>(stats.persists));
+    std::printf("  countdowns  : %llu started, %llu expired (%.0f%%)\n",
+                static_cast<unsigned long long>(stats.countdowns_started),
+                static_cast<unsigned long long>(stats.countdowns_expired),
+                stats.countdowns_started > 0
+                    ? 100.0 * static_cast<double>(stats.countdowns_expired) / static_cast<double>(stats.countdowns_started)
+                    : 0.0);
+    std::printf("  drift       : max remaining error %.3f ms beyond truncation, max expiry latency %.3f ms\n",
+                static_cast<double>(stats.max_remaining_error_us) / kUsPerMs,
+                static_cast<double>(stats.max_expiry_latency_us) / kUsPerMs);
+    return stats.max_remaining_error_us == 0 ? 0 : 1;
+}
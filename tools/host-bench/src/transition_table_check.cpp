@@ -0,0 +1,467 @@
+// Exhaustive check and microbenchmark for the compile-time timer transition
+// table.
+//
+// The reference is the hand-written dispatch the table replaced
+// (determine_next_state() plus the ToggleRun/Reset/expiry branches), kept here
+// verbatim as LegacyCore. Both cores are started from every restorable state
+// and driven through every event sequence up to the configured depth, with
+// clock advances in between; state, setpoint, remaining time, armed wakeup and
+// the persist effect must match after every step. The engine's batch fold
+// (TimerCore::fold_delta) is checked the same way: every batch of events
+// handled folded must end where handling each event alone does. Then both
+// dispatch paths are timed over the same random event stream.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "input/time_event.h"
+#include "timer/countdown.h"
+#include "timer/state_machine.h"
+#include "timer/timer_core.h"
+
+namespace {
+
+using WallClock = std::chrono::steady_clock;
+
+class SimClock : public dial::Clock {
+public:
+    int64_t now_us() const override { return now_us_; }
+    void set(int64_t t_us) { now_us_ = t_us; }
+    void advance(int64_t d_us) { now_us_ += d_us; }
+
+private:
+    int64_t now_us_ = 0;
+};
+
+// --- Reference: dispatch as it was before the table ------------------------
+
+dial::TimerState legacy_next_state(dial::TimerState current, const dial::TimeDeltaEvent& event, bool auto_start) {
+    using dial::TimerState;
+    if (event.type == dial::TimeEventType::Commit) {
+        if (event.total_seconds == 0) {
+            return TimerState::Idle;
+        }
+        if (!auto_start) {
+            return TimerState::Arming;
+        }
+        return TimerState::Counting;
+    }
+
+    switch (current) {
+        case TimerState::Idle:
+            if (event.delta_seconds != 0 && event.total_seconds > 0) {
+                return TimerState::Editing;
+            }
+            break;
+        case TimerState::Editing:
+        case TimerState::Arming:
+            if (event.total_seconds == 0) {
+                return TimerState::Idle;
+            }
+            return TimerState::Editing;
+        case TimerState::Counting:
+            if (event.total_seconds == 0) {
+                return TimerState::Finished;
+            }
+            return TimerState::Editing;
+        case TimerState::Finished:
+            if (event.total_seconds > 0) {
+                return TimerState::Editing;
+            }
+            break;
+    }
+    return current;
+}
+
+class LegacyCore {
+public:
+    void init(const dial::TimerEngineConfig& config, const dial::Clock& clock) {
+        config_ = config;
+        clock_ = &clock;
+        state_ = dial::TimerState::Idle;
+        setpoint_seconds_ = std::min(config_.max_total_seconds, static_cast<uint32_t>(15 * 60));
+        countdown_.reset(static_cast<int64_t>(setpoint_seconds_) * 1000);
+    }
+
+    void restore(dial::TimerState state, uint32_t setpoint_seconds, uint32_t remaining_ms) {
+        setpoint_seconds_ = std::min(setpoint_seconds, config_.max_total_seconds);
+        countdown_.reset(std::min<int64_t>(static_cast<int64_t>(remaining_ms), static_cast<int64_t>(setpoint_seconds_) * 1000));
+        if (setpoint_seconds_ == 0) {
+            state_ = dial::TimerState::Idle;
+        } else if (state == dial::TimerState::Counting || state == dial::TimerState::Arming) {
+            state_ = dial::TimerState::Editing;
+        } else {
+            state_ = state;
+        }
+    }
+
+    // Kept out of line so both paths pay one call, like TimerCore::handle().
+    __attribute__((noinline)) bool handle(const dial::TimeDeltaEvent& event) {
+        switch (event.type) {
+            case dial::TimeEventType::Control:
+                return handle_control(event.control);
+            case dial::TimeEventType::Boundary:
+                return handle_boundary();
+            case dial::TimeEventType::Delta:
+            case dial::TimeEventType::Commit:
+            default:
+                return handle_selection(event);
+        }
+    }
+
+    dial::TimerState state() const { return state_; }
+    uint32_t setpoint_seconds() const { return setpoint_seconds_; }
+    int64_t remaining_us() const { return countdown_.remaining_us(clock_->now_us()); }
+    int64_t next_boundary_us() const { return countdown_.next_boundary_us(clock_->now_us()); }
+
+private:
+    bool handle_control(dial::ControlCommand command) {
+        switch (command) {
+            case dial::ControlCommand::ToggleRun:
+                if (state_ == dial::TimerState::Counting) {
+                    stop_countdown();
+                    state_ = dial::TimerState::Editing;
+                    return true;
+                }
+                if (setpoint_seconds_ > 0) {
+                    state_ = dial::TimerState::Counting;
+                    start_countdown();
+                    return true;
+                }
+                return false;
+            case dial::ControlCommand::Reset:
+                if (setpoint_seconds_ != 0 || countdown_.remaining_us(clock_->now_us()) != 0 ||
+                    state_ != dial::TimerState::Idle) {
+                    setpoint_seconds_ = 0;
+                    stop_countdown();
+                    state_ = dial::TimerState::Idle;
+                    return true;
+                }
+                return false;
+            case dial::ControlCommand::None:
+            default:
+                return false;
+        }
+    }
+
+    bool handle_boundary() {
+        if (state_ != dial::TimerState::Counting) {
+            return false;
+        }
+        if (countdown_.expired(clock_->now_us())) {
+            state_ = dial::TimerState::Finished;
+            setpoint_seconds_ = 0;
+            countdown_.reset(0);
+            return true;
+        }
+        return false;
+    }
+
+    bool handle_selection(const dial::TimeDeltaEvent& event) {
+        if (event.type == dial::TimeEventType::Delta) {
+            int64_t updated = static_cast<int64_t>(setpoint_seconds_) + static_cast<int64_t>(event.delta_seconds);
+            updated = std::max<int64_t>(0, std::min<int64_t>(updated, static_cast<int64_t>(config_.max_total_seconds)));
+            setpoint_seconds_ = static_cast<uint32_t>(updated);
+        }
+        state_ = legacy_next_state(state_, event, config_.auto_start);
+        if (state_ == dial::TimerState::Counting && setpoint_seconds_ > 0) {
+            start_countdown();
+        } else {
+            stop_countdown();
+        }
+        return event.type == dial::TimeEventType::Commit || state_ == dial::TimerState::Finished;
+    }
+
+    void start_countdown() { countdown_.start(clock_->now_us(), static_cast<int64_t>(setpoint_seconds_) * 1000); }
+    void stop_countdown() { countdown_.reset(static_cast<int64_t>(setpoint_seconds_) * 1000); }
+
+    dial::TimerEngineConfig config_{};
+    const dial::Clock* clock_ = nullptr;
+    dial::TimerState state_ = dial::TimerState::Idle;
+    uint32_t setpoint_seconds_ = 0;
+    dial::Countdown countdown_{};
+};
+
+// --- Exhaustive comparison -------------------------------------------------
+
+dial::TimeDeltaEvent make_event(dial::TimeEventType type, int32_t total, int32_t delta,
+                                dial::ControlCommand control = dial::ControlCommand::None) {
+    dial::TimeDeltaEvent event{};
+    event.type = type;
+    event.total_seconds = total;
+    event.delta_seconds = delta;
+    event.timestamp_us = 0;
+    event.multiplier = 1;
+    event.control = control;
+    return event;
+}
+
+std::vector<dial::TimeDeltaEvent> event_alphabet() {
+    std::vector<dial::TimeDeltaEvent> events;
+    for (int32_t total : {-1, 0, 1, 3}) {
+        for (int32_t delta : {-2, 0, 1}) {
+            events.push_back(make_event(dial::TimeEventType::Delta, total, delta));
+        }
+        events.push_back(make_event(dial::TimeEventType::Commit, total, 0));
+    }
+    for (auto command : {dial::ControlCommand::None, dial::ControlCommand::ToggleRun, dial::ControlCommand::Reset}) {
+        events.push_back(make_event(dial::TimeEventType::Control, 0, 0, command));
+    }
+    events.push_back(make_event(dial::TimeEventType::Boundary, 0, 0));
+    // Stray control field on a selection event is ignored by both paths.
+    events.push_back(make_event(dial::TimeEventType::Delta, 2, 1, dial::ControlCommand::Reset));
+    return events;
+}
+
+struct CheckStats {
+    uint64_t sequences = 0;
+    uint64_t steps = 0;
+    uint64_t mismatches = 0;
+    std::vector<bool> cells_hit;
+};
+
+struct Pair {
+    SimClock clock;
+    LegacyCore legacy;
+    dial::TimerCore core;
+};
+
+bool compare_step(const Pair& p, bool legacy_persist, bool core_persist) {
+    return p.legacy.state() == p.core.state() &&
+           p.legacy.setpoint_seconds() == p.core.setpoint_seconds() &&
+           p.legacy.remaining_us() / 1000 == static_cast<int64_t>(p.core.snapshot().remaining_ms) &&
+           p.legacy.next_boundary_us() == p.core.next_wakeup_us() &&
+           legacy_persist == core_persist;
+}
+
+void run_sequences(const dial::TimerEngineConfig& config, const std::vector<dial::TimeDeltaEvent>& alphabet,
+                   int depth, CheckStats* stats) {
+    static constexpr int64_t kAdvances[] = {0, 400'000, 2'600'000};
+    static constexpr dial::TimerState kRestoreStates[] = {
+        dial::TimerState::Idle, dial::TimerState::Editing, dial::TimerState::Arming,
+        dial::TimerState::Counting, dial::TimerState::Finished};
+
+    const size_t choices = alphabet.size() * std::size(kAdvances);
+    size_t total_sequences = 1;
+    for (int i = 0; i < depth; ++i) {
+        total_sequences *= choices;
+    }
+
+    for (dial::TimerState restore_state : kRestoreStates) {
+        for (uint32_t setpoint : {0u, 1u, 3u}) {
+            for (uint32_t remaining_ms : {0u, 700u, 3000u}) {
+                for (size_t seq = 0; seq < total_sequences; ++seq) {
+                    Pair p;
+                    p.legacy.init(config, p.clock);
+                    p.core.init(config, p.clock);
+                    p.legacy.restore(restore_state, setpoint, remaining_ms);
+                    p.core.restore(restore_state, setpoint, remaining_ms);
+                    ++stats->sequences;
+
+                    size_t code = seq;
+                    for (int step = 0; step < depth; ++step) {
+                        const size_t choice = code % choices;
+                        code /= choices;
+                        p.clock.advance(kAdvances[choice % std::size(kAdvances)]);
+                        const dial::TimeDeltaEvent& event = alphabet[choice / std::size(kAdvances)];
+
+                        const bool running = p.legacy.next_boundary_us() >= 0;
+                        const uint8_t guards = dial::timer_guards(event, p.legacy.setpoint_seconds(), config.auto_start,
+                                                                  running && p.legacy.remaining_us() == 0,
+                                                                  p.legacy.remaining_us() != 0);
+                        stats->cells_hit[((static_cast<uint32_t>(p.legacy.state()) * dial::kTimerInputCount +
+                                           static_cast<uint32_t>(dial::timer_input(event)))
+                                          << dial::kTimerGuardBits) | guards] = true;
+
+                        const bool legacy_persist = p.legacy.handle(event);
+                        const bool core_persist = p.core.handle(event).persist;
+                        ++stats->steps;
+                        if (!compare_step(p, legacy_persist, core_persist)) {
+                            if (stats->mismatches++ < 10) {
+                                std::fprintf(stderr,
+                                             "mismatch: restore(%u,%u,%u) step %d type=%u control=%u total=%d delta=%d "
+                                             "-> legacy state=%u sp=%u persist=%d, table state=%u sp=%u persist=%d\n",
+                                             static_cast<unsigned>(restore_state), setpoint, remaining_ms, step,
+                                             static_cast<unsigned>(event.type), static_cast<unsigned>(event.control),
+                                             event.total_seconds, event.delta_seconds,
+                                             static_cast<unsigned>(p.legacy.state()), p.legacy.setpoint_seconds(),
+                                             legacy_persist, static_cast<unsigned>(p.core.state()),
+                                             p.core.setpoint_seconds(), core_persist);
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// --- Batch fold ------------------------------------------------------------
+
+std::vector<dial::TimeDeltaEvent> fold_alphabet() {
+    std::vector<dial::TimeDeltaEvent> events;
+    for (int32_t total : {-1, 0, 1, 2, 3, 4}) {
+        for (int32_t delta : {-2, -1, 0, 1, 2}) {
+            events.push_back(make_event(dial::TimeEventType::Delta, total, delta));
+        }
+    }
+    events.push_back(make_event(dial::TimeEventType::Commit, 3, 0));
+    events.push_back(make_event(dial::TimeEventType::Boundary, 0, 0));
+    return events;
+}
+
+// Every batch of `depth` events from every restorable state, once through
+// TimerEngine::apply_batch's fold loop and once event by event.
+void run_fold_batches(const dial::TimerEngineConfig& config, const std::vector<dial::TimeDeltaEvent>& alphabet,
+                      int depth, CheckStats* stats, uint64_t* folds) {
+    static constexpr dial::TimerState kRestoreStates[] = {
+        dial::TimerState::Idle, dial::TimerState::Editing, dial::TimerState::Arming,
+        dial::TimerState::Counting, dial::TimerState::Finished};
+
+    size_t total_batches = 1;
+    for (int i = 0; i < depth; ++i) {
+        total_batches *= alphabet.size();
+    }
+    std::vector<dial::TimeDeltaEvent> batch(depth);
+
+    for (dial::TimerState restore_state : kRestoreStates) {
+        for (uint32_t setpoint : {0u, 1u, 3u, 4u}) {
+            for (uint32_t remaining_ms : {0u, 700u, 3000u}) {
+                for (size_t code = 0; code < total_batches; ++code) {
+                    size_t rest = code;
+                    for (int i = 0; i < depth; ++i) {
+                        batch[i] = alphabet[rest % alphabet.size()];
+                        rest /= alphabet.size();
+                    }
+
+                    SimClock clock;
+                    clock.set(1'000'000);
+                    dial::TimerCore single;
+                    dial::TimerCore folded;
+                    single.init(config, clock);
+                    folded.init(config, clock);
+                    single.restore(restore_state, setpoint, remaining_ms);
+                    folded.restore(restore_state, setpoint, remaining_ms);
+                    ++stats->sequences;
+
+                    bool single_persist = false;
+                    for (const dial::TimeDeltaEvent& event : batch) {
+                        single_persist |= single.handle(event).persist;
+                        ++stats->steps;
+                    }
+
+                    bool folded_persist = false;
+                    dial::TimeDeltaEvent pending = batch[0];
+                    for (int i = 1; i < depth; ++i) {
+                        if (folded.fold_delta(&pending, batch[i])) {
+                            ++*folds;
+                            continue;
+                        }
+                        folded_persist |= folded.handle(pending).persist;
+                        pending = batch[i];
+                    }
+                    folded_persist |= folded.handle(pending).persist;
+
+                    if (single.state() != folded.state() || single.setpoint_seconds() != folded.setpoint_seconds() ||
+                        single.snapshot().remaining_ms != folded.snapshot().remaining_ms ||
+                        single.next_wakeup_us() != folded.next_wakeup_us() || single_persist != folded_persist) {
+                        if (stats->mismatches++ < 10) {
+                            std::fprintf(stderr, "fold mismatch: restore(%u,%u,%u)", static_cast<unsigned>(restore_state),
+                                         setpoint, remaining_ms);
+                            for (const dial::TimeDeltaEvent& event : batch) {
+                                std::fprintf(stderr, " type=%u total=%d delta=%d;", static_cast<unsigned>(event.type),
+                                             event.total_seconds, event.delta_seconds);
+                            }
+                            std::fprintf(stderr, " -> single state=%u sp=%u persist=%d, folded state=%u sp=%u persist=%d\n",
+                                         static_cast<unsigned>(single.state()), single.setpoint_seconds(),
+                                         single_persist, static_cast<unsigned>(folded.state()),
+                                         folded.setpoint_seconds(), folded_persist);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// --- Microbenchmark --------------------------------------------------------
+
+template <typename Core>
+double time_dispatch(const dial::TimerEngineConfig& config, const std::vector<dial::TimeDeltaEvent>& stream,
+                     uint64_t* checksum) {
+    SimClock clock;
+    Core core;
+    core.init(config, clock);
+    uint64_t sum = 0;
+    const auto start = WallClock::now();
+    for (const dial::TimeDeltaEvent& event : stream) {
+        clock.advance(1000);
+        core.handle(event);
+        sum = sum * 31 + static_cast<uint64_t>(core.state()) + core.setpoint_seconds();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(WallClock::now() - start).count();
+    *checksum = sum;
+    return ns / static_cast<double>(stream.size());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int depth = argc > 1 ? std::atoi(argv[1]) : 3;
+    const size_t bench_events = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 4'000'000;
+
+    const std::vector<dial::TimeDeltaEvent> alphabet = event_alphabet();
+    CheckStats stats{};
+    stats.cells_hit.assign(dial::kTimerStateCount * dial::kTimerInputCount << dial::kTimerGuardBits, false);
+
+    for (bool auto_start : {true, false}) {
+        dial::TimerEngineConfig config{};
+        config.max_total_seconds = 4;
+        config.auto_start = auto_start;
+        run_sequences(config, alphabet, depth, &stats);
+    }
+    const auto cells = static_cast<uint64_t>(std::count(stats.cells_hit.begin(), stats.cells_hit.end(), true));
+
+    std::printf("transition table: %zu-event alphabet, depth %d, 3 clock advances per step\n", alphabet.size(), depth);
+    std::printf("  sequences   : %llu (%llu steps), %llu mismatches\n",
+                static_cast<unsigned long long>(stats.sequences), static_cast<unsigned long long>(stats.steps),
+                static_cast<unsigned long long>(stats.mismatches));
+    std::printf("  table cells : %llu of %zu reached\n", static_cast<unsigned long long>(cells), stats.cells_hit.size());
+
+    const std::vector<dial::TimeDeltaEvent> fold_events = fold_alphabet();
+    const int fold_depth = depth;
+    CheckStats fold_stats{};
+    uint64_t folds = 0;
+    for (bool auto_start : {true, false}) {
+        dial::TimerEngineConfig config{};
+        config.max_total_seconds = 4;
+        config.auto_start = auto_start;
+        run_fold_batches(config, fold_events, fold_depth, &fold_stats, &folds);
+    }
+    std::printf("  batch fold  : %llu batches of %d from a %zu-event alphabet, %llu folds, %llu mismatches\n",
+                static_cast<unsigned long long>(fold_stats.sequences), fold_depth, fold_events.size(),
+                static_cast<unsigned long long>(folds), static_cast<unsigned long long>(fold_stats.mismatches));
+
+    std::mt19937 rng(1);
+    std::vector<dial::TimeDeltaEvent> stream;
+    stream.reserve(bench_events);
+    for (size_t i = 0; i < bench_events; ++i) {
+        stream.push_back(alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(rng)]);
+    }
+    dial::TimerEngineConfig bench_config{};
+    bench_config.max_total_seconds = 4;
+    uint64_t legacy_sum = 0;
+    uint64_t table_sum = 0;
+    const double legacy_ns = time_dispatch<LegacyCore>(bench_config, stream, &legacy_sum);
+    const double table_ns = time_dispatch<dial::TimerCore>(bench_config, stream, &table_sum);
+    std::printf("  dispatch    : legacy %.1f ns/event, table %.1f ns/event over %zu events (%s)\n",
+                legacy_ns, table_ns, stream.size(), legacy_sum == table_sum ? "same trace" : "TRACE DIFFERS");
+
+    return stats.mismatches == 0 && fold_stats.mismatches == 0 && legacy_sum == table_sum ? 0 : 1;
+}
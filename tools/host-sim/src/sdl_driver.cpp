@@ -32,6 +32,9 @@ struct MouseState {
     int16_t x = 0;
     int16_t y = 0;
     bool pressed = false;
+    bool second = false;
+    uint32_t down_ms = 0;
+    bool edge_pending = false;
 };
 
 MouseState g_mouse;
@@ -156,6 +159,10 @@ void pump_events(bool& should_quit) {
                     g_mouse.pressed = true;
                     g_mouse.x = static_cast<int16_t>(event.button.x);
                     g_mouse.y = static_cast<int16_t>(event.button.y);
+                    g_mouse.down_ms = event.button.timestamp;
+                    g_mouse.edge_pending = true;
+                } else if (event.button.button == SDL_BUTTON_RIGHT) {
+                    g_mouse.second = true;
                 }
                 break;
             case SDL_MOUSEBUTTONUP:
@@ -163,6 +170,8 @@ void pump_events(bool& should_quit) {
                     g_mouse.pressed = false;
                     g_mouse.x = static_cast<int16_t>(event.button.x);
                     g_mouse.y = static_cast<int16_t>(event.button.y);
+                } else if (event.button.button == SDL_BUTTON_RIGHT) {
+                    g_mouse.second = false;
                 }
                 break;
             default:
@@ -171,6 +180,20 @@ void pump_events(bool& should_quit) {
     }
 }
 
+dial::TouchSample touch_sample(int64_t now_us) {
+    dial::TouchPoint point{};
+    point.touched = g_mouse.pressed;
+    point.touch_count = g_mouse.pressed ? (g_mouse.second ? 2 : 1) : 0;
+    point.x = static_cast<uint16_t>(g_mouse.x < 0 ? 0 : g_mouse.x);
+    point.y = static_cast<uint16_t>(g_mouse.y < 0 ? 0 : g_mouse.y);
+    dial::TouchSample sample = dial::touch_sample(now_us, point);
+    if (g_mouse.pressed && g_mouse.edge_pending) {
+        sample.contact_start_us = static_cast<int64_t>(g_mouse.down_ms) * 1000;
+        g_mouse.edge_pending = false;
+    }
+    return sample;
+}
+
 void delay(uint32_t ms) {
     SDL_Delay(ms);
 }
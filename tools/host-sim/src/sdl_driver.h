@@ -2,6 +2,8 @@
 
 #include <lvgl.h>
 
+#include "input/gesture_recognizer.h"
+
 namespace host_sim {
 
 bool init(int width, int height);
@@ -11,6 +13,10 @@ lv_disp_t* register_display(int width, int height);
 lv_indev_t* register_pointer();
 
 void pump_events(bool& should_quit);
+// The mouse as a touch controller read: the left button is one finger, the
+// right button held with it adds a second. The first sample of a contact is
+// backdated to the button-down event, like the FT3267 INT edge.
+dial::TouchSample touch_sample(int64_t now_us);
 void delay(uint32_t ms);
 
 }  // namespace host_sim
@@ -2,6 +2,7 @@
 #include <lvgl.h>
 
 #include "esp_log.h"
+#include "input/gesture_recognizer.h"
 #include "sdl_driver.h"
 #include "timer/timer_types.h"
 #include "ui/ui_root.h"
@@ -12,6 +13,20 @@ constexpr int kScreenSize = 240;
 constexpr int kFrameIntervalMs = 16;  // ~60 FPS
 constexpr uint32_t kDemoSetpointSeconds = 15 * 60;  // demo loop
 
+const char* event_name(dial::TouchEventType type) {
+    switch (type) {
+        case dial::TouchEventType::Tap: return "Tap";
+        case dial::TouchEventType::DoubleTap: return "DoubleTap";
+        case dial::TouchEventType::LongPress: return "LongPress";
+        case dial::TouchEventType::SwipeUp: return "SwipeUp";
+        case dial::TouchEventType::SwipeDown: return "SwipeDown";
+        case dial::TouchEventType::SwipeLeft: return "SwipeLeft";
+        case dial::TouchEventType::SwipeRight: return "SwipeRight";
+        case dial::TouchEventType::TwoFingerTap: return "TwoFingerTap";
+    }
+    return "?";
+}
+
 void update_snapshot(dial::TimerSnapshot& snapshot, uint32_t elapsed_ms) {
     const uint32_t total_ms = kDemoSetpointSeconds * 1000;
     if (elapsed_ms >= total_ms) {
@@ -55,6 +70,10 @@ int main() {
     snapshot.remaining_seconds = kDemoSetpointSeconds;
     snapshot.remaining_ms = snapshot.remaining_seconds * 1000;
 
+    // The firmware's recognizer, fed one mouse sample per frame.
+    dial::GestureRecognizer gestures;
+    dial::TouchEvent gesture_events[dial::kMaxGestureEvents];
+
     uint32_t start_ms = SDL_GetTicks();
     uint32_t last_tick_ms = start_ms;
     bool quit = false;
@@ -74,6 +93,13 @@ int main() {
         lv_timer_handler();
 
         host_sim::pump_events(quit);
+        const size_t gesture_count =
+            gestures.update(host_sim::touch_sample(static_cast<int64_t>(SDL_GetTicks()) * 1000), gesture_events);
+        for (size_t i = 0; i < gesture_count; ++i) {
+            const dial::TouchEvent& e = gesture_events[i];
+            ESP_LOGI("HostSim", "%s at (%u, %u), zone %u, %lu ms", event_name(e.type), e.x, e.y,
+                     static_cast<unsigned>(e.zone), static_cast<unsigned long>(e.duration_ms));
+        }
         host_sim::delay(kFrameIntervalMs);
 
         if (snapshot.state == dial::TimerState::Finished && !quit) {